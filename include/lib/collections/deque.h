@@ -6,213 +6,274 @@
 #include <stdlib.h>
 #include <string.h>
 
+/** Least capacity of an allocated deque; a power of two. */
 extern const int DEQUE_MIN_CAPACITY;
 
-#define DEFINE_DEQUE(DEQUE_T, TYPE_T, TYPE)                       \
-	/** A circular buffer deque implementation. */                 \
-	typedef struct deque_##TYPE {                                 \
-		TYPE_T* buffer;                                           \
-		size_t head;                                              \
-		size_t tail;                                              \
-		size_t capacity;                                          \
-		size_t size;                                              \
-	} DEQUE_T;                                                    \
-                                                                  \
-	DEQUE_T deque_##TYPE##_create(void);                          \
-                                                                  \
-	DEQUE_T deque_##TYPE##_create_with_capacity(size_t capacity); \
-                                                                  \
-	void deque_##TYPE##_destroy(DEQUE_T*);                        \
-                                                                  \
-	bool deque_##TYPE##_push_front(DEQUE_T*, TYPE_T value);       \
-                                                                  \
-	bool deque_##TYPE##_push_back(DEQUE_T*, TYPE_T value);        \
-                                                                  \
-	bool deque_##TYPE##_pop_front(DEQUE_T*, TYPE_T* out);         \
-                                                                  \
-	bool deque_##TYPE##_pop_back(DEQUE_T*, TYPE_T* out);          \
-                                                                  \
-	const TYPE_T* deque_##TYPE##_peek_front(const DEQUE_T*);      \
-                                                                  \
-	const TYPE_T* deque_##TYPE##_peek_back(const DEQUE_T*);       \
-                                                                  \
-	size_t deque_##TYPE##_size(const DEQUE_T* d);                 \
-                                                                  \
+/** When a deque gives memory back before it's destroyed. */
+typedef enum deque_shrink_policy {
+	/** Keep the capacity; |shrink_to_fit| gives it back. */
+	DEQUE_SHRINK_NEVER,
+	/** Halve the capacity once a pop leaves the deque a quarter full. */
+	DEQUE_SHRINK_QUARTER
+} deque_shrink_policy_t;
+
+/** Returns the power of two capacity that holds |size| items, or 0. */
+size_t deque_capacity_for(size_t size);
+
+/**
+ * A circular buffer deque of |TYPE_T|. The capacity is a power of two, so
+ * indices wrap around with a mask, and doubles when the deque is full. Pops
+ * don't reallocate unless the |shrink_policy| says so; the default policy is
+ * |DEQUE_SHRINK_NEVER|, which suits queues that are filled and drained over
+ * and over.
+ *
+ * |push_back_n| pushes |count| items with a single reallocation at most;
+ * they must not point into the deque.
+ * |pop_front_n| pops up to |count| items into |out| (unless it's NULL) and
+ * returns the amount popped.
+ */
+#define DEFINE_DEQUE(DEQUE_T, TYPE_T, TYPE)                                 \
+	typedef struct deque_##TYPE {                                           \
+		TYPE_T* buffer;                                                     \
+		/* Index of the front item. */                                      \
+		size_t head;                                                        \
+		size_t capacity;                                                    \
+		size_t size;                                                        \
+		deque_shrink_policy_t shrinkPolicy;                                 \
+	} DEQUE_T;                                                              \
+                                                                            \
+	DEQUE_T deque_##TYPE##_create(void);                                    \
+                                                                            \
+	DEQUE_T deque_##TYPE##_create_with_capacity(size_t capacity);           \
+                                                                            \
+	void deque_##TYPE##_destroy(DEQUE_T*);                                  \
+                                                                            \
+	void deque_##TYPE##_set_shrink_policy(DEQUE_T*,                         \
+	                                      deque_shrink_policy_t policy);    \
+                                                                            \
+	bool deque_##TYPE##_shrink_to_fit(DEQUE_T*);                            \
+                                                                            \
+	bool deque_##TYPE##_push_front(DEQUE_T*, TYPE_T value);                 \
+                                                                            \
+	bool deque_##TYPE##_push_back(DEQUE_T*, TYPE_T value);                  \
+                                                                            \
+	bool deque_##TYPE##_push_back_n(DEQUE_T*, const TYPE_T* items,          \
+	                                size_t count);                          \
+                                                                            \
+	bool deque_##TYPE##_pop_front(DEQUE_T*, TYPE_T* out);                   \
+                                                                            \
+	bool deque_##TYPE##_pop_back(DEQUE_T*, TYPE_T* out);                    \
+                                                                            \
+	size_t deque_##TYPE##_pop_front_n(DEQUE_T*, TYPE_T* out, size_t count); \
+                                                                            \
+	const TYPE_T* deque_##TYPE##_peek_front(const DEQUE_T*);                \
+                                                                            \
+	const TYPE_T* deque_##TYPE##_peek_back(const DEQUE_T*);                 \
+                                                                            \
+	size_t deque_##TYPE##_size(const DEQUE_T* d);                           \
+                                                                            \
 	bool deque_##TYPE##_is_empty(const DEQUE_T* d);
 
-#define IMPL_DEQUE(DEQUE_T, TYPE_T, TYPE)                                      \
-	DEQUE_T deque_##TYPE##_create(void) {                                      \
-		return deque_##TYPE##_create_with_capacity(DEQUE_MIN_CAPACITY);        \
-	}                                                                          \
-                                                                               \
-	DEQUE_T deque_##TYPE##_create_with_capacity(size_t capacity) {             \
-		DEQUE_T d = {.head = 0,                                                \
-		             .tail = 0,                                                \
-		             .size = 0,                                                \
-		             .buffer = NULL,                                           \
-		             .capacity = capacity};                                    \
-		return d;                                                              \
-	}                                                                          \
-                                                                               \
-	void deque_##TYPE##_destroy(DEQUE_T* d) {                                  \
-		if (d->buffer != NULL) free(d->buffer);                                \
-                                                                               \
-		d->head = 0;                                                           \
-		d->tail = 0;                                                           \
-		d->size = 0;                                                           \
-		d->buffer = NULL;                                                      \
-		d->capacity = 0;                                                       \
-	}                                                                          \
-                                                                               \
-	bool deque_##TYPE##_grow(DEQUE_T* d) {                                     \
-		/* Grow the capacity by 1.5. */                                        \
-		size_t newSize = d->capacity * 3 / 2;                                  \
-                                                                               \
-		TYPE_T* newBuffer =                                                    \
-		    (TYPE_T*)realloc(d->buffer, newSize * sizeof(TYPE_T));             \
-		if (newBuffer == NULL) return false;                                   \
-                                                                               \
-		/* Move the elements after d->head to the end of the new buffer.       \
-		 * Elements after d->tail are not touched, if d->tail follows d->head. \
-		 */                                                                    \
-		size_t sizeDelta = newSize - d->capacity;                              \
-		memmove(newBuffer + d->head + sizeDelta, newBuffer + d->head,          \
-		        (d->capacity - d->head) * sizeof(TYPE_T));                     \
-                                                                               \
-		if (d->head <= d->tail) {                                              \
-			d->tail += sizeDelta;                                              \
-		}                                                                      \
-		d->head += sizeDelta;                                                  \
-                                                                               \
-		d->buffer = newBuffer;                                                 \
-		d->capacity = newSize;                                                 \
-                                                                               \
-		return true;                                                           \
-	}                                                                          \
-                                                                               \
-	bool deque_##TYPE##_shrink(DEQUE_T* d) {                                   \
-		size_t newSize = d->capacity * 2 / 3;                                  \
-                                                                               \
-		TYPE_T* newBuffer = (TYPE_T*)calloc(newSize, sizeof(TYPE_T));          \
-		if (newBuffer == NULL) return false;                                   \
-                                                                               \
-		if (d->head <= d->tail) {                                              \
-			/* If the deque layout is linear (head hasn't wrapped yet), we     \
-			 * copy it as is */                                                \
-			memcpy(newBuffer, d->buffer + d->head, d->size * sizeof(TYPE_T));  \
-			d->head = 0;                                                       \
-			d->tail = d->size - 1;                                             \
-		} else {                                                               \
-			/* If it had wrapped, we copy the multiple halves of the deque     \
-			 * separately.*/                                                   \
-			size_t sizeDelta = d->capacity - newSize;                          \
-                                                                               \
-			memcpy(newBuffer + d->head - sizeDelta, d->buffer + d->head,       \
-			       (d->capacity - d->head) * sizeof(TYPE_T));                  \
-			memcpy(newBuffer, d->buffer, (d->tail + 1) * sizeof(TYPE_T));      \
-                                                                               \
-			d->head -= sizeDelta;                                              \
-		}                                                                      \
-                                                                               \
-		free(d->buffer);                                                       \
-		d->buffer = newBuffer;                                                 \
-		d->capacity = newSize;                                                 \
-                                                                               \
-		return true;                                                           \
-	}                                                                          \
-                                                                               \
-	bool deque_##TYPE##_needs_shrink(DEQUE_T* d) {                             \
-		return d->size > DEQUE_MIN_CAPACITY && d->size <= d->capacity * 4 / 9; \
-	}                                                                          \
-                                                                               \
-	bool deque_##TYPE##_init(DEQUE_T* d) {                                     \
-		if (d->capacity == 0) return false; /* deque is destroyed */           \
-		if (d->buffer != NULL) return true; /* deque is initialized */         \
-                                                                               \
-		d->buffer = calloc(d->capacity, sizeof(TYPE_T));                       \
-		return d->buffer != NULL;                                              \
-	}                                                                          \
-                                                                               \
-	bool deque_##TYPE##_push_front(DEQUE_T* d, TYPE_T value) {                 \
-		bool initialized = deque_##TYPE##_init(d);                             \
-		if (!initialized) return false;                                        \
-                                                                               \
-		if (d->size == d->capacity) {                                          \
-			bool grown = deque_##TYPE##_grow(d);                               \
-			if (!grown) return false;                                          \
-		}                                                                      \
-                                                                               \
-		d->head = d->head == 0 ? d->capacity - 1 : d->head - 1;                \
-		d->buffer[d->head] = value;                                            \
-		d->size++;                                                             \
-                                                                               \
-		if (d->size == 1) d->tail = d->head;                                   \
-                                                                               \
-		return true;                                                           \
-	}                                                                          \
-                                                                               \
-	bool deque_##TYPE##_push_back(DEQUE_T* d, TYPE_T value) {                  \
-		bool initialized = deque_##TYPE##_init(d);                             \
-		if (!initialized) return false;                                        \
-                                                                               \
-		if (d->size == d->capacity) {                                          \
-			bool grown = deque_##TYPE##_grow(d);                               \
-			if (!grown) return false;                                          \
-		}                                                                      \
-                                                                               \
-		d->tail = (d->tail + 1) % d->capacity;                                 \
-		d->buffer[d->tail] = value;                                            \
-		d->size++;                                                             \
-                                                                               \
-		if (d->size == 1) d->head = d->tail;                                   \
-                                                                               \
-		return true;                                                           \
-	}                                                                          \
-                                                                               \
-	bool deque_##TYPE##_pop_front(DEQUE_T* d, TYPE_T* out) {                   \
-		if (d->size == 0) {                                                    \
-			return false;                                                      \
-		} else if (deque_##TYPE##_needs_shrink(d)) {                           \
-			bool shrunk = deque_##TYPE##_shrink(d);                            \
-			if (!shrunk) return false;                                         \
-		}                                                                      \
-                                                                               \
-		TYPE_T value = d->buffer[d->head];                                     \
-		d->head = (d->head + 1) % d->capacity;                                 \
-		d->size--;                                                             \
-                                                                               \
-		*out = value;                                                          \
-		return true;                                                           \
-	}                                                                          \
-                                                                               \
-	bool deque_##TYPE##_pop_back(DEQUE_T* d, TYPE_T* out) {                    \
-		if (out == NULL || d->size == 0) {                                     \
-			return false;                                                      \
-		} else if (deque_##TYPE##_needs_shrink(d)) {                           \
-			bool shrunk = deque_##TYPE##_shrink(d);                            \
-			if (!shrunk) return false;                                         \
-		}                                                                      \
-                                                                               \
-		TYPE_T value = d->buffer[d->tail];                                     \
-		d->tail = d->tail == 0 ? d->capacity - 1 : d->tail - 1;                \
-		d->size--;                                                             \
-                                                                               \
-		*out = value;                                                          \
-		return true;                                                           \
-	}                                                                          \
-                                                                               \
-	const TYPE_T* deque_##TYPE##_peek_front(const DEQUE_T* d) {                \
-		if (d->size == 0) return (const TYPE_T*)NULL;                          \
-		return (const TYPE_T*)&d->buffer[d->head];                             \
-	}                                                                          \
-                                                                               \
-	const TYPE_T* deque_##TYPE##_peek_back(const DEQUE_T* d) {                 \
-		if (d->size == 0) return (const TYPE_T*)NULL;                          \
-		return (const TYPE_T*)&d->buffer[d->tail];                             \
-	}                                                                          \
-                                                                               \
-	size_t deque_##TYPE##_size(const DEQUE_T* d) { return d->size; }           \
-                                                                               \
+#define IMPL_DEQUE(DEQUE_T, TYPE_T, TYPE)                                     \
+	/* Index of the |i|-th item from the front. */                            \
+	static inline size_t deque_##TYPE##_index(const DEQUE_T* d, size_t i) {   \
+		return (d->head + i) & (d->capacity - 1);                             \
+	}                                                                         \
+                                                                              \
+	/* Copies the items to the front of a new buffer of |capacity| items, */  \
+	/* which must hold them. Growing reallocates in place if it can: the */   \
+	/* items that wrapped around are moved past the old end instead. */       \
+	static bool deque_##TYPE##_resize(DEQUE_T* d, size_t capacity) {          \
+		if (capacity >= d->capacity * 2 || !d->buffer) {                      \
+			TYPE_T* newBuffer =                                               \
+			    (TYPE_T*)realloc(d->buffer, capacity * sizeof(TYPE_T));       \
+			if (newBuffer == NULL) return false;                              \
+                                                                              \
+			size_t end = d->head + d->size;                                   \
+			if (end > d->capacity) {                                          \
+				memcpy(newBuffer + d->capacity, newBuffer,                    \
+				       (end - d->capacity) * sizeof(TYPE_T));                 \
+			}                                                                 \
+                                                                              \
+			d->buffer = newBuffer;                                            \
+			d->capacity = capacity;                                           \
+			return true;                                                      \
+		}                                                                     \
+                                                                              \
+		TYPE_T* newBuffer = (TYPE_T*)malloc(capacity * sizeof(TYPE_T));       \
+		if (newBuffer == NULL) return false;                                  \
+                                                                              \
+		size_t first = d->capacity - d->head;                                 \
+		if (first > d->size) first = d->size;                                 \
+                                                                              \
+		memcpy(newBuffer, d->buffer + d->head, first * sizeof(TYPE_T));       \
+		memcpy(newBuffer + first, d->buffer,                                  \
+		       (d->size - first) * sizeof(TYPE_T));                           \
+                                                                              \
+		free(d->buffer);                                                      \
+		d->buffer = newBuffer;                                                \
+		d->head = 0;                                                          \
+		d->capacity = capacity;                                               \
+		return true;                                                          \
+	}                                                                         \
+                                                                              \
+	/* Grows |d| to hold at least |size| items, at least doubling it. */      \
+	static bool deque_##TYPE##_reserve(DEQUE_T* d, size_t size) {             \
+		if (size <= d->capacity) return true;                                 \
+                                                                              \
+		size_t capacity = deque_capacity_for(size);                           \
+		return capacity && deque_##TYPE##_resize(d, capacity);                \
+	}                                                                         \
+                                                                              \
+	/* Halves the buffer while it's a quarter full, if the policy allows. */  \
+	/* A failed shrink keeps the larger buffer. */                            \
+	static void deque_##TYPE##_shrink(DEQUE_T* d) {                           \
+		if (d->shrinkPolicy != DEQUE_SHRINK_QUARTER) return;                  \
+                                                                              \
+		size_t capacity = d->capacity;                                        \
+		while (capacity / 2 >= (size_t)DEQUE_MIN_CAPACITY &&                  \
+		       d->size <= capacity / 4)                                       \
+			capacity /= 2;                                                    \
+                                                                              \
+		if (capacity != d->capacity) deque_##TYPE##_resize(d, capacity);      \
+	}                                                                         \
+                                                                              \
+	DEQUE_T deque_##TYPE##_create(void) {                                     \
+		/* allocate later, when a push occurs */                              \
+		DEQUE_T d = {.buffer = NULL,                                          \
+		             .head = 0,                                               \
+		             .capacity = 0,                                           \
+		             .size = 0,                                               \
+		             .shrinkPolicy = DEQUE_SHRINK_NEVER};                     \
+		return d;                                                             \
+	}                                                                         \
+                                                                              \
+	DEQUE_T deque_##TYPE##_create_with_capacity(size_t capacity) {            \
+		DEQUE_T d = deque_##TYPE##_create();                                  \
+		/* If this fails, the first push allocates the buffer instead. */     \
+		deque_##TYPE##_reserve(&d, capacity);                                 \
+		return d;                                                             \
+	}                                                                         \
+                                                                              \
+	void deque_##TYPE##_destroy(DEQUE_T* d) {                                 \
+		if (d->buffer != NULL) free(d->buffer);                               \
+                                                                              \
+		d->buffer = NULL;                                                     \
+		d->head = 0;                                                          \
+		d->capacity = 0;                                                      \
+		d->size = 0;                                                          \
+	}                                                                         \
+                                                                              \
+	void deque_##TYPE##_set_shrink_policy(DEQUE_T* d,                         \
+	                                      deque_shrink_policy_t policy) {     \
+		d->shrinkPolicy = policy;                                             \
+	}                                                                         \
+                                                                              \
+	bool deque_##TYPE##_shrink_to_fit(DEQUE_T* d) {                           \
+		if (!d->buffer) return true;                                          \
+                                                                              \
+		if (d->size == 0) {                                                   \
+			deque_##TYPE##_destroy(d);                                        \
+			return true;                                                      \
+		}                                                                     \
+                                                                              \
+		size_t capacity = deque_capacity_for(d->size);                        \
+		if (capacity == d->capacity) return true;                             \
+                                                                              \
+		return deque_##TYPE##_resize(d, capacity);                            \
+	}                                                                         \
+                                                                              \
+	bool deque_##TYPE##_push_front(DEQUE_T* d, TYPE_T value) {                \
+		if (!deque_##TYPE##_reserve(d, d->size + 1)) return false;            \
+                                                                              \
+		d->head = (d->head - 1) & (d->capacity - 1);                          \
+		d->buffer[d->head] = value;                                           \
+		d->size++;                                                            \
+                                                                              \
+		return true;                                                          \
+	}                                                                         \
+                                                                              \
+	bool deque_##TYPE##_push_back(DEQUE_T* d, TYPE_T value) {                 \
+		if (!deque_##TYPE##_reserve(d, d->size + 1)) return false;            \
+                                                                              \
+		d->buffer[deque_##TYPE##_index(d, d->size)] = value;                  \
+		d->size++;                                                            \
+                                                                              \
+		return true;                                                          \
+	}                                                                         \
+                                                                              \
+	bool deque_##TYPE##_push_back_n(DEQUE_T* d, const TYPE_T* items,          \
+	                                size_t count) {                           \
+		if (count == 0) return true;                                          \
+		if (!items || count > SIZE_MAX - d->size) return false;               \
+		if (!deque_##TYPE##_reserve(d, d->size + count)) return false;        \
+                                                                              \
+		/* The items go up to the end of the buffer, then wrap around. */     \
+		size_t tail = deque_##TYPE##_index(d, d->size);                       \
+		size_t first = d->capacity - tail;                                    \
+		if (first > count) first = count;                                     \
+                                                                              \
+		memcpy(d->buffer + tail, items, first * sizeof(TYPE_T));              \
+		memcpy(d->buffer, items + first, (count - first) * sizeof(TYPE_T));   \
+		d->size += count;                                                     \
+                                                                              \
+		return true;                                                          \
+	}                                                                         \
+                                                                              \
+	bool deque_##TYPE##_pop_front(DEQUE_T* d, TYPE_T* out) {                  \
+		if (out == NULL || d->size == 0) return false;                        \
+                                                                              \
+		*out = d->buffer[d->head];                                            \
+		d->head = deque_##TYPE##_index(d, 1);                                 \
+		d->size--;                                                            \
+                                                                              \
+		deque_##TYPE##_shrink(d);                                             \
+		return true;                                                          \
+	}                                                                         \
+                                                                              \
+	bool deque_##TYPE##_pop_back(DEQUE_T* d, TYPE_T* out) {                   \
+		if (out == NULL || d->size == 0) return false;                        \
+                                                                              \
+		*out = d->buffer[deque_##TYPE##_index(d, d->size - 1)];               \
+		d->size--;                                                            \
+                                                                              \
+		deque_##TYPE##_shrink(d);                                             \
+		return true;                                                          \
+	}                                                                         \
+                                                                              \
+	size_t deque_##TYPE##_pop_front_n(DEQUE_T* d, TYPE_T* out,                \
+	                                  size_t count) {                         \
+		if (count > d->size) count = d->size;                                 \
+		if (count == 0) return 0;                                             \
+                                                                              \
+		if (out != NULL) {                                                    \
+			size_t first = d->capacity - d->head;                             \
+			if (first > count) first = count;                                 \
+                                                                              \
+			memcpy(out, d->buffer + d->head, first * sizeof(TYPE_T));         \
+			memcpy(out + first, d->buffer, (count - first) * sizeof(TYPE_T)); \
+		}                                                                     \
+                                                                              \
+		d->head = deque_##TYPE##_index(d, count);                             \
+		d->size -= count;                                                     \
+                                                                              \
+		deque_##TYPE##_shrink(d);                                             \
+		return count;                                                         \
+	}                                                                         \
+                                                                              \
+	const TYPE_T* deque_##TYPE##_peek_front(const DEQUE_T* d) {               \
+		if (d->size == 0) return (const TYPE_T*)NULL;                         \
+		return (const TYPE_T*)&d->buffer[d->head];                            \
+	}                                                                         \
+                                                                              \
+	const TYPE_T* deque_##TYPE##_peek_back(const DEQUE_T* d) {                \
+		if (d->size == 0) return (const TYPE_T*)NULL;                         \
+		size_t back = deque_##TYPE##_index(d, d->size - 1);                   \
+		return (const TYPE_T*)&d->buffer[back];                               \
+	}                                                                         \
+                                                                              \
+	size_t deque_##TYPE##_size(const DEQUE_T* d) { return d->size; }          \
+                                                                              \
 	bool deque_##TYPE##_is_empty(const DEQUE_T* d) { return d->size == 0; }
 
 DEFINE_DEQUE(deque_i64_t, int64_t, i64)
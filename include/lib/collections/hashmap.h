@@ -0,0 +1,332 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Least capacity of an allocated map; a power of two. */
+extern const size_t HASHMAP_MIN_CAPACITY;
+
+/** Returns the most entries a map of |capacity| slots holds. */
+static inline size_t hashmap_max_size(size_t capacity) {
+	return capacity - capacity / 4;
+}
+
+/**
+ * Returns the power of two capacity that holds |count| entries, or 0 if it's
+ * too large.
+ */
+size_t hashmap_capacity_for(size_t count);
+
+/**
+ * Mixes a user hash, so that hashes differing in any bits spread out over the
+ * low bits that index the slots: the product carries the low bits of |hash|
+ * up, and folding it carries them back down.
+ */
+static inline uint32_t hashmap_mix(uint64_t hash) {
+	hash *= 0x9E3779B97F4A7C15ull;
+	return (uint32_t)(hash ^ (hash >> 32));
+}
+
+/**
+ * Hash map from |KEY_T| to |VAL_T| in a flat array, probed linearly in Robin
+ * Hood order: an entry that's further from its home slot takes the place of
+ * one that's closer, which keeps probes short even at a high load. Removals
+ * shift the following entries back instead of leaving tombstones.
+ *
+ * The probe distances live in an array of their own, so a probe reads few
+ * cache lines, and only compares keys whose distance matches: in Robin Hood
+ * order, those are the keys with the same home slot. Hashes aren't stored;
+ * growing the map hashes every key again.
+ *
+ * Keys and values are stored by value; a map of pointers or views doesn't
+ * own what they point to. |put| inserts or overwrites, |get| and
+ * |get_or_put| return a pointer to the value that's valid until the next
+ * insertion or removal. |reserve| makes room for |count| entries, |rehash|
+ * rebuilds the map for |count| entries (or its size, if that's larger),
+ * which also shrinks it. |next| iterates over the entries in no particular
+ * order, starting from a zero |cursor|.
+ *
+ * |get_or_put_slot| is |get_or_put| returning the whole slot and whether it
+ * was just inserted; the caller may replace the slot's key with an equal
+ * one, e.g. a copy it owns.
+ */
+#define DEFINE_HASHMAP(MAP_T, KEY_T, VAL_T, TYPE)                        \
+	typedef struct hashmap_##TYPE##_slot {                               \
+		KEY_T key;                                                       \
+		VAL_T value;                                                     \
+	} hashmap_##TYPE##_slot_t;                                           \
+                                                                         \
+	typedef struct hashmap_##TYPE {                                      \
+		hashmap_##TYPE##_slot_t* slots;                                  \
+		/* Distance of each slot from its home plus one, zero if it's */ \
+		/* empty; allocated together with |slots|, ahead of them. */     \
+		uint32_t* probes;                                                \
+		size_t capacity;                                                 \
+		size_t size;                                                     \
+	} MAP_T;                                                             \
+                                                                         \
+	MAP_T hashmap_##TYPE##_create(void);                                 \
+                                                                         \
+	void hashmap_##TYPE##_destroy(MAP_T*);                               \
+                                                                         \
+	bool hashmap_##TYPE##_reserve(MAP_T*, size_t count);                 \
+                                                                         \
+	bool hashmap_##TYPE##_rehash(MAP_T*, size_t count);                  \
+                                                                         \
+	bool hashmap_##TYPE##_put(MAP_T*, KEY_T key, VAL_T value);           \
+                                                                         \
+	VAL_T* hashmap_##TYPE##_get(const MAP_T*, KEY_T key);                \
+                                                                         \
+	VAL_T* hashmap_##TYPE##_get_or_put(MAP_T*, KEY_T key, VAL_T value);  \
+                                                                         \
+	hashmap_##TYPE##_slot_t* hashmap_##TYPE##_get_or_put_slot(           \
+	    MAP_T*, KEY_T key, VAL_T value, bool* inserted);                 \
+                                                                         \
+	bool hashmap_##TYPE##_remove(MAP_T*, KEY_T key, VAL_T* out);         \
+                                                                         \
+	void hashmap_##TYPE##_clear(MAP_T*);                                 \
+                                                                         \
+	bool hashmap_##TYPE##_next(const MAP_T*, size_t* cursor, KEY_T* key, \
+	                           VAL_T** value);                           \
+                                                                         \
+	size_t hashmap_##TYPE##_size(const MAP_T*);                          \
+                                                                         \
+	size_t hashmap_##TYPE##_capacity(const MAP_T*);
+
+/**
+ * Implements the functions of |DEFINE_HASHMAP|. |HASH| takes a key and
+ * returns a `uint64_t`, |EQ| takes two keys and returns whether they're
+ * equal; keys that are equal must have equal hashes.
+ */
+#define IMPL_HASHMAP(MAP_T, KEY_T, VAL_T, TYPE, HASH, EQ)                      \
+	/* Index of the slot holding |key|, or `SIZE_MAX`. */                      \
+	static size_t hashmap_##TYPE##_find(const MAP_T* m, KEY_T key) {           \
+		if (!m->size) return SIZE_MAX;                                         \
+                                                                               \
+		size_t mask = m->capacity - 1;                                         \
+		size_t i = hashmap_mix(HASH(key)) & mask;                              \
+                                                                               \
+		/* Past an entry that's closer to its home, |key| would have */        \
+		/* taken its place. The map is never full, so this stops. */           \
+		for (uint32_t probe = 1;; ++probe, i = (i + 1) & mask) {               \
+			uint32_t cur = m->probes[i];                                       \
+                                                                               \
+			if (cur < probe) return SIZE_MAX;                                  \
+			if (cur == probe && EQ(m->slots[i].key, key)) return i;            \
+		}                                                                      \
+	}                                                                          \
+                                                                               \
+	/* Places |slot|, whose key isn't in |m|, into a map that has room for */  \
+	/* it, probing from index |i| at distance |probe|; returns the index */    \
+	/* it ends up at. */                                                       \
+	static size_t hashmap_##TYPE##_place(MAP_T* m,                             \
+	                                     hashmap_##TYPE##_slot_t slot,         \
+	                                     uint32_t probe, size_t i) {           \
+		size_t mask = m->capacity - 1;                                         \
+		size_t placed = SIZE_MAX;                                              \
+                                                                               \
+		for (;; ++probe, i = (i + 1) & mask) {                                 \
+			uint32_t cur = m->probes[i];                                       \
+                                                                               \
+			if (!cur) {                                                        \
+				m->slots[i] = slot;                                            \
+				m->probes[i] = probe;                                          \
+				return placed == SIZE_MAX ? i : placed;                        \
+			}                                                                  \
+                                                                               \
+			if (cur < probe) {                                                 \
+				/* Carry on placing the displaced entry. */                    \
+				hashmap_##TYPE##_slot_t displaced = m->slots[i];               \
+				m->slots[i] = slot;                                            \
+				m->probes[i] = probe;                                          \
+				slot = displaced;                                              \
+				probe = cur;                                                   \
+                                                                               \
+				if (placed == SIZE_MAX) placed = i;                            \
+			}                                                                  \
+		}                                                                      \
+	}                                                                          \
+                                                                               \
+	static bool hashmap_##TYPE##_resize(MAP_T* m, size_t capacity) {           \
+		size_t slotSize = sizeof(uint32_t) + sizeof(hashmap_##TYPE##_slot_t);  \
+		if (capacity > SIZE_MAX / slotSize) return false;                      \
+                                                                               \
+		/* A power of two number of probes, at least 8, keeps the slots */     \
+		/* that follow them aligned. */                                        \
+		char* block = (char*)malloc(capacity * slotSize);                      \
+		if (!block) return false;                                              \
+                                                                               \
+		memset(block, 0, capacity * sizeof(uint32_t));                         \
+                                                                               \
+		hashmap_##TYPE##_slot_t* oldSlots = m->slots;                          \
+		uint32_t* oldProbes = m->probes;                                       \
+		size_t oldCapacity = m->capacity;                                      \
+                                                                               \
+		m->probes = (uint32_t*)block;                                          \
+		m->slots = (hashmap_##TYPE##_slot_t*)(block +                          \
+		                                      capacity * sizeof(uint32_t));    \
+		m->capacity = capacity;                                                \
+                                                                               \
+		/* Start at the beginning of a cluster: in Robin Hood order, the */    \
+		/* entries then come by their home slot, and don't displace each */    \
+		/* other in the new slots. */                                          \
+		size_t oldMask = oldCapacity - 1;                                      \
+		size_t start = 0;                                                      \
+		while (start != oldCapacity && oldProbes[start] > 1) ++start;          \
+                                                                               \
+		for (size_t k = 0; k != oldCapacity; ++k) {                            \
+			size_t i = (start + k) & oldMask;                                  \
+			if (!oldProbes[i]) continue;                                       \
+                                                                               \
+			size_t home = hashmap_mix(HASH(oldSlots[i].key)) & (capacity - 1); \
+			hashmap_##TYPE##_place(m, oldSlots[i], 1, home);                   \
+		}                                                                      \
+                                                                               \
+		free(oldProbes);                                                       \
+		return true;                                                           \
+	}                                                                          \
+                                                                               \
+	MAP_T hashmap_##TYPE##_create(void) {                                      \
+		/* allocate later, when an insertion occurs */                         \
+		MAP_T m = {.slots = NULL, .probes = NULL, .capacity = 0, .size = 0};   \
+		return m;                                                              \
+	}                                                                          \
+                                                                               \
+	void hashmap_##TYPE##_destroy(MAP_T* m) {                                  \
+		if (!m) return;                                                        \
+                                                                               \
+		/* The slots are in the same block. */                                 \
+		free(m->probes);                                                       \
+		*m = hashmap_##TYPE##_create();                                        \
+	}                                                                          \
+                                                                               \
+	bool hashmap_##TYPE##_reserve(MAP_T* m, size_t count) {                    \
+		if (!m) return false;                                                  \
+		if (count <= hashmap_max_size(m->capacity)) return true;               \
+                                                                               \
+		size_t capacity = hashmap_capacity_for(count);                         \
+		return capacity && hashmap_##TYPE##_resize(m, capacity);               \
+	}                                                                          \
+                                                                               \
+	bool hashmap_##TYPE##_rehash(MAP_T* m, size_t count) {                     \
+		if (!m) return false;                                                  \
+		if (count < m->size) count = m->size;                                  \
+                                                                               \
+		if (!count) {                                                          \
+			hashmap_##TYPE##_destroy(m);                                       \
+			return true;                                                       \
+		}                                                                      \
+                                                                               \
+		size_t capacity = hashmap_capacity_for(count);                         \
+		return capacity && hashmap_##TYPE##_resize(m, capacity);               \
+	}                                                                          \
+                                                                               \
+	hashmap_##TYPE##_slot_t* hashmap_##TYPE##_get_or_put_slot(                 \
+	    MAP_T* m, KEY_T key, VAL_T value, bool* inserted) {                    \
+		if (!m || !inserted) return NULL;                                      \
+                                                                               \
+		/* Make room first, so the probe for |key| ends where it goes. */      \
+		if (!hashmap_##TYPE##_reserve(m, m->size + 1)) return NULL;            \
+                                                                               \
+		size_t mask = m->capacity - 1;                                         \
+		size_t i = hashmap_mix(HASH(key)) & mask;                              \
+		uint32_t probe = 1;                                                    \
+                                                                               \
+		for (;; ++probe, i = (i + 1) & mask) {                                 \
+			uint32_t cur = m->probes[i];                                       \
+                                                                               \
+			if (cur < probe) break;                                            \
+			if (cur == probe && EQ(m->slots[i].key, key)) {                    \
+				*inserted = false;                                             \
+				return &m->slots[i];                                           \
+			}                                                                  \
+		}                                                                      \
+                                                                               \
+		hashmap_##TYPE##_slot_t slot = {.key = key, .value = value};           \
+		i = hashmap_##TYPE##_place(m, slot, probe, i);                         \
+		++m->size;                                                             \
+                                                                               \
+		*inserted = true;                                                      \
+		return &m->slots[i];                                                   \
+	}                                                                          \
+                                                                               \
+	VAL_T* hashmap_##TYPE##_get_or_put(MAP_T* m, KEY_T key, VAL_T value) {     \
+		bool inserted;                                                         \
+		hashmap_##TYPE##_slot_t* slot =                                        \
+		    hashmap_##TYPE##_get_or_put_slot(m, key, value, &inserted);        \
+		return slot ? &slot->value : NULL;                                     \
+	}                                                                          \
+                                                                               \
+	bool hashmap_##TYPE##_put(MAP_T* m, KEY_T key, VAL_T value) {              \
+		VAL_T* stored = hashmap_##TYPE##_get_or_put(m, key, value);            \
+		if (!stored) return false;                                             \
+                                                                               \
+		*stored = value;                                                       \
+		return true;                                                           \
+	}                                                                          \
+                                                                               \
+	VAL_T* hashmap_##TYPE##_get(const MAP_T* m, KEY_T key) {                   \
+		if (!m) return NULL;                                                   \
+                                                                               \
+		size_t i = hashmap_##TYPE##_find(m, key);                              \
+		return i == SIZE_MAX ? NULL : &m->slots[i].value;                      \
+	}                                                                          \
+                                                                               \
+	bool hashmap_##TYPE##_remove(MAP_T* m, KEY_T key, VAL_T* out) {            \
+		if (!m) return false;                                                  \
+                                                                               \
+		size_t i = hashmap_##TYPE##_find(m, key);                              \
+		if (i == SIZE_MAX) return false;                                       \
+                                                                               \
+		if (out) *out = m->slots[i].value;                                     \
+                                                                               \
+		/* Shift the entries that follow back by one, until an empty slot */   \
+		/* or one that's in its home slot. */                                  \
+		size_t mask = m->capacity - 1;                                         \
+                                                                               \
+		for (;;) {                                                             \
+			size_t next = (i + 1) & mask;                                      \
+			if (m->probes[next] <= 1) break;                                   \
+                                                                               \
+			m->slots[i] = m->slots[next];                                      \
+			m->probes[i] = m->probes[next] - 1;                                \
+			i = next;                                                          \
+		}                                                                      \
+                                                                               \
+		m->probes[i] = 0;                                                      \
+		--m->size;                                                             \
+		return true;                                                           \
+	}                                                                          \
+                                                                               \
+	void hashmap_##TYPE##_clear(MAP_T* m) {                                    \
+		if (!m || !m->probes) return;                                          \
+                                                                               \
+		/* Keep the slots for the next entries. */                             \
+		memset(m->probes, 0, m->capacity * sizeof(uint32_t));                  \
+		m->size = 0;                                                           \
+	}                                                                          \
+                                                                               \
+	bool hashmap_##TYPE##_next(const MAP_T* m, size_t* cursor, KEY_T* key,     \
+	                           VAL_T** value) {                                \
+		if (!m || !cursor) return false;                                       \
+                                                                               \
+		for (; *cursor < m->capacity; ++*cursor) {                             \
+			if (!m->probes[*cursor]) continue;                                 \
+                                                                               \
+			hashmap_##TYPE##_slot_t* slot = &m->slots[*cursor];                \
+			if (key) *key = slot->key;                                         \
+			if (value) *value = &slot->value;                                  \
+                                                                               \
+			++*cursor;                                                         \
+			return true;                                                       \
+		}                                                                      \
+                                                                               \
+		return false;                                                          \
+	}                                                                          \
+                                                                               \
+	size_t hashmap_##TYPE##_size(const MAP_T* m) { return m->size; }           \
+                                                                               \
+	size_t hashmap_##TYPE##_capacity(const MAP_T* m) { return m->capacity; }
@@ -0,0 +1,334 @@
+#pragma once
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Bounded lock-free queues for passing items between threads. The capacity
+ * is fixed at creation and rounded up to a power of two; pushes into a full
+ * ring and pops from an empty one fail instead of waiting.
+ *
+ * The indices the producers and the consumers write live on separate cache
+ * lines, so a ring must be aligned to |RING_CACHE_LINE|: automatic and static
+ * rings are, heap-allocated ones need `aligned_alloc`.
+ */
+
+/** Assumed size of a cache line, in bytes. */
+#define RING_CACHE_LINE 64
+
+/** Returns the power of two capacity that holds |capacity| items, or 0. */
+size_t ring_capacity_for(size_t capacity);
+
+/**
+ * A ring for a single producer thread and a single consumer thread. Each side
+ * keeps a copy of the other's index and only reloads it when the ring looks
+ * full (or empty), so they rarely touch each other's cache line.
+ *
+ * |push_n| and |pop_n| move up to |count| items at once, publishing them with
+ * a single store, and return the amount moved. |size| is exact only for the
+ * producer or the consumer when the other side is idle.
+ */
+#define DEFINE_SPSC_RING(RING_T, TYPE_T, TYPE)                           \
+	typedef struct spsc_ring_##TYPE {                                    \
+		/* Written by the consumer. */                                   \
+		alignas(RING_CACHE_LINE) atomic_size_t head;                     \
+		size_t cachedTail;                                               \
+		/* Written by the producer. */                                   \
+		alignas(RING_CACHE_LINE) atomic_size_t tail;                     \
+		size_t cachedHead;                                               \
+		/* Read-only once created. */                                    \
+		alignas(RING_CACHE_LINE) TYPE_T* buffer;                         \
+		size_t capacity;                                                 \
+	} RING_T;                                                            \
+                                                                         \
+	bool spsc_ring_##TYPE##_create(RING_T*, size_t capacity);            \
+                                                                         \
+	void spsc_ring_##TYPE##_destroy(RING_T*);                            \
+                                                                         \
+	bool spsc_ring_##TYPE##_push(RING_T*, TYPE_T value);                 \
+                                                                         \
+	size_t spsc_ring_##TYPE##_push_n(RING_T*, TYPE_T const* items,       \
+	                                 size_t count);                      \
+                                                                         \
+	bool spsc_ring_##TYPE##_pop(RING_T*, TYPE_T* out);                   \
+                                                                         \
+	size_t spsc_ring_##TYPE##_pop_n(RING_T*, TYPE_T* out, size_t count); \
+                                                                         \
+	size_t spsc_ring_##TYPE##_size(RING_T*);                             \
+                                                                         \
+	size_t spsc_ring_##TYPE##_capacity(const RING_T*);
+
+#define IMPL_SPSC_RING(RING_T, TYPE_T, TYPE)                                 \
+	bool spsc_ring_##TYPE##_create(RING_T* r, size_t capacity) {             \
+		if (!r) return false;                                                \
+                                                                             \
+		capacity = ring_capacity_for(capacity);                              \
+		if (!capacity) return false;                                         \
+                                                                             \
+		r->buffer = (TYPE_T*)malloc(capacity * sizeof(TYPE_T));              \
+		if (!r->buffer) return false;                                        \
+                                                                             \
+		r->capacity = capacity;                                              \
+		atomic_init(&r->head, 0);                                            \
+		atomic_init(&r->tail, 0);                                            \
+		r->cachedHead = 0;                                                   \
+		r->cachedTail = 0;                                                   \
+		return true;                                                         \
+	}                                                                        \
+                                                                             \
+	void spsc_ring_##TYPE##_destroy(RING_T* r) {                             \
+		if (!r) return;                                                      \
+                                                                             \
+		free(r->buffer);                                                     \
+		r->buffer = NULL;                                                    \
+		r->capacity = 0;                                                     \
+	}                                                                        \
+                                                                             \
+	size_t spsc_ring_##TYPE##_push_n(RING_T* r, TYPE_T const* items,         \
+	                                 size_t count) {                         \
+		size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);  \
+                                                                             \
+		if (r->capacity - (tail - r->cachedHead) < count) {                  \
+			r->cachedHead =                                                  \
+			    atomic_load_explicit(&r->head, memory_order_acquire);        \
+		}                                                                    \
+                                                                             \
+		size_t room = r->capacity - (tail - r->cachedHead);                  \
+		if (count > room) count = room;                                      \
+		if (!count) return 0;                                                \
+                                                                             \
+		/* The items go up to the end of the buffer, then wrap around. */    \
+		size_t start = tail & (r->capacity - 1);                             \
+		size_t first = r->capacity - start < count ? r->capacity - start     \
+		                                           : count;                  \
+                                                                             \
+		memcpy(r->buffer + start, items, first * sizeof(TYPE_T));            \
+		memcpy(r->buffer, items + first, (count - first) * sizeof(TYPE_T));  \
+		atomic_store_explicit(&r->tail, tail + count, memory_order_release); \
+		return count;                                                        \
+	}                                                                        \
+                                                                             \
+	bool spsc_ring_##TYPE##_push(RING_T* r, TYPE_T value) {                  \
+		return spsc_ring_##TYPE##_push_n(r, &value, 1) == 1;                 \
+	}                                                                        \
+                                                                             \
+	size_t spsc_ring_##TYPE##_pop_n(RING_T* r, TYPE_T* out, size_t count) {  \
+		size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);  \
+                                                                             \
+		if (r->cachedTail - head < count) {                                  \
+			r->cachedTail =                                                  \
+			    atomic_load_explicit(&r->tail, memory_order_acquire);        \
+		}                                                                    \
+                                                                             \
+		size_t used = r->cachedTail - head;                                  \
+		if (count > used) count = used;                                      \
+		if (!count) return 0;                                                \
+                                                                             \
+		size_t start = head & (r->capacity - 1);                             \
+		size_t first = r->capacity - start < count ? r->capacity - start     \
+		                                           : count;                  \
+                                                                             \
+		memcpy(out, r->buffer + start, first * sizeof(TYPE_T));              \
+		memcpy(out + first, r->buffer, (count - first) * sizeof(TYPE_T));    \
+		atomic_store_explicit(&r->head, head + count, memory_order_release); \
+		return count;                                                        \
+	}                                                                        \
+                                                                             \
+	bool spsc_ring_##TYPE##_pop(RING_T* r, TYPE_T* out) {                    \
+		return out && spsc_ring_##TYPE##_pop_n(r, out, 1) == 1;              \
+	}                                                                        \
+                                                                             \
+	size_t spsc_ring_##TYPE##_size(RING_T* r) {                              \
+		size_t head = atomic_load_explicit(&r->head, memory_order_acquire);  \
+		size_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);  \
+		return tail - head;                                                  \
+	}                                                                        \
+                                                                             \
+	size_t spsc_ring_##TYPE##_capacity(const RING_T* r) {                    \
+		return r->capacity;                                                  \
+	}
+
+/**
+ * A ring for any amount of producer and consumer threads, after Dmitry
+ * Vyukov's bounded queue. Every slot has a sequence number telling which
+ * position may use it next: a thread checks the slot at |tail| (or |head|)
+ * first and only then claims the position by advancing the index, so it
+ * never waits for a thread that claimed a position before it.
+ *
+ * |push_n| and |pop_n| claim up to |count| consecutive positions whose slots
+ * are ready with a single compare-and-swap and return the amount moved.
+ * Items of a producer are popped in the order it pushed them. |size| is a
+ * snapshot.
+ */
+#define DEFINE_MPMC_RING(RING_T, TYPE_T, TYPE)                           \
+	typedef struct mpmc_ring_slot_##TYPE {                               \
+		atomic_size_t sequence;                                          \
+		TYPE_T value;                                                    \
+	} mpmc_ring_slot_##TYPE##_t;                                         \
+                                                                         \
+	typedef struct mpmc_ring_##TYPE {                                    \
+		/* Next position to pop. */                                      \
+		alignas(RING_CACHE_LINE) atomic_size_t head;                     \
+		/* Next position to push. */                                     \
+		alignas(RING_CACHE_LINE) atomic_size_t tail;                     \
+		/* Read-only once created. */                                    \
+		alignas(RING_CACHE_LINE) mpmc_ring_slot_##TYPE##_t* slots;       \
+		size_t capacity;                                                 \
+	} RING_T;                                                            \
+                                                                         \
+	bool mpmc_ring_##TYPE##_create(RING_T*, size_t capacity);            \
+                                                                         \
+	void mpmc_ring_##TYPE##_destroy(RING_T*);                            \
+                                                                         \
+	bool mpmc_ring_##TYPE##_push(RING_T*, TYPE_T value);                 \
+                                                                         \
+	size_t mpmc_ring_##TYPE##_push_n(RING_T*, TYPE_T const* items,       \
+	                                 size_t count);                      \
+                                                                         \
+	bool mpmc_ring_##TYPE##_pop(RING_T*, TYPE_T* out);                   \
+                                                                         \
+	size_t mpmc_ring_##TYPE##_pop_n(RING_T*, TYPE_T* out, size_t count); \
+                                                                         \
+	size_t mpmc_ring_##TYPE##_size(RING_T*);                             \
+                                                                         \
+	size_t mpmc_ring_##TYPE##_capacity(const RING_T*);
+
+#define IMPL_MPMC_RING(RING_T, TYPE_T, TYPE)                                \
+	bool mpmc_ring_##TYPE##_create(RING_T* r, size_t capacity) {            \
+		if (!r) return false;                                               \
+                                                                            \
+		capacity = ring_capacity_for(capacity);                             \
+		if (!capacity) return false;                                        \
+                                                                            \
+		r->slots = (mpmc_ring_slot_##TYPE##_t*)malloc(                      \
+		    capacity * sizeof(mpmc_ring_slot_##TYPE##_t));                  \
+		if (!r->slots) return false;                                        \
+                                                                            \
+		/* Slot |i| is free for the push at position |i|. */                \
+		for (size_t i = 0; i != capacity; ++i) {                            \
+			atomic_init(&r->slots[i].sequence, i);                          \
+		}                                                                   \
+                                                                            \
+		r->capacity = capacity;                                             \
+		atomic_init(&r->head, 0);                                           \
+		atomic_init(&r->tail, 0);                                           \
+		return true;                                                        \
+	}                                                                       \
+                                                                            \
+	void mpmc_ring_##TYPE##_destroy(RING_T* r) {                            \
+		if (!r) return;                                                     \
+                                                                            \
+		free(r->slots);                                                     \
+		r->slots = NULL;                                                    \
+		r->capacity = 0;                                                    \
+	}                                                                       \
+                                                                            \
+	/* Claims up to |count| consecutive positions to push (or pop) whose */ \
+	/* slots are ready, by advancing the tail (or the head); returns the */ \
+	/* amount and the first one in |from|. */                               \
+	static size_t mpmc_ring_##TYPE##_claim(RING_T* r, bool push,            \
+	                                       size_t count, size_t* from) {    \
+		atomic_size_t* index = push ? &r->tail : &r->head;                  \
+		/* A slot is ready to push at |pos| when its sequence is |pos|, */  \
+		/* and to pop when the push has set it to |pos + 1|. */             \
+		size_t ready = push ? 0 : 1;                                        \
+		size_t mask = r->capacity - 1;                                      \
+                                                                            \
+		size_t pos = atomic_load_explicit(index, memory_order_relaxed);     \
+                                                                            \
+		for (;;) {                                                          \
+			size_t n = 0;                                                   \
+			intptr_t diff = 0;                                              \
+                                                                            \
+			for (; n != count; ++n) {                                       \
+				size_t sequence = atomic_load_explicit(                     \
+				    &r->slots[(pos + n) & mask].sequence,                   \
+				    memory_order_acquire);                                  \
+				diff = (intptr_t)(sequence - (pos + n + ready));            \
+				if (diff) break;                                            \
+			}                                                               \
+                                                                            \
+			if (n) {                                                        \
+				/* Nobody else can use the checked slots unless they */     \
+				/* claim them first, which makes this fail. */              \
+				if (atomic_compare_exchange_weak_explicit(                  \
+				        index, &pos, pos + n, memory_order_relaxed,         \
+				        memory_order_relaxed)) {                            \
+					*from = pos;                                            \
+					return n;                                               \
+				}                                                           \
+			} else if (diff < 0) {                                          \
+				/* Full (or empty), or the thread a lap behind hasn't */    \
+				/* finished with the slot yet. */                           \
+				return 0;                                                   \
+			} else {                                                        \
+				/* Another thread has moved past a stale |pos|. */          \
+				pos = atomic_load_explicit(index, memory_order_relaxed);    \
+			}                                                               \
+		}                                                                   \
+	}                                                                       \
+                                                                            \
+	size_t mpmc_ring_##TYPE##_push_n(RING_T* r, TYPE_T const* items,        \
+	                                 size_t count) {                        \
+		size_t from;                                                        \
+		size_t n = mpmc_ring_##TYPE##_claim(r, true, count, &from);         \
+                                                                            \
+		for (size_t i = 0; i != n; ++i) {                                   \
+			size_t pos = from + i;                                          \
+			mpmc_ring_slot_##TYPE##_t* slot =                               \
+			    &r->slots[pos & (r->capacity - 1)];                         \
+                                                                            \
+			slot->value = items[i];                                         \
+			atomic_store_explicit(&slot->sequence, pos + 1,                 \
+			                      memory_order_release);                    \
+		}                                                                   \
+                                                                            \
+		return n;                                                           \
+	}                                                                       \
+                                                                            \
+	bool mpmc_ring_##TYPE##_push(RING_T* r, TYPE_T value) {                 \
+		return mpmc_ring_##TYPE##_push_n(r, &value, 1) == 1;                \
+	}                                                                       \
+                                                                            \
+	size_t mpmc_ring_##TYPE##_pop_n(RING_T* r, TYPE_T* out, size_t count) { \
+		size_t from;                                                        \
+		size_t n = mpmc_ring_##TYPE##_claim(r, false, count, &from);        \
+                                                                            \
+		for (size_t i = 0; i != n; ++i) {                                   \
+			size_t pos = from + i;                                          \
+			mpmc_ring_slot_##TYPE##_t* slot =                               \
+			    &r->slots[pos & (r->capacity - 1)];                         \
+                                                                            \
+			out[i] = slot->value;                                           \
+			atomic_store_explicit(&slot->sequence, pos + r->capacity,       \
+			                      memory_order_release);                    \
+		}                                                                   \
+                                                                            \
+		return n;                                                           \
+	}                                                                       \
+                                                                            \
+	bool mpmc_ring_##TYPE##_pop(RING_T* r, TYPE_T* out) {                   \
+		return out && mpmc_ring_##TYPE##_pop_n(r, out, 1) == 1;             \
+	}                                                                       \
+                                                                            \
+	size_t mpmc_ring_##TYPE##_size(RING_T* r) {                             \
+		size_t head = atomic_load_explicit(&r->head, memory_order_acquire); \
+		size_t tail = atomic_load_explicit(&r->tail, memory_order_acquire); \
+		return tail > head ? tail - head : 0;                               \
+	}                                                                       \
+                                                                            \
+	size_t mpmc_ring_##TYPE##_capacity(const RING_T* r) {                   \
+		return r->capacity;                                                 \
+	}
+
+DEFINE_SPSC_RING(spsc_ring_i64_t, int64_t, i64)
+DEFINE_SPSC_RING(spsc_ring_u64_t, uint64_t, u64)
+DEFINE_SPSC_RING(spsc_ring_ptr_t, void*, ptr)
+DEFINE_MPMC_RING(mpmc_ring_i64_t, int64_t, i64)
+DEFINE_MPMC_RING(mpmc_ring_u64_t, uint64_t, u64)
+DEFINE_MPMC_RING(mpmc_ring_ptr_t, void*, ptr)
@@ -2,8 +2,26 @@
 
 #include "vector.h"
 
+/** Strings of at most this many characters are stored without allocating. */
+#define STRING_SMALL_CAPACITY 23
+
+/**
+ * Null-terminated string of |length| characters. Short strings are stored in
+ * the struct itself, longer ones on the heap. The struct doesn't point into
+ * itself, so it may be moved by copying (e.g. pushed into a vector).
+ */
 typedef struct string {
-	vector_i8_t buffer;
+	union {
+		/** Characters of a string that isn't |isLarge|. */
+		char small[STRING_SMALL_CAPACITY + 1];
+		struct {
+			char* chars;
+			/** Characters that fit, besides the null-terminator. */
+			size_t capacity;
+		} large;
+	} data;
+	size_t length;
+	bool isLarge;
 	bool initialized;
 } string_t;
 
@@ -18,19 +36,60 @@ bool string_from_c_str(string_t* string, const char* cStr);
 /** Destroys the string, freeing allocated memory. */
 void string_destroy(string_t* string);
 
+/**
+ * Destroys the string, handing its characters over to the caller.
+ *
+ * @return heap-allocated null-terminated characters, to be freed by the
+ *         caller; NULL if the string wasn't initialized or out of memory,
+ *         leaving the string intact.
+ */
+char* string_release(string_t* string);
+
 /** Returns whether the string was initialized
  * (null-terminated, can be used safely). */
 inline static bool string_created(string_t* string) {
 	return string->initialized;
 }
 
+/** Returns the null-terminated characters of the string. */
+inline static char* string_chars_(string_t* string) {
+	return string->isLarge ? string->data.large.chars : string->data.small;
+}
+
+/** Returns how many characters fit in the string without growing it. */
+inline static size_t string_capacity_(const string_t* string) {
+	return string->isLarge ? string->data.large.capacity
+	                       : STRING_SMALL_CAPACITY;
+}
+
+/**
+ * Grows the string to fit at least |capacity| characters, doubling its
+ * capacity. Moves short strings to the heap.
+ *
+ * @param string   input string
+ * @param capacity characters to fit, besides the null-terminator
+ */
+bool string_grow(string_t* string, size_t capacity);
+
 /**
  * Appends a character to the |input| string.
  *
  * @param string input string
  * @param c      character
  */
-bool string_append_char(string_t* string, char c);
+inline static bool string_append_char(string_t* string, char c) {
+	if (!string->initialized) return false;
+
+	if (string->length == string_capacity_(string) &&
+	    !string_grow(string, string->length + 1)) {
+		return false;
+	}
+
+	char* chars = string_chars_(string);
+	chars[string->length++] = c;
+	chars[string->length] = '\0';
+	return true;
+}
 
 /**
  * Appends a null-terminated string to the |input| string.
@@ -118,3 +177,63 @@ bool string_lstrip(string_t* string, const char* chars);
 /** Strips the string in-place of trailing whitespace characters,
  * specified in |chars|. */
 bool string_rstrip(string_t* string, const char* chars);
+
+/**
+ * Non-owning view of |length| characters, which aren't necessarily
+ * null-terminated. A view is valid as long as the characters it refers to.
+ */
+typedef struct strview {
+	const char* chars;
+	size_t length;
+} strview_t;
+
+/** Returns a view of a null-terminated string. */
+strview_t strview_from_c_str(const char* cStr);
+
+/** Returns a view of |string|, valid until the string is changed. */
+strview_t strview_from_string(string_t* string);
+
+/** Returns whether the views have the same characters. */
+bool strview_equals(strview_t a, strview_t b);
+
+/**
+ * Compares two views lexicographically.
+ *
+ * @return -1 if a < b;
+ * 			0 if a == b;
+ * 			1 if a > b.
+ */
+int strview_compare(strview_t a, strview_t b);
+
+/** Returns the 64-bit FNV-1a hash of the characters. */
+uint64_t strview_hash(strview_t view);
+
+/**
+ * Returns the index of the first occurrence of |needle| in |haystack|, or
+ * `SIZE_MAX` if there's none.
+ */
+size_t strview_find(strview_t haystack, strview_t needle);
+
+/**
+ * Splits |rest| at the first |sep|, like strsep: |token| is the part before
+ * it (possibly empty), and |rest| is the part after it. Without a |sep|, the
+ * whole of |rest| is the token and |rest| is exhausted.
+ *
+ * @return false if |rest| was exhausted already.
+ */
+bool strview_split(strview_t* rest, char sep, strview_t* token);
+
+/**
+ * Skips the characters of |delims| at the start of |rest|, then splits off
+ * the next token up to a delimiter, like strtok.
+ *
+ * @return false if there are no tokens left.
+ */
+bool strview_next_token(strview_t* rest, const char* delims,
+                        strview_t* token);
+
+/**
+ * Appends the characters of |view| to the string. The view may only refer to
+ * the string itself if it has room for them (see |string_grow|).
+ */
+bool string_append_view(string_t* string, strview_t view);
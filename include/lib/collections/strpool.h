@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "string.h"
+
+/** Characters of interned strings are stored in blocks of this many bytes. */
+extern const size_t STRPOOL_BLOCK_SIZE;
+
+typedef struct strpool_block {
+	/** Previously filled block. */
+	struct strpool_block* next;
+	/** Bytes used in |data|. */
+	size_t used;
+	/** Size of |data|, in bytes. */
+	size_t capacity;
+	char data[];
+} strpool_block_t;
+
+/**
+ * Intern pool: stores one copy of every distinct string and identifies it by
+ * a small id, the index it was interned at. Equal strings get the same id, so
+ * interned strings are compared by their ids instead of their characters.
+ *
+ * The characters are never moved, so views returned by the pool stay valid
+ * until it's destroyed.
+ */
+typedef struct strpool {
+	/** Interned strings, null-terminated, indexed by their id. */
+	strview_t* strings;
+	size_t size;
+	size_t capacity;
+	/** Open-addressing table of ids + 1; zero marks an empty slot. */
+	size_t* slots;
+	/** Number of slots, a power of two. */
+	size_t slotCount;
+	/** Block the characters are currently stored in. */
+	strpool_block_t* head;
+} strpool_t;
+
+/** Creates an empty pool. Memory is allocated on the first |strpool_intern|. */
+strpool_t strpool_create(void);
+
+/** Destroys the pool, invalidating the views of its strings. */
+void strpool_destroy(strpool_t* pool);
+
+/**
+ * Interns a string, copying it into the pool if it's not there yet.
+ *
+ * @param pool   intern pool
+ * @param string characters to intern
+ * @param id     id of the interned string
+ *
+ * @return false if out of memory.
+ */
+bool strpool_intern(strpool_t* pool, strview_t string, size_t* id);
+
+/**
+ * Looks up a string without interning it.
+ *
+ * @return false if the string wasn't interned.
+ */
+bool strpool_find(const strpool_t* pool, strview_t string, size_t* id);
+
+/**
+ * Returns the interned string with the |id|; its characters are
+ * null-terminated.
+ */
+strview_t strpool_get(const strpool_t* pool, size_t id);
+
+/** Returns the number of interned strings. */
+size_t strpool_size(const strpool_t* pool);
@@ -8,56 +8,128 @@
 
 extern const size_t VECTOR_MIN_CAPACITY;
 
+/** Built-in integer vectors of at least this many items are radix sorted. */
+extern const size_t VECTOR_RADIX_SORT_THRESHOLD;
+
 struct vector_utils {
 	int (*comp)(const void* p1, const void* p2);
 };
 
-#define DEFINE_VECTOR(VECTOR_T, TYPE_T, TYPE)                         \
-	typedef struct vector_##TYPE {                                    \
-		TYPE_T* buffer;                                               \
-		size_t size;                                                  \
-		size_t capacity;                                              \
-		struct vector_utils utils;                                    \
-	} VECTOR_T;                                                       \
-                                                                      \
-	VECTOR_T vector_##TYPE##_create(void);                            \
-                                                                      \
-	VECTOR_T vector_##TYPE##_create_with_capacity(size_t capacity);   \
-                                                                      \
-	void vector_##TYPE##_destroy(VECTOR_T*);                          \
-                                                                      \
-	bool vector_##TYPE##_ensure_capacity(VECTOR_T*, size_t capacity); \
-                                                                      \
-	bool vector_##TYPE##_push_back(VECTOR_T*, TYPE_T value);          \
-                                                                      \
-	bool vector_##TYPE##_pop_back(VECTOR_T*, TYPE_T* out);            \
-                                                                      \
-	bool vector_##TYPE##_insert(VECTOR_T*, size_t idx, TYPE_T value); \
-                                                                      \
-	TYPE_T* vector_##TYPE##_get(const VECTOR_T*, size_t i);           \
-                                                                      \
-	bool vector_##TYPE##_remove(VECTOR_T*, size_t i, TYPE_T* out);    \
-                                                                      \
-	bool vector_##TYPE##_remove_item(VECTOR_T*, TYPE_T value);        \
-                                                                      \
-	bool vector_##TYPE##_clear(VECTOR_T*);                            \
-                                                                      \
-	size_t vector_##TYPE##_index_of(const VECTOR_T*, TYPE_T value);   \
-                                                                      \
-	size_t vector_##TYPE##_size(const VECTOR_T*);                     \
-                                                                      \
-	bool vector_##TYPE##_is_empty(const VECTOR_T*);                   \
-                                                                      \
-	const TYPE_T* vector_##TYPE##_to_array(const VECTOR_T*);          \
-                                                                      \
-	bool vector_##TYPE##_sort(VECTOR_T*);                             \
-                                                                      \
+/** What |merge|, |union| and |intersect| of two sorted vectors keep. */
+typedef enum vector_set_op {
+	/** Every item of both vectors. */
+	VECTOR_SET_MERGE,
+	/** Items of either vector; common ones are kept once. */
+	VECTOR_SET_UNION,
+	/** Items of both vectors. */
+	VECTOR_SET_INTERSECT
+} vector_set_op_t;
+
+/**
+ * Growable array of |TYPE_T|. The buffer doubles when full and halves once
+ * it's a quarter full, so filling and draining is amortized O(1). |reserve|
+ * and |shrink_to_fit| set the capacity exactly; |clear| keeps it, and
+ * |ensure_capacity| grows it like a push does.
+ *
+ * |append_array| and |insert_range| copy |count| items with a single
+ * reallocation at most. The items may only point into the vector if it
+ * already has room for them and they're before the insertion point.
+ * |remove_range| removes items [|from|; |from| + |count|).
+ *
+ * The sorted operations expect the items ordered by |utils.comp|, and fail
+ * without a comparator. |lower_bound| and |upper_bound| return the index of
+ * the first item that isn't less than |value| or is greater than it, and
+ * |binary_search| the index of an equal item or `SIZE_MAX`. |sorted_insert|
+ * inserts after the equal items. |merge|, |union| and |intersect| create a
+ * sorted |out|; an item that's repeated is kept as many times as it occurs
+ * in both vectors, in either of them or in both of them respectively.
+ */
+#define DEFINE_VECTOR(VECTOR_T, TYPE_T, TYPE)                                \
+	typedef struct vector_##TYPE {                                           \
+		TYPE_T* buffer;                                                      \
+		size_t size;                                                         \
+		size_t capacity;                                                     \
+		struct vector_utils utils;                                           \
+	} VECTOR_T;                                                              \
+                                                                             \
+	VECTOR_T vector_##TYPE##_create(void);                                   \
+                                                                             \
+	VECTOR_T vector_##TYPE##_create_with_capacity(size_t capacity);          \
+                                                                             \
+	void vector_##TYPE##_destroy(VECTOR_T*);                                 \
+                                                                             \
+	bool vector_##TYPE##_ensure_capacity(VECTOR_T*, size_t capacity);        \
+                                                                             \
+	bool vector_##TYPE##_reserve(VECTOR_T*, size_t capacity);                \
+                                                                             \
+	bool vector_##TYPE##_shrink_to_fit(VECTOR_T*);                           \
+                                                                             \
+	bool vector_##TYPE##_push_back(VECTOR_T*, TYPE_T value);                 \
+                                                                             \
+	bool vector_##TYPE##_pop_back(VECTOR_T*, TYPE_T* out);                   \
+                                                                             \
+	bool vector_##TYPE##_insert(VECTOR_T*, size_t idx, TYPE_T value);        \
+                                                                             \
+	bool vector_##TYPE##_append_array(VECTOR_T*, const TYPE_T* items,        \
+	                                  size_t count);                         \
+                                                                             \
+	bool vector_##TYPE##_insert_range(VECTOR_T*, size_t idx,                 \
+	                                  const TYPE_T* items, size_t count);    \
+                                                                             \
+	TYPE_T* vector_##TYPE##_get(const VECTOR_T*, size_t i);                  \
+                                                                             \
+	bool vector_##TYPE##_remove(VECTOR_T*, size_t i, TYPE_T* out);           \
+                                                                             \
+	bool vector_##TYPE##_remove_range(VECTOR_T*, size_t from, size_t count); \
+                                                                             \
+	bool vector_##TYPE##_remove_item(VECTOR_T*, TYPE_T value);               \
+                                                                             \
+	bool vector_##TYPE##_clear(VECTOR_T*);                                   \
+                                                                             \
+	size_t vector_##TYPE##_index_of(const VECTOR_T*, TYPE_T value);          \
+                                                                             \
+	size_t vector_##TYPE##_lower_bound(const VECTOR_T*, TYPE_T value);       \
+                                                                             \
+	size_t vector_##TYPE##_upper_bound(const VECTOR_T*, TYPE_T value);       \
+                                                                             \
+	size_t vector_##TYPE##_binary_search(const VECTOR_T*, TYPE_T value);     \
+                                                                             \
+	bool vector_##TYPE##_sorted_insert(VECTOR_T*, TYPE_T value);             \
+                                                                             \
+	bool vector_##TYPE##_merge(const VECTOR_T* a, const VECTOR_T* b,         \
+	                           VECTOR_T* out);                               \
+                                                                             \
+	bool vector_##TYPE##_union(const VECTOR_T* a, const VECTOR_T* b,         \
+	                           VECTOR_T* out);                               \
+                                                                             \
+	bool vector_##TYPE##_intersect(const VECTOR_T* a, const VECTOR_T* b,     \
+	                               VECTOR_T* out);                           \
+                                                                             \
+	size_t vector_##TYPE##_size(const VECTOR_T*);                            \
+                                                                             \
+	bool vector_##TYPE##_is_empty(const VECTOR_T*);                          \
+                                                                             \
+	const TYPE_T* vector_##TYPE##_to_array(const VECTOR_T*);                 \
+                                                                             \
+	bool vector_##TYPE##_sort(VECTOR_T*);                                    \
+                                                                             \
 	bool vector_##TYPE##_dup(const VECTOR_T* src, VECTOR_T* dst);
 
-#define IMPL_VECTOR(VECTOR_T, TYPE_T, TYPE, UTILS)                             \
+/**
+ * Implements the functions of |DEFINE_VECTOR| except for `sort`, which is
+ * left to |IMPL_VECTOR| or |IMPL_VECTOR_WITH_SORT|.
+ */
+#define IMPL_VECTOR_COMMON(VECTOR_T, TYPE_T, TYPE, UTILS)                      \
 	bool vector_##TYPE##_resize(VECTOR_T* v, size_t capacity) {                \
 		if (!v) return false;                                                  \
                                                                                \
+		if (capacity == 0) {                                                   \
+			free(v->buffer);                                                   \
+			v->buffer = NULL;                                                  \
+			v->capacity = 0;                                                   \
+			return true;                                                       \
+		}                                                                      \
+                                                                               \
 		TYPE_T* newBuffer =                                                    \
 		    (TYPE_T*)realloc(v->buffer, capacity * sizeof(TYPE_T));            \
 		if (newBuffer == NULL) return false;                                   \
@@ -67,27 +139,45 @@ struct vector_utils {
 		return true;                                                           \
 	}                                                                          \
                                                                                \
+	/* Grows |v| to at least |capacity| items, doubling the buffer. */         \
+	static bool vector_##TYPE##_grow(VECTOR_T* v, size_t capacity) {           \
+		size_t grown = v->capacity * 2;                                        \
+		if (grown < VECTOR_MIN_CAPACITY) grown = VECTOR_MIN_CAPACITY;          \
+		if (grown < capacity) grown = capacity;                                \
+                                                                               \
+		return vector_##TYPE##_resize(v, grown);                               \
+	}                                                                          \
+                                                                               \
+	/* Halves the buffer while it's a quarter full, so it's half full after */ \
+	/* that and pushes and pops around a boundary don't reallocate every */    \
+	/* time. A failed shrink keeps the larger buffer. */                       \
+	static void vector_##TYPE##_shrink(VECTOR_T* v) {                          \
+		size_t capacity = v->capacity;                                         \
+		while (capacity / 2 >= VECTOR_MIN_CAPACITY && v->size <= capacity / 4) \
+			capacity /= 2;                                                     \
+                                                                               \
+		if (capacity != v->capacity) vector_##TYPE##_resize(v, capacity);      \
+	}                                                                          \
+                                                                               \
 	bool vector_##TYPE##_shrink_one(VECTOR_T* v) {                             \
 		if (!v) return false;                                                  \
                                                                                \
-		if ((v->size - 1) > VECTOR_MIN_CAPACITY &&                             \
-		    (v->size - 1) <= v->capacity * 4 / 9) {                            \
-			bool resized = vector_##TYPE##_resize(v, v->capacity * 2 / 3);     \
-			if (!resized) return false;                                        \
-		}                                                                      \
-                                                                               \
 		v->size--;                                                             \
+		vector_##TYPE##_shrink(v);                                             \
 		return true;                                                           \
 	}                                                                          \
                                                                                \
 	VECTOR_T vector_##TYPE##_create(void) {                                    \
-		return vector_##TYPE##_create_with_capacity(VECTOR_MIN_CAPACITY);      \
+		/* allocate later, when a push occurs */                               \
+		VECTOR_T v = {                                                         \
+		    .buffer = NULL, .size = 0, .capacity = 0, .utils = UTILS};         \
+		return v;                                                              \
 	}                                                                          \
                                                                                \
 	VECTOR_T vector_##TYPE##_create_with_capacity(size_t capacity) {           \
-		/* allocate later, when a push occurs */                               \
-		VECTOR_T v = {                                                         \
-		    .buffer = NULL, .size = 0, .capacity = capacity, .utils = UTILS};  \
+		VECTOR_T v = vector_##TYPE##_create();                                 \
+		/* If this fails, the first push allocates the buffer instead. */      \
+		vector_##TYPE##_reserve(&v, capacity);                                 \
 		return v;                                                              \
 	}                                                                          \
                                                                                \
@@ -105,28 +195,29 @@ struct vector_utils {
 			return false;                                                      \
 		else if (v->capacity >= capacity)                                      \
 			return true;                                                       \
-		return vector_##TYPE##_resize(v, capacity);                            \
+		return vector_##TYPE##_grow(v, capacity);                              \
 	}                                                                          \
                                                                                \
-	static bool vector_##TYPE##_init(VECTOR_T* v) {                            \
-		/* if the vec is not initialized, allocate the buffer */               \
-		if (v->buffer == NULL) {                                               \
-			if (v->capacity == 0) return false;                                \
+	bool vector_##TYPE##_reserve(VECTOR_T* v, size_t capacity) {               \
+		if (!v)                                                                \
+			return false;                                                      \
+		else if (v->capacity >= capacity)                                      \
+			return true;                                                       \
+		return vector_##TYPE##_resize(v, capacity);                            \
+	}                                                                          \
                                                                                \
-			v->buffer = (TYPE_T*)calloc(v->capacity, sizeof(TYPE_T));          \
-			if (v->buffer == NULL) return false; /* allocation failed */       \
-		}                                                                      \
+	bool vector_##TYPE##_shrink_to_fit(VECTOR_T* v) {                          \
+		if (!v) return false;                                                  \
+		if (v->capacity == v->size) return true;                               \
                                                                                \
-		return true;                                                           \
+		return vector_##TYPE##_resize(v, v->size);                             \
 	}                                                                          \
                                                                                \
 	bool vector_##TYPE##_push_back(VECTOR_T* v, TYPE_T value) {                \
-		if (!v || !vector_##TYPE##_init(v)) return false;                      \
+		if (!v) return false;                                                  \
                                                                                \
-		if (v->size == v->capacity) {                                          \
-			bool resized =                                                     \
-			    vector_##TYPE##_ensure_capacity(v, v->capacity * 3 / 2);       \
-			if (!resized) return false;                                        \
+		if (v->size == v->capacity && !vector_##TYPE##_grow(v, v->size + 1)) { \
+			return false;                                                      \
 		}                                                                      \
                                                                                \
 		v->buffer[v->size++] = value;                                          \
@@ -136,22 +227,15 @@ struct vector_utils {
 	bool vector_##TYPE##_pop_back(VECTOR_T* v, TYPE_T* out) {                  \
 		if (!v || !out || v->size == 0) return false;                          \
                                                                                \
-		TYPE_T value = v->buffer[v->size - 1];                                 \
-		if (!vector_##TYPE##_shrink_one(v)) return false;                      \
-                                                                               \
-		*out = value;                                                          \
-		return true;                                                           \
+		*out = v->buffer[v->size - 1];                                         \
+		return vector_##TYPE##_shrink_one(v);                                  \
 	}                                                                          \
                                                                                \
 	bool vector_##TYPE##_insert(VECTOR_T* v, size_t idx, TYPE_T value) {       \
-		if (!v || idx > v->size || !vector_##TYPE##_init(v)) {                 \
-			return false;                                                      \
-		}                                                                      \
+		if (!v || idx > v->size) return false;                                 \
                                                                                \
-		if (v->size == v->capacity) {                                          \
-			bool resized =                                                     \
-			    vector_##TYPE##_ensure_capacity(v, v->capacity * 3 / 2);       \
-			if (!resized) return false;                                        \
+		if (v->size == v->capacity && !vector_##TYPE##_grow(v, v->size + 1)) { \
+			return false;                                                      \
 		}                                                                      \
                                                                                \
 		/* Shift elements in |v->buffer| by one to fit the inserted value: */  \
@@ -165,6 +249,30 @@ struct vector_utils {
 		return true;                                                           \
 	}                                                                          \
                                                                                \
+	bool vector_##TYPE##_append_array(VECTOR_T* v, const TYPE_T* items,        \
+	                                  size_t count) {                          \
+		if (!v) return false;                                                  \
+		return vector_##TYPE##_insert_range(v, v->size, items, count);         \
+	}                                                                          \
+                                                                               \
+	bool vector_##TYPE##_insert_range(VECTOR_T* v, size_t idx,                 \
+	                                  const TYPE_T* items, size_t count) {     \
+		if (!v || idx > v->size || (count && !items)) return false;            \
+		if (count == 0) return true;                                           \
+                                                                               \
+		if (count > SIZE_MAX / sizeof(TYPE_T) - v->size ||                     \
+		    !vector_##TYPE##_ensure_capacity(v, v->size + count)) {            \
+			return false;                                                      \
+		}                                                                      \
+                                                                               \
+		memmove(v->buffer + idx + count, v->buffer + idx,                      \
+		        (v->size - idx) * sizeof(TYPE_T));                             \
+		memcpy(v->buffer + idx, items, count * sizeof(TYPE_T));                \
+		v->size += count;                                                      \
+                                                                               \
+		return true;                                                           \
+	}                                                                          \
+                                                                               \
 	TYPE_T* vector_##TYPE##_get(const VECTOR_T* v, size_t i) {                 \
 		if (!v || i >= v->size) return NULL;                                   \
 		return &v->buffer[i];                                                  \
@@ -178,8 +286,19 @@ struct vector_utils {
                                                                                \
 		memmove(v->buffer + i, v->buffer + i + 1,                              \
 		        (v->size - i - 1) * sizeof(TYPE_T));                           \
-		if (!vector_##TYPE##_shrink_one(v)) return false;                      \
+		return vector_##TYPE##_shrink_one(v);                                  \
+	}                                                                          \
+                                                                               \
+	bool vector_##TYPE##_remove_range(VECTOR_T* v, size_t from,                \
+	                                  size_t count) {                          \
+		if (!v || from > v->size || count > v->size - from) return false;      \
+		if (count == 0) return true;                                           \
+                                                                               \
+		memmove(v->buffer + from, v->buffer + from + count,                    \
+		        (v->size - from - count) * sizeof(TYPE_T));                    \
+		v->size -= count;                                                      \
                                                                                \
+		vector_##TYPE##_shrink(v);                                             \
 		return true;                                                           \
 	}                                                                          \
                                                                                \
@@ -190,8 +309,9 @@ struct vector_utils {
 	}                                                                          \
                                                                                \
 	bool vector_##TYPE##_clear(VECTOR_T* v) {                                  \
-		if (!v || !vector_##TYPE##_resize(v, 4)) return false;                 \
+		if (!v) return false;                                                  \
                                                                                \
+		/* Keep the buffer for the next fill, see |shrink_to_fit|. */          \
 		v->size = 0;                                                           \
 		return true;                                                           \
 	}                                                                          \
@@ -207,6 +327,114 @@ struct vector_utils {
 		return SIZE_MAX;                                                       \
 	}                                                                          \
                                                                                \
+	/* Index of the first item greater than |value| if |upper|, or of the */   \
+	/* first one that isn't less than it otherwise. */                         \
+	static size_t vector_##TYPE##_bound(const VECTOR_T* v,                     \
+	                                    TYPE_T const* value, bool upper) {     \
+		if (!v || v->utils.comp == NULL) return SIZE_MAX;                      \
+                                                                               \
+		size_t lo = 0, n = v->size;                                            \
+		while (n > 0) {                                                        \
+			size_t half = n / 2;                                               \
+			int order = v->utils.comp(&v->buffer[lo + half], value);           \
+                                                                               \
+			if (order < 0 || (upper && order == 0)) {                          \
+				lo += half + 1;                                                \
+				n -= half + 1;                                                 \
+			} else {                                                           \
+				n = half;                                                      \
+			}                                                                  \
+		}                                                                      \
+                                                                               \
+		return lo;                                                             \
+	}                                                                          \
+                                                                               \
+	size_t vector_##TYPE##_lower_bound(const VECTOR_T* v, TYPE_T value) {      \
+		return vector_##TYPE##_bound(v, &value, false);                        \
+	}                                                                          \
+                                                                               \
+	size_t vector_##TYPE##_upper_bound(const VECTOR_T* v, TYPE_T value) {      \
+		return vector_##TYPE##_bound(v, &value, true);                         \
+	}                                                                          \
+                                                                               \
+	size_t vector_##TYPE##_binary_search(const VECTOR_T* v, TYPE_T value) {    \
+		size_t i = vector_##TYPE##_bound(v, &value, false);                    \
+		if (i == SIZE_MAX || i == v->size) return SIZE_MAX;                    \
+                                                                               \
+		return v->utils.comp(&v->buffer[i], &value) == 0 ? i : SIZE_MAX;       \
+	}                                                                          \
+                                                                               \
+	bool vector_##TYPE##_sorted_insert(VECTOR_T* v, TYPE_T value) {            \
+		/* After the equal items, so that they keep the insertion order. */    \
+		size_t i = vector_##TYPE##_bound(v, &value, true);                     \
+		if (i == SIZE_MAX) return false;                                       \
+                                                                               \
+		return vector_##TYPE##_insert(v, i, value);                            \
+	}                                                                          \
+                                                                               \
+	/* Writes the items of sorted |a| and |b| to a new |out| in one pass. */   \
+	static bool vector_##TYPE##_combine(const VECTOR_T* a, const VECTOR_T* b,  \
+	                                    VECTOR_T* out, vector_set_op_t op) {   \
+		if (!a || !b || !out || a->utils.comp == NULL) return false;           \
+                                                                               \
+		size_t capacity = a->size + b->size;                                   \
+		if (op == VECTOR_SET_INTERSECT) {                                      \
+			capacity = a->size < b->size ? a->size : b->size;                  \
+		}                                                                      \
+                                                                               \
+		*out = vector_##TYPE##_create();                                       \
+		if (!vector_##TYPE##_reserve(out, capacity)) return false;             \
+                                                                               \
+		/* Whether to keep the items that are only in one of the vectors. */   \
+		bool keepOne = op != VECTOR_SET_INTERSECT;                             \
+                                                                               \
+		size_t i = 0, j = 0, k = 0;                                            \
+		while (i != a->size && j != b->size) {                                 \
+			int order = a->utils.comp(&a->buffer[i], &b->buffer[j]);           \
+                                                                               \
+			if (order < 0 || (order == 0 && op == VECTOR_SET_MERGE)) {         \
+				if (keepOne) out->buffer[k++] = a->buffer[i];                  \
+				++i;                                                           \
+			} else if (order > 0) {                                            \
+				if (keepOne) out->buffer[k++] = b->buffer[j];                  \
+				++j;                                                           \
+			} else {                                                           \
+				out->buffer[k++] = a->buffer[i++];                             \
+				++j;                                                           \
+			}                                                                  \
+		}                                                                      \
+                                                                               \
+		if (keepOne) {                                                         \
+			/* At most one of the vectors has items left. */                   \
+			const VECTOR_T* rest = i != a->size ? a : b;                       \
+			size_t from = i != a->size ? i : j;                                \
+                                                                               \
+			if (from != rest->size) {                                          \
+				memcpy(out->buffer + k, rest->buffer + from,                   \
+				       (rest->size - from) * sizeof(TYPE_T));                  \
+				k += rest->size - from;                                        \
+			}                                                                  \
+		}                                                                      \
+                                                                               \
+		out->size = k;                                                         \
+		return true;                                                           \
+	}                                                                          \
+                                                                               \
+	bool vector_##TYPE##_merge(const VECTOR_T* a, const VECTOR_T* b,           \
+	                           VECTOR_T* out) {                                \
+		return vector_##TYPE##_combine(a, b, out, VECTOR_SET_MERGE);           \
+	}                                                                          \
+                                                                               \
+	bool vector_##TYPE##_union(const VECTOR_T* a, const VECTOR_T* b,           \
+	                           VECTOR_T* out) {                                \
+		return vector_##TYPE##_combine(a, b, out, VECTOR_SET_UNION);           \
+	}                                                                          \
+                                                                               \
+	bool vector_##TYPE##_intersect(const VECTOR_T* a, const VECTOR_T* b,       \
+	                               VECTOR_T* out) {                            \
+		return vector_##TYPE##_combine(a, b, out, VECTOR_SET_INTERSECT);       \
+	}                                                                          \
+                                                                               \
 	size_t vector_##TYPE##_size(const vector_##TYPE##_t* v) {                  \
 		return v->size;                                                        \
 	}                                                                          \
@@ -219,28 +447,161 @@ struct vector_utils {
 		return (const TYPE_T*)v->buffer;                                       \
 	}                                                                          \
                                                                                \
-	bool vector_##TYPE##_sort(vector_##TYPE##_t* v) {                          \
-		if (!v || !v->utils.comp) return false;                                \
-                                                                               \
-		qsort(v->buffer, v->size, sizeof(TYPE_T), v->utils.comp);              \
-                                                                               \
-		return true;                                                           \
-	}                                                                          \
-                                                                               \
 	bool vector_##TYPE##_dup(const VECTOR_T* src, VECTOR_T* dst) {             \
 		if (!src || !dst) return false;                                        \
                                                                                \
 		*dst = vector_##TYPE##_create();                                       \
-		if (!vector_##TYPE##_ensure_capacity(dst, src->capacity)) {            \
-			return false;                                                      \
-		}                                                                      \
+		if (!vector_##TYPE##_reserve(dst, src->size)) return false;            \
                                                                                \
-		memcpy(dst->buffer, src->buffer, src->size * sizeof(TYPE_T));          \
+		if (src->size) {                                                       \
+			memcpy(dst->buffer, src->buffer, src->size * sizeof(TYPE_T));      \
+		}                                                                      \
 		dst->size = src->size;                                                 \
                                                                                \
 		return true;                                                           \
 	}
 
+/** Implements |DEFINE_VECTOR|; `sort` calls qsort with |UTILS.comp|. */
+#define IMPL_VECTOR(VECTOR_T, TYPE_T, TYPE, UTILS)                \
+	IMPL_VECTOR_COMMON(VECTOR_T, TYPE_T, TYPE, UTILS)             \
+                                                                  \
+	bool vector_##TYPE##_sort(VECTOR_T* v) {                      \
+		if (!v || !v->utils.comp) return false;                   \
+                                                                  \
+		qsort(v->buffer, v->size, sizeof(TYPE_T), v->utils.comp); \
+                                                                  \
+		return true;                                              \
+	}
+
+/** Arrays of at most this many items are sorted by insertion. */
+#define VECTOR_SORT_INSERTION_MAX 16
+
+/**
+ * Defines `static inline void NAME(TYPE_T* items, size_t n)`: an introsort of
+ * |items| with the comparison inlined. |LESS| is an expression telling
+ * whether `*a` goes before `*b`, where `a` and `b` are `TYPE_T const*`, e.g.
+ * `*a < *b`. Like qsort, the sort isn't stable.
+ */
+#define IMPL_VECTOR_SORT(TYPE_T, NAME, LESS)                                 \
+	static inline bool NAME##_less_(TYPE_T const* a, TYPE_T const* b) {      \
+		return (LESS);                                                       \
+	}                                                                        \
+                                                                             \
+	static inline void NAME##_swap_(TYPE_T* a, TYPE_T* b) {                  \
+		TYPE_T temp = *a;                                                    \
+		*a = *b;                                                             \
+		*b = temp;                                                           \
+	}                                                                        \
+                                                                             \
+	static inline void NAME##_insertion_(TYPE_T* items, size_t n) {          \
+		for (size_t i = 1; i < n; ++i) {                                     \
+			TYPE_T value = items[i];                                         \
+			size_t j = i;                                                    \
+                                                                             \
+			while (j > 0 && NAME##_less_(&value, &items[j - 1])) {           \
+				items[j] = items[j - 1];                                     \
+				--j;                                                         \
+			}                                                                \
+                                                                             \
+			items[j] = value;                                                \
+		}                                                                    \
+	}                                                                        \
+                                                                             \
+	static inline void NAME##_sift_down_(TYPE_T* items, size_t root,         \
+	                                     size_t n) {                         \
+		for (size_t child; (child = 2 * root + 1) < n; root = child) {       \
+			TYPE_T* next = &items[child + 1];                                \
+			if (child + 1 < n && NAME##_less_(&items[child], next)) ++child; \
+			if (!NAME##_less_(&items[root], &items[child])) return;          \
+                                                                             \
+			NAME##_swap_(&items[root], &items[child]);                       \
+		}                                                                    \
+	}                                                                        \
+                                                                             \
+	static inline void NAME##_heapsort_(TYPE_T* items, size_t n) {           \
+		for (size_t i = n / 2; i-- > 0;) NAME##_sift_down_(items, i, n);     \
+                                                                             \
+		for (size_t i = n; i-- > 1;) {                                       \
+			NAME##_swap_(&items[0], &items[i]);                              \
+			NAME##_sift_down_(items, 0, i);                                  \
+		}                                                                    \
+	}                                                                        \
+                                                                             \
+	/* Moves the median of the first, middle and last items to the front. */ \
+	static inline void NAME##_median_(TYPE_T* items, size_t n) {             \
+		TYPE_T* lo = &items[0];                                              \
+		TYPE_T* mid = &items[n / 2];                                         \
+		TYPE_T* hi = &items[n - 1];                                          \
+                                                                             \
+		if (NAME##_less_(mid, lo)) NAME##_swap_(mid, lo);                    \
+		if (NAME##_less_(hi, mid)) {                                         \
+			NAME##_swap_(hi, mid);                                           \
+			if (NAME##_less_(mid, lo)) NAME##_swap_(mid, lo);                \
+		}                                                                    \
+                                                                             \
+		NAME##_swap_(lo, mid);                                               \
+	}                                                                        \
+                                                                             \
+	static inline void NAME##_introsort_(TYPE_T* items, size_t n,            \
+	                                     size_t depth) {                     \
+		while (n > VECTOR_SORT_INSERTION_MAX) {                              \
+			if (depth-- == 0) {                                              \
+				NAME##_heapsort_(items, n);                                  \
+				return;                                                      \
+			}                                                                \
+                                                                             \
+			/* Hoare partition around |items[0]|; the bounds checks keep */  \
+			/* an inconsistent |LESS| (e.g. with NaNs) inside the array. */  \
+			NAME##_median_(items, n);                                        \
+                                                                             \
+			size_t i = 0, j = n;                                             \
+			for (;;) {                                                       \
+				while (++i < n && NAME##_less_(&items[i], items)) continue;  \
+				while (--j > 0 && NAME##_less_(items, &items[j])) continue;  \
+                                                                             \
+				if (i >= j) break;                                           \
+				NAME##_swap_(&items[i], &items[j]);                          \
+			}                                                                \
+                                                                             \
+			NAME##_swap_(&items[0], &items[j]);                              \
+                                                                             \
+			/* Recurse into the smaller part to bound the stack depth. */    \
+			if (j < n - j - 1) {                                             \
+				NAME##_introsort_(items, j, depth);                          \
+				items += j + 1;                                              \
+				n -= j + 1;                                                  \
+			} else {                                                         \
+				NAME##_introsort_(items + j + 1, n - j - 1, depth);          \
+				n = j;                                                       \
+			}                                                                \
+		}                                                                    \
+                                                                             \
+		NAME##_insertion_(items, n);                                         \
+	}                                                                        \
+                                                                             \
+	static inline void NAME(TYPE_T* items, size_t n) {                       \
+		size_t depth = 0;                                                    \
+		for (size_t m = n; m > 1; m >>= 1) depth += 2;                       \
+                                                                             \
+		NAME##_introsort_(items, n, depth);                                  \
+	}
+
+/**
+ * Implements |DEFINE_VECTOR| with `sort` specialized by |LESS| (see
+ * |IMPL_VECTOR_SORT|) instead of calling qsort with |UTILS.comp|.
+ */
+#define IMPL_VECTOR_WITH_SORT(VECTOR_T, TYPE_T, TYPE, UTILS, LESS) \
+	IMPL_VECTOR_COMMON(VECTOR_T, TYPE_T, TYPE, UTILS)              \
+	IMPL_VECTOR_SORT(TYPE_T, vector_##TYPE##_sort_items, LESS)     \
+                                                                   \
+	bool vector_##TYPE##_sort(VECTOR_T* v) {                       \
+		if (!v) return false;                                      \
+                                                                   \
+		vector_##TYPE##_sort_items(v->buffer, v->size);            \
+                                                                   \
+		return true;                                               \
+	}
+
 DEFINE_VECTOR(vector_i8_t, int8_t, i8)
 DEFINE_VECTOR(vector_i16_t, int16_t, i16)
 DEFINE_VECTOR(vector_i32_t, int32_t, i32)
@@ -252,3 +613,19 @@ DEFINE_VECTOR(vector_u64_t, uint64_t, u64)
 DEFINE_VECTOR(vector_flt_t, float, flt)
 DEFINE_VECTOR(vector_dbl_t, double, dbl)
 DEFINE_VECTOR(vector_ptr_t, void*, ptr)
+
+/**
+ * Sorts |n| |items| with an LSD radix sort over bytes, skipping passes where
+ * all items share a byte. Built-in integer vectors use it for `sort` from
+ * |VECTOR_RADIX_SORT_THRESHOLD| items on.
+ *
+ * @return false if the scratch buffer couldn't be allocated.
+ */
+bool vector_i8_radix_sort(int8_t* items, size_t n, bool descending);
+bool vector_i16_radix_sort(int16_t* items, size_t n, bool descending);
+bool vector_i32_radix_sort(int32_t* items, size_t n, bool descending);
+bool vector_i64_radix_sort(int64_t* items, size_t n, bool descending);
+bool vector_u8_radix_sort(uint8_t* items, size_t n, bool descending);
+bool vector_u16_radix_sort(uint16_t* items, size_t n, bool descending);
+bool vector_u32_radix_sort(uint32_t* items, size_t n, bool descending);
+bool vector_u64_radix_sort(uint64_t* items, size_t n, bool descending);
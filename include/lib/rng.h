@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Pseudo-random generators shared by the labs: SplitMix64, which also seeds,
+ * and xoshiro256**. Neither is suitable for cryptography.
+ */
+
+/** xoshiro256** generator state. */
+typedef struct rng {
+	uint64_t s[4];
+} rng_t;
+
+static inline uint64_t rng_mix64(uint64_t z) {
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+/** Advances the SplitMix64 |state| and returns the next value. */
+static inline uint64_t rng_splitmix64(uint64_t* state) {
+	return rng_mix64(*state += 0x9E3779B97F4A7C15ull);
+}
+
+/**
+ * Item |idx| of the SplitMix64 stream starting at |key|, same as the
+ * (|idx| + 1)-th |rng_splitmix64| call. Items don't depend on each other, so
+ * a stream can be generated in blocks and split between threads.
+ */
+static inline uint64_t rng_at(uint64_t key, uint64_t idx) {
+	return rng_mix64(key + (idx + 1) * 0x9E3779B97F4A7C15ull);
+}
+
+/** Seeds a xoshiro256** generator from the SplitMix64 stream of |seed|. */
+static inline rng_t rng_create(uint64_t seed) {
+	rng_t rng;
+	for (size_t i = 0; i != 4; ++i) rng.s[i] = rng_splitmix64(&seed);
+	return rng;
+}
+
+static inline uint64_t rng_rotl(uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+/** Returns the next xoshiro256** value. */
+static inline uint64_t rng_next(rng_t* rng) {
+	uint64_t* s = rng->s;
+	uint64_t result = rng_rotl(s[1] * 5, 7) * 9;
+	uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rng_rotl(s[3], 45);
+
+	return result;
+}
+
+/**
+ * Returns a uniformly distributed integer in [0; n), without modulo bias
+ * (Lemire's multiply-and-reject).
+ */
+static inline uint64_t rng_below(rng_t* rng, uint64_t n) {
+#ifdef __SIZEOF_INT128__
+	__extension__ typedef unsigned __int128 u128_t;
+
+	u128_t m = (u128_t)rng_next(rng) * n;
+	uint64_t low = (uint64_t)m;
+
+	if (low < n) {
+		uint64_t threshold = -n % n;
+		while (low < threshold) {
+			m = (u128_t)rng_next(rng) * n;
+			low = (uint64_t)m;
+		}
+	}
+
+	return (uint64_t)(m >> 64);
+#else
+	uint64_t threshold = -n % n;
+	uint64_t value;
+	do {
+		value = rng_next(rng);
+	} while (value < threshold);
+	return value % n;
+#endif
+}
+
+/**
+ * Maps a random |x| to [0; n), or returns it as is if |n| is 0 (the whole
+ * range). Unlike |rng_below|, never rejects, so the result is biased by at
+ * most n / 2^64.
+ */
+static inline uint64_t rng_scale(uint64_t x, uint64_t n) {
+	if (!n) return x;
+#ifdef __SIZEOF_INT128__
+	__extension__ typedef unsigned __int128 u128_t;
+
+	return (uint64_t)(((u128_t)x * n) >> 64);
+#else
+	uint64_t xl = x & 0xFFFFFFFF, xh = x >> 32;
+	uint64_t nl = n & 0xFFFFFFFF, nh = n >> 32;
+
+	uint64_t ll = xl * nl, lh = xl * nh, hl = xh * nl;
+	uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+	return xh * nh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+/**
+ * Advances |rng| by 2^128 steps, equivalent to as many |rng_next| calls.
+ * Jumping copies of one generator yields non-overlapping streams.
+ */
+static inline void rng_jump(rng_t* rng) {
+	static const uint64_t JUMP[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+	                                0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+
+	uint64_t s[4] = {0, 0, 0, 0};
+
+	for (size_t i = 0; i != 4; ++i) {
+		for (int b = 0; b != 64; ++b) {
+			if (JUMP[i] & (1ull << b)) {
+				for (size_t j = 0; j != 4; ++j) s[j] ^= rng->s[j];
+			}
+			rng_next(rng);
+		}
+	}
+
+	for (size_t j = 0; j != 4; ++j) rng->s[j] = s[j];
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * Vectorized string primitives. They work on explicit lengths rather than on
+ * null-terminators, treat characters as unsigned bytes and only fold the case
+ * of ASCII letters. Each call uses the widest instruction set the CPU
+ * supports, see |strsimd_level|.
+ */
+
+typedef enum strsimd_level {
+	/** Portable code, a character at a time. */
+	STRSIMD_SCALAR,
+	/** 16 characters at a time; always available on x86-64. */
+	STRSIMD_SSE2,
+	/** 32 characters at a time. */
+	STRSIMD_AVX2
+} strsimd_level_t;
+
+/** Sets with more characters than this are searched for without SIMD. */
+#define STRSIMD_SET_MAX 16
+
+/** Returns the instruction set the primitives use. */
+strsimd_level_t strsimd_level(void);
+
+/**
+ * Limits the instruction set the primitives use to |level|, e.g. to compare
+ * the implementations. Not thread-safe: call it before starting threads.
+ */
+void strsimd_limit(strsimd_level_t level);
+
+/** Returns the index of the first character of |s| in |set|, or |n|. */
+size_t strsimd_find_set(const char* s, size_t n, const char* set);
+
+/** Returns the index of the first character of |s| not in |set|, or |n|. */
+size_t strsimd_find_not_set(const char* s, size_t n, const char* set);
+
+/** Returns the index of the last character of |s| not in |set|, or |n|. */
+size_t strsimd_rfind_not_set(const char* s, size_t n, const char* set);
+
+/** Returns the first index where |a| and |b| differ, or |n|. */
+size_t strsimd_mismatch(const char* a, const char* b, size_t n);
+
+/**
+ * Compares |n| characters of |a| and |b|, ignoring the case of ASCII letters.
+ *
+ * @return -1 if a < b;
+ * 			0 if a == b;
+ * 			1 if a > b.
+ */
+int strsimd_casecmp(const char* a, const char* b, size_t n);
+
+/** Lowercases ASCII letters of |src| into |dst|, which may be |src|. */
+void strsimd_lower(char* dst, const char* src, size_t n);
+
+/**
+ * Returns the index of the first occurrence of |needle| (of |m| characters)
+ * in |haystack| (of |n| characters), or |n| if there's none.
+ */
+size_t strsimd_find(const char* haystack, size_t n, const char* needle,
+                    size_t m);
@@ -19,36 +19,20 @@ error_t random_vec(vector_i64_t* vec) {
 }
 
 int64_t find_closest(int64_t value, vector_i64_t* others) {
-	size_t l = 0;
-	size_t r = vector_i64_size(others) - 1;
-
-	if (value < *vector_i64_get(others, l)) {
-		return *vector_i64_get(others, l);
-	} else if (value > *vector_i64_get(others, r)) {
-		return *vector_i64_get(others, r);
+	size_t size = vector_i64_size(others);
+	// The first item that isn't less than |value|; the closest one is either
+	// this item or the one before it.
+	size_t i = vector_i64_lower_bound(others, value);
+
+	if (i == 0) {
+		return *vector_i64_get(others, 0);
+	} else if (i == size) {
+		return *vector_i64_get(others, size - 1);
 	}
 
-	while (l <= r) {
-		size_t mid = (l + r) / 2;
-		int64_t midValue = *vector_i64_get(others, mid);
-
-		if (value < midValue) {
-			if (r == 0) break;
-			r = mid - 1;
-		} else if (value > midValue) {
-			l = mid + 1;
-		} else {
-			return midValue;
-		}
-	}
-
-	if (l > vector_i64_size(others) - 1) {
-		return *vector_i64_get(others, vector_i64_size(others) - 1);
-	} else {
-		int64_t lValue = *vector_i64_get(others, l);
-		int64_t rValue = *vector_i64_get(others, r);
-		return labs(lValue - value) < labs(rValue - value) ? lValue : rValue;
-	}
+	int64_t lValue = *vector_i64_get(others, i - 1);
+	int64_t rValue = *vector_i64_get(others, i);
+	return labs(rValue - value) < labs(lValue - value) ? rValue : lValue;
 }
 
 void cleanup(vector_i64_t* a, vector_i64_t* b, vector_i64_t* c) {
@@ -104,10 +104,15 @@ error_t task_rearrange_chars(const char* str, char** out) {
 		return ERROR_OUT_OF_MEMORY;
 	}
 
-	*out = (char*)string_to_c_str(&result);
+	*out = string_release(&result);
 	string_destroy(&numbers);
 	string_destroy(&letters);
 	string_destroy(&other);
+	if (!*out) {
+		string_destroy(&result);
+		return ERROR_OUT_OF_MEMORY;
+	}
+
 	return 0;
 }
 
@@ -133,6 +138,11 @@ error_t task_concat_randomly(const char** strings, size_t n, char** out) {
 		}
 	}
 
-	*out = (char*)string_to_c_str(&result);
+	*out = string_release(&result);
+	if (!*out) {
+		string_destroy(&result);
+		return ERROR_OUT_OF_MEMORY;
+	}
+
 	return 0;
 }
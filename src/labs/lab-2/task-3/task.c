@@ -1,9 +1,11 @@
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "lib/chars.h"
 #include "lib/collections/deque.h"
 #include "lib/error.h"
+#include "lib/strsimd.h"
 
 typedef enum match_result {
 	MATCH_FULL,
@@ -20,25 +22,28 @@ typedef struct match {
 DEFINE_DEQUE(deque_match_t, match_t, match)
 IMPL_DEQUE(deque_match_t, match_t, match)
 
-match_result_t match_substring(const char* cursor, const char* needle,
+/**
+ * Matches the |haystackLength| characters at |cursor| against |needle| (of
+ * |needleLength| characters) from the offset in |match|.
+ */
+match_result_t match_substring(const char* cursor, size_t haystackLength,
+                               const char* needle, size_t needleLength,
                                match_t match, ptrdiff_t* outOffset) {
 	if (cursor == NULL || needle == NULL) {
 		return MATCH_NONE;
 	}
 
-	char* haystackCur = (char*)cursor;
-	char* needleCur = (char*)needle + match.needleOffset;
+	const char* needleCur = needle + match.needleOffset;
+	needleLength -= (size_t)match.needleOffset;
 
-	while (*haystackCur != '\0' && *needleCur != '\0') {
-		if (*haystackCur != *needleCur) {
-			return MATCH_NONE;
-		}
-		++haystackCur;
-		++needleCur;
+	size_t n = haystackLength < needleLength ? haystackLength : needleLength;
+
+	if (strsimd_mismatch(cursor, needleCur, n) != n) {
+		return MATCH_NONE;
 	}
 
-	if (*haystackCur == '\0' && *needleCur != '\0') {
-		*outOffset = needleCur - needle;
+	if (haystackLength < needleLength) {
+		*outOffset = needleCur + n - needle;
 		return MATCH_PARTIAL;
 	}
 
@@ -64,8 +69,10 @@ error_t find_substring_in_file(const char* needle, const char* filePath,
 	char buffer[bufSize];
 	int line = 1;
 	int column = 0;
+	size_t needleLength = strlen(needle);
 
 	while (fgets(buffer, bufSize, file) != NULL) {
+		size_t bufferLength = strlen(buffer);
 		size_t incompleteCnt = deque_match_size(&partialMatches);
 
 		// Check matches that weren't checked fully due to the previous buffer
@@ -79,7 +86,8 @@ error_t find_substring_in_file(const char* needle, const char* filePath,
 
 			ptrdiff_t newOffset;
 			match_result_t result =
-			    match_substring(buffer, needle, partial, &newOffset);
+			    match_substring(buffer, bufferLength, needle, needleLength,
+			                    partial, &newOffset);
 
 			if (result == MATCH_FULL) {
 				if (!deque_match_push_back(&fullMatches, partial)) {
@@ -106,8 +114,9 @@ error_t find_substring_in_file(const char* needle, const char* filePath,
 			match_t match = {line, column, 0};
 
 			ptrdiff_t newOffset;
-			match_result_t result =
-			    match_substring(cursor, needle, match, &newOffset);
+			match_result_t result = match_substring(
+			    cursor, bufferLength - (size_t)(cursor - buffer), needle,
+			    needleLength, match, &newOffset);
 
 			if (result == MATCH_FULL) {
 				if (!deque_match_push_back(&fullMatches, match)) {
@@ -124,15 +124,19 @@ static int compare_employees_natural(const void* p1, const void* p2) {
 	return mth_sign_long((long)a->id - (long)b->id);
 }
 
-static int compare_employees_reverse(const void* p1, const void* p2) {
-	return -compare_employees_natural(p1, p2);
-}
+IMPL_VECTOR_SORT(employee_t, sort_employees_natural,
+                 compare_employees_natural(a, b) < 0)
+IMPL_VECTOR_SORT(employee_t, sort_employees_reverse,
+                 compare_employees_natural(b, a) < 0)
 
 error_t sort_employees(vector_employee_t* employees, bool ascending) {
 	if (!employees) return ERROR_INVALID_PARAMETER;
 
-	qsort(employees->buffer, employees->size, sizeof(employee_t),
-	      ascending ? &compare_employees_natural : &compare_employees_reverse);
+	if (ascending) {
+		sort_employees_natural(employees->buffer, employees->size);
+	} else {
+		sort_employees_reverse(employees->buffer, employees->size);
+	}
 
 	return 0;
 }
@@ -34,6 +34,7 @@ static int compare_mail_create_dt(const void* p1, const void* p2) {
 }
 
 IMPL_VECTOR(vector_mail_t, mail_t, mail, {&compare_mail})
+IMPL_VECTOR_SORT(mail_t, sort_mail_create_dt, compare_mail_create_dt(a, b) < 0)
 
 address_t address_create_empty(void) {
 	return (address_t){.city = string_create_empty(),
@@ -79,18 +80,8 @@ void post_destroy(post_t* post) {
 }
 
 bool post_insert_mail(post_t* post, mail_t mail) {
-	vector_mail_t* v = &post->mail;
-
-	// Find an insertion point for |mail|, such that the elements are in
-	// ascending order.
-	size_t idx = 0;
-
-	while (idx < vector_mail_size(v) &&
-	       compare_mail(&mail, vector_mail_get(v, idx)) != -1) {
-		++idx;
-	}
-
-	return vector_mail_insert(v, idx, mail);
+	// Keeps the mail in ascending order of |compare_mail|.
+	return vector_mail_sorted_insert(&post->mail, mail);
 }
 
 remove_result_t post_remove_mail(post_t* post, string_t* id) {
@@ -129,8 +120,7 @@ static bool post_filter_mail(post_t* post, vector_mail_t* out, bool expired) {
 	}
 
 	// Sort by creation datetime.
-	qsort((mail_t*)vector_mail_to_array(out), vector_mail_size(out),
-	      sizeof(mail_t), &compare_mail_create_dt);
+	sort_mail_create_dt(out->buffer, vector_mail_size(out));
 
 	return true;
 }
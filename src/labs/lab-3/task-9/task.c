@@ -1,16 +1,18 @@
 #include "task.h"
 
-#include <ctype.h>
-
 #include "lib/collections/string.h"
+#include "lib/strsimd.h"
 
+/** Compares words by length, then alphabetically ignoring the case. */
 int word_cmp(const char* a, const char* b) {
 	if (!a || !b || a == b) return 0;
 
-	int order = (int)strlen(a) - (int)strlen(b);
+	size_t length = strlen(a);
+
+	int order = (int)length - (int)strlen(b);
 	if (order) return order;
 
-	return strcmp(a, b);
+	return strsimd_casecmp(a, b, length);
 }
 
 char* str_lower(const char* str) {
@@ -19,10 +21,7 @@ char* str_lower(const char* str) {
 	char* lower = strdup(str);
 	if (!lower) return NULL;
 
-	for (char* p = lower; *p != '\0'; ++p) {
-		*p = (char)tolower(*p);
-	}
-
+	strsimd_lower(lower, lower, strlen(lower));
 	return lower;
 }
 
@@ -68,11 +67,12 @@ typedef enum insert_result {
 	INSERT_ADDED
 } insert_result_t;
 
-insert_result_t node_insert0(node_t** root, char* word) {
+insert_result_t node_insert0(node_t** root, const char* word) {
 	if (!root || !word) return INSERT_FAILED;
 
 	if (!(*root)) {
-		*root = node_create0(word);
+		// Only new words are lowercased (and copied).
+		*root = node_create(word);
 		return *root == NULL ? INSERT_FAILED : INSERT_ADDED;
 	} else {
 		int order = word_cmp(word, (*root)->word);
@@ -89,14 +89,7 @@ insert_result_t node_insert0(node_t** root, char* word) {
 }
 
 bool node_insert(node_t** root, const char* word) {
-	// Use a heap-allocated lowercase word.
-	char* lower = str_lower(word);
-	if (!lower) return false;
-
-	insert_result_t result = node_insert0(root, lower);
-	if (result != INSERT_ADDED) free(lower);
-
-	return result;
+	return node_insert0(root, word);
 }
 
 bool node_write(const node_t* node, FILE* outFp) {
@@ -214,14 +207,8 @@ unsigned long word_occurrences0(const node_t* root, const char* word) {
 }
 
 unsigned long word_tree_occurrences(const node_t* root, const char* word) {
-	// Use a heap-allocated lowercase word.
-	char* lower = str_lower(word);
-	if (!lower) return 0;
-
-	unsigned long count = word_occurrences0(root, lower);
-	free(lower);
-
-	return count;
+	// The words are compared ignoring the case.
+	return word_occurrences0(root, word);
 }
 
 node_t* word_tree_fail(node_t* root, string_t* word) {
@@ -0,0 +1,309 @@
+#include "array.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static array_buffer_t* buffer_create_(size_t capacity) {
+	array_buffer_t* buffer = (array_buffer_t*)malloc(sizeof(array_buffer_t));
+	if (!buffer) return NULL;
+
+	buffer->items = (int64_t*)malloc(capacity * sizeof(int64_t));
+	if (!buffer->items) {
+		free(buffer);
+		return NULL;
+	}
+
+	buffer->capacity = capacity;
+	atomic_init(&buffer->refs, 1);
+	return buffer;
+}
+
+static void buffer_release_(array_buffer_t* buffer) {
+	if (atomic_fetch_sub_explicit(&buffer->refs, 1, memory_order_acq_rel) !=
+	    1) {
+		return;
+	}
+
+	free(buffer->items);
+	free(buffer);
+}
+
+/**
+ * Appends |slice| to |array|, merging it with the last slice if they're
+ * adjacent. Doesn't touch the size of |array|.
+ *
+ * @return false if |array| has no room for another slice.
+ */
+static bool append_slice_(array_t* array, array_slice_t slice) {
+	if (!slice.size) return true;
+
+	if (array->sliceCount) {
+		array_slice_t* last = &array->slices[array->sliceCount - 1];
+
+		if (last->buffer == slice.buffer &&
+		    last->offset + last->size == slice.offset) {
+			last->size += slice.size;
+			return true;
+		}
+	}
+
+	if (array->sliceCount == ARRAY_MAX_SLICES) return false;
+
+	atomic_fetch_add_explicit(&slice.buffer->refs, 1, memory_order_relaxed);
+	array->slices[array->sliceCount++] = slice;
+	return true;
+}
+
+/** Copies the items of |array| to |out|. */
+static void copy_items_(const array_t* array, int64_t* out) {
+	for (size_t i = 0; i != array->sliceCount; ++i) {
+		const array_slice_t* slice = &array->slices[i];
+
+		memcpy(out, slice->buffer->items + slice->offset,
+		       slice->size * sizeof(int64_t));
+		out += slice->size;
+	}
+}
+
+/**
+ * Makes |array| a single slice of a buffer it owns alone, with room for
+ * |capacity| items. |capacity| is positive and not less than the size.
+ */
+static bool array_own_(array_t* array, size_t capacity) {
+	// Only this array can take another reference to a buffer it holds alone.
+	if (array->sliceCount == 1 &&
+	    atomic_load_explicit(&array->slices[0].buffer->refs,
+	                         memory_order_acquire) == 1) {
+		array_slice_t* slice = &array->slices[0];
+		array_buffer_t* buffer = slice->buffer;
+
+		if (slice->offset + capacity <= buffer->capacity) return true;
+
+		// Nothing else sees the items outside the slice, drop them.
+		memmove(buffer->items, buffer->items + slice->offset,
+		        slice->size * sizeof(int64_t));
+		slice->offset = 0;
+
+		if (capacity <= buffer->capacity) return true;
+
+		size_t grown = buffer->capacity * 2;
+		if (grown < capacity) grown = capacity;
+
+		int64_t* items =
+		    (int64_t*)realloc(buffer->items, grown * sizeof(int64_t));
+		if (!items) return false;
+
+		buffer->items = items;
+		buffer->capacity = grown;
+		return true;
+	}
+
+	array_buffer_t* buffer = buffer_create_(capacity);
+	if (!buffer) return false;
+
+	copy_items_(array, buffer->items);
+
+	size_t size = array->size;
+	array_destroy(array);
+
+	array->slices[0] = (array_slice_t){.buffer = buffer, .size = size};
+	array->sliceCount = 1;
+	array->size = size;
+	return true;
+}
+
+array_t array_create(void) { return (array_t){.sliceCount = 0, .size = 0}; }
+
+void array_destroy(array_t* array) {
+	if (!array) return;
+
+	for (size_t i = 0; i != array->sliceCount; ++i) {
+		buffer_release_(array->slices[i].buffer);
+	}
+
+	array->sliceCount = 0;
+	array->size = 0;
+}
+
+bool array_from_vector(vector_i64_t* vector, array_t* out) {
+	if (!vector || !out) return false;
+
+	array_t result = array_create();
+
+	if (!vector_i64_is_empty(vector)) {
+		array_buffer_t* buffer =
+		    (array_buffer_t*)malloc(sizeof(array_buffer_t));
+		if (!buffer) return false;
+
+		buffer->items = vector->buffer;
+		buffer->capacity = vector->capacity;
+		atomic_init(&buffer->refs, 1);
+
+		result.slices[0] =
+		    (array_slice_t){.buffer = buffer, .size = vector->size};
+		result.sliceCount = 1;
+		result.size = vector->size;
+
+		// The buffer belongs to |result| now.
+		*vector = vector_i64_create();
+	} else {
+		vector_i64_destroy(vector);
+		*vector = vector_i64_create();
+	}
+
+	array_destroy(out);
+	*out = result;
+	return true;
+}
+
+size_t array_size(const array_t* array) { return array->size; }
+
+int64_t array_get(const array_t* array, size_t idx) {
+	const array_slice_t* slice = array->slices;
+
+	while (idx >= slice->size) {
+		idx -= slice->size;
+		++slice;
+	}
+
+	return slice->buffer->items[slice->offset + idx];
+}
+
+void array_share_range(const array_t* src, size_t from, size_t count,
+                       array_t* dst) {
+	array_t result = array_create();
+	size_t start = 0;
+
+	// A range has no more slices than the array, so they always fit.
+	for (size_t i = 0; i != src->sliceCount; ++i) {
+		const array_slice_t* slice = &src->slices[i];
+
+		size_t lo = from > start ? from : start;
+		size_t hi = from + count < start + slice->size ? from + count
+		                                               : start + slice->size;
+
+		if (lo < hi) {
+			append_slice_(&result,
+			              (array_slice_t){.buffer = slice->buffer,
+			                              .offset = slice->offset + lo - start,
+			                              .size = hi - lo});
+		}
+
+		start += slice->size;
+	}
+
+	result.size = count;
+
+	// |result| holds its own references, so |dst| can be |src|.
+	array_destroy(dst);
+	*dst = result;
+}
+
+bool array_append(array_t* dst, const array_t* src) {
+	size_t n = src->size;
+	if (!n) return true;
+
+	if (dst->sliceCount + src->sliceCount <= ARRAY_MAX_SLICES) {
+		// |src| may be |dst|, so only append the slices present before.
+		array_slice_t slices[ARRAY_MAX_SLICES];
+		size_t sliceCount = src->sliceCount;
+		memcpy(slices, src->slices, sliceCount * sizeof(array_slice_t));
+
+		for (size_t i = 0; i != sliceCount; ++i) {
+			append_slice_(dst, slices[i]);
+		}
+
+		dst->size += n;
+		return true;
+	}
+
+	int64_t* out = array_extend(dst, n);
+	if (!out) return false;
+
+	if (src == dst) {
+		// |dst| is contiguous now, and its first half is the source.
+		memcpy(out, out - n, n * sizeof(int64_t));
+	} else {
+		copy_items_(src, out);
+	}
+
+	return true;
+}
+
+bool array_remove_range(array_t* array, size_t from, size_t count) {
+	if (!count) return true;
+
+	array_t result = array_create();
+	size_t start = 0;
+	bool fits = true;
+
+	for (size_t i = 0; fits && i != array->sliceCount; ++i) {
+		const array_slice_t* slice = &array->slices[i];
+		size_t end = start + slice->size;
+
+		// The parts of the slice before and after the removed range.
+		if (start < from) {
+			size_t size = (end < from ? end : from) - start;
+			fits = append_slice_(&result, (array_slice_t){
+			                                  .buffer = slice->buffer,
+			                                  .offset = slice->offset,
+			                                  .size = size});
+		}
+
+		if (fits && end > from + count) {
+			size_t skip = from + count > start ? from + count - start : 0;
+			fits = append_slice_(
+			    &result, (array_slice_t){.buffer = slice->buffer,
+			                             .offset = slice->offset + skip,
+			                             .size = slice->size - skip});
+		}
+
+		start = end;
+	}
+
+	if (fits) {
+		result.size = array->size - count;
+		array_destroy(array);
+		*array = result;
+		return true;
+	}
+
+	// Cutting a hole in every slice; fall back to moving the items.
+	array_destroy(&result);
+
+	int64_t* items = array_data_mut(array);
+	if (!items) return false;
+
+	memmove(items + from, items + from + count,
+	        (array->size - from - count) * sizeof(int64_t));
+	array->slices[0].size -= count;
+	array->size -= count;
+	return true;
+}
+
+int64_t* array_extend(array_t* array, size_t count) {
+	if (!count || !array_own_(array, array->size + count)) return NULL;
+
+	array_slice_t* slice = &array->slices[0];
+	int64_t* items = slice->buffer->items + slice->offset + slice->size;
+
+	slice->size += count;
+	array->size += count;
+	return items;
+}
+
+const int64_t* array_data(array_t* array) {
+	if (!array->size) return NULL;
+
+	if (array->sliceCount > 1 && !array_own_(array, array->size)) {
+		return NULL;
+	}
+
+	return array->slices[0].buffer->items + array->slices[0].offset;
+}
+
+int64_t* array_data_mut(array_t* array) {
+	if (!array->size || !array_own_(array, array->size)) return NULL;
+
+	return array->slices[0].buffer->items + array->slices[0].offset;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lib/collections/vector.h"
+
+/** Most slices an array is made of before it's copied into one buffer. */
+#define ARRAY_MAX_SLICES 8
+
+/**
+ * Items shared between arrays; freed when the last slice is released. The
+ * count is atomic, as arrays sharing a buffer may be used from different
+ * threads.
+ */
+typedef struct array_buffer {
+	int64_t* items;
+	size_t capacity;
+	atomic_size_t refs;
+} array_buffer_t;
+
+typedef struct array_slice {
+	array_buffer_t* buffer;
+	size_t offset;
+	size_t size;
+} array_slice_t;
+
+/**
+ * Copy-on-write array of |int64_t|: a sequence of slices of shared buffers.
+ * Taking a range of an array or appending one to another only copies slice
+ * descriptors. Items are copied once an array is written to while its
+ * buffer is shared, or when it's read as a whole and has several slices.
+ */
+typedef struct array {
+	array_slice_t slices[ARRAY_MAX_SLICES];
+	size_t sliceCount;
+	size_t size;
+} array_t;
+
+array_t array_create(void);
+
+/** Releases the slices of |array|, leaving it empty. */
+void array_destroy(array_t* array);
+
+/** Takes over the buffer of |vector|, leaving it empty. */
+bool array_from_vector(vector_i64_t* vector, array_t* out);
+
+size_t array_size(const array_t* array);
+
+/** Item at |idx|, which must be less than the size. */
+int64_t array_get(const array_t* array, size_t idx);
+
+/**
+ * Replaces |dst| with items [|from|; |from| + |count|) of |src|, sharing
+ * them. |dst| may be |src|.
+ */
+void array_share_range(const array_t* src, size_t from, size_t count,
+                       array_t* dst);
+
+/** Appends |src| to |dst|; |dst| may be |src|. */
+bool array_append(array_t* dst, const array_t* src);
+
+/** Removes items [|from|; |from| + |count|), which must be in range. */
+bool array_remove_range(array_t* array, size_t from, size_t count);
+
+/**
+ * Appends |count| uninitialized items.
+ *
+ * @return the first of them, or NULL if the array couldn't be grown.
+ */
+int64_t* array_extend(array_t* array, size_t count);
+
+/**
+ * Makes |array| contiguous, copying it if it has several slices.
+ *
+ * @return the items, or NULL if |array| is empty or couldn't be copied.
+ */
+const int64_t* array_data(array_t* array);
+
+/**
+ * Makes |array| contiguous and owned by it alone, copying it if needed, so
+ * the items can be written to.
+ *
+ * @return the items, or NULL if |array| is empty or couldn't be copied.
+ */
+int64_t* array_data_mut(array_t* array);
@@ -0,0 +1,372 @@
+#include "array_io.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define ARRAY_IO_MMAP
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define ARRAY_IO_LITTLE_ENDIAN
+#endif
+
+/** Size of the buffers files are read and written through. */
+#define ARRAY_IO_CHUNK_SIZE ((size_t)1 << 20)
+
+/** Magic and item count. */
+#define ARRAY_IO_HEADER_SIZE (ARRAY_IO_MAGIC_SIZE + 8)
+
+static const char DIGIT_PAIRS[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+size_t array_format_i64(int64_t value, char* out) {
+	char digits[ARRAY_IO_I64_MAX_CHARS];
+	char* p = digits + sizeof(digits);
+
+	// Negating in unsigned arithmetic keeps INT64_MIN intact.
+	uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+
+	while (magnitude >= 100) {
+		size_t pair = (size_t)(magnitude % 100) * 2;
+		magnitude /= 100;
+		*--p = DIGIT_PAIRS[pair + 1];
+		*--p = DIGIT_PAIRS[pair];
+	}
+
+	if (magnitude >= 10) {
+		size_t pair = (size_t)magnitude * 2;
+		*--p = DIGIT_PAIRS[pair + 1];
+		*--p = DIGIT_PAIRS[pair];
+	} else {
+		*--p = (char)('0' + magnitude);
+	}
+
+	if (value < 0) *--p = '-';
+
+	size_t length = (size_t)(digits + sizeof(digits) - p);
+	memcpy(out, p, length);
+	return length;
+}
+
+static uint64_t decode_u64_(const unsigned char* p) {
+	uint64_t value = 0;
+	for (int i = 7; i >= 0; --i) value = (value << 8) | p[i];
+	return value;
+}
+
+static void encode_u64_(unsigned char* p, uint64_t value) {
+	for (int i = 0; i != 8; ++i) p[i] = (unsigned char)(value >> (8 * i));
+}
+
+/** Copies |n| little-endian items from |src| into |dst|. */
+static void decode_items_(int64_t* dst, const unsigned char* src, size_t n) {
+#ifdef ARRAY_IO_LITTLE_ENDIAN
+	memcpy(dst, src, n * sizeof(int64_t));
+#else
+	for (size_t i = 0; i != n; ++i) {
+		dst[i] = (int64_t)decode_u64_(src + i * sizeof(int64_t));
+	}
+#endif
+}
+
+static void encode_items_(unsigned char* dst, const int64_t* src, size_t n) {
+#ifdef ARRAY_IO_LITTLE_ENDIAN
+	memcpy(dst, src, n * sizeof(int64_t));
+#else
+	for (size_t i = 0; i != n; ++i) {
+		encode_u64_(dst + i * sizeof(int64_t), (uint64_t)src[i]);
+	}
+#endif
+}
+
+/** Moves |loaded| into |out|. */
+static error_t load_commit_(vector_i64_t* loaded, array_t* out) {
+	if (!array_from_vector(loaded, out)) {
+		vector_i64_destroy(loaded);
+		return ERROR_OUT_OF_MEMORY;
+	}
+
+	return 0;
+}
+
+static error_t load_binary_(FILE* stream, uint64_t count, array_t* out) {
+	if (count > (SIZE_MAX - ARRAY_IO_HEADER_SIZE) / sizeof(int64_t)) {
+		return ERR_INVFILE;
+	}
+
+	size_t dataSize = (size_t)count * sizeof(int64_t);
+
+	vector_i64_t loaded = vector_i64_create_with_capacity(0);
+	if (count && !vector_i64_ensure_capacity(&loaded, (size_t)count)) {
+		return ERROR_OUT_OF_MEMORY;
+	}
+
+#ifdef ARRAY_IO_MMAP
+	struct stat st;
+	if (fstat(fileno(stream), &st) != 0) {
+		vector_i64_destroy(&loaded);
+		return ERROR_IO;
+	}
+
+	if ((uint64_t)st.st_size != ARRAY_IO_HEADER_SIZE + dataSize) {
+		vector_i64_destroy(&loaded);
+		return ERR_INVFILE;
+	}
+
+	if (count) {
+		size_t mapSize = ARRAY_IO_HEADER_SIZE + dataSize;
+
+		unsigned char* map = (unsigned char*)mmap(
+		    NULL, mapSize, PROT_READ, MAP_PRIVATE, fileno(stream), 0);
+		if (map == MAP_FAILED) {
+			vector_i64_destroy(&loaded);
+			return ERROR_IO;
+		}
+
+		madvise(map, mapSize, MADV_SEQUENTIAL);
+		decode_items_(loaded.buffer, map + ARRAY_IO_HEADER_SIZE, (size_t)count);
+		munmap(map, mapSize);
+	}
+#else
+	unsigned char* chunk = (unsigned char*)malloc(ARRAY_IO_CHUNK_SIZE);
+	if (!chunk) {
+		vector_i64_destroy(&loaded);
+		return ERROR_OUT_OF_MEMORY;
+	}
+
+	size_t perChunk = ARRAY_IO_CHUNK_SIZE / sizeof(int64_t);
+
+	for (size_t done = 0; done != count;) {
+		size_t n = count - done < perChunk ? count - done : perChunk;
+
+		if (fread(chunk, sizeof(int64_t), n, stream) != n) {
+			free(chunk);
+			vector_i64_destroy(&loaded);
+			return ferror(stream) ? ERROR_IO : ERR_INVFILE;
+		}
+
+		decode_items_(loaded.buffer + done, chunk, n);
+		done += n;
+	}
+
+	free(chunk);
+
+	if (fgetc(stream) != EOF) {
+		vector_i64_destroy(&loaded);
+		return ERR_INVFILE;
+	}
+#endif
+
+	loaded.size = (size_t)count;
+	return load_commit_(&loaded, out);
+}
+
+/** State of a number split between chunks. */
+typedef struct text_parser {
+	vector_i64_t items;
+	uint64_t magnitude;
+	unsigned digits;
+	bool negative;
+	bool inNumber;
+} text_parser_t;
+
+static error_t text_parser_finish_number_(text_parser_t* p) {
+	// Only "-", which has no digits.
+	if (!p->digits) return ERROR_UNEXPECTED_TOKEN;
+
+	vector_i64_t* items = &p->items;
+	if (items->size == items->capacity) {
+		size_t capacity = items->capacity < 4096 ? 4096 : items->capacity * 2;
+		if (!vector_i64_ensure_capacity(items, capacity)) {
+			return ERROR_OUT_OF_MEMORY;
+		}
+	}
+
+	// |magnitude| is at most 2^63 for negative numbers.
+	items->buffer[items->size++] =
+	    p->negative ? -(int64_t)(p->magnitude - 1) - 1 : (int64_t)p->magnitude;
+
+	p->magnitude = 0;
+	p->digits = 0;
+	p->negative = false;
+	p->inNumber = false;
+	return 0;
+}
+
+static error_t text_parser_feed_(text_parser_t* p, const unsigned char* data,
+                                 size_t n) {
+	error_t error;
+
+	for (size_t i = 0; i != n; ++i) {
+		unsigned char ch = data[i];
+		unsigned digit = (unsigned)ch - '0';
+
+		if (digit < 10) {
+			// 18 digits can't overflow, so longer numbers are checked only.
+			if (p->digits >= 18) {
+				uint64_t limit = p->negative ? (uint64_t)INT64_MAX + 1
+				                             : (uint64_t)INT64_MAX;
+				if (p->magnitude > (limit - digit) / 10) return ERROR_OVERFLOW;
+			}
+
+			p->magnitude = p->magnitude * 10 + digit;
+			p->digits++;
+			p->inNumber = true;
+		} else if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r') {
+			if (p->inNumber && (error = text_parser_finish_number_(p))) {
+				return error;
+			}
+		} else if (ch == '-' && !p->inNumber) {
+			p->negative = true;
+			p->inNumber = true;
+		} else {
+			return ERROR_UNEXPECTED_TOKEN;
+		}
+	}
+
+	return 0;
+}
+
+static error_t load_text_(FILE* stream, const unsigned char* head,
+                          size_t headSize, array_t* out) {
+	error_t error;
+
+	text_parser_t parser = {.items = vector_i64_create_with_capacity(0)};
+
+	unsigned char* chunk = (unsigned char*)malloc(ARRAY_IO_CHUNK_SIZE);
+	if (!chunk) return ERROR_OUT_OF_MEMORY;
+
+	// The bytes read while looking for the magic come first.
+	error = text_parser_feed_(&parser, head, headSize);
+
+	while (!error) {
+		size_t n = fread(chunk, 1, ARRAY_IO_CHUNK_SIZE, stream);
+		if (n == 0) break;
+
+		error = text_parser_feed_(&parser, chunk, n);
+	}
+
+	free(chunk);
+
+	if (!error && ferror(stream)) error = ERROR_IO;
+	if (!error && parser.inNumber) error = text_parser_finish_number_(&parser);
+
+	if (error) {
+		vector_i64_destroy(&parser.items);
+		return error;
+	}
+
+	return load_commit_(&parser.items, out);
+}
+
+error_t array_load(const char* path, array_t* out) {
+	if (!path || !out) return ERROR_INVALID_PARAMETER;
+
+	FILE* stream = fopen(path, "rb");
+	if (!stream) return ERROR_IO;
+
+	unsigned char header[ARRAY_IO_HEADER_SIZE];
+	size_t headerSize = fread(header, 1, sizeof(header), stream);
+
+	error_t error;
+
+	if (headerSize >= ARRAY_IO_MAGIC_SIZE &&
+	    memcmp(header, ARRAY_IO_MAGIC, ARRAY_IO_MAGIC_SIZE) == 0) {
+		error = headerSize == ARRAY_IO_HEADER_SIZE
+		            ? load_binary_(stream,
+		                           decode_u64_(header + ARRAY_IO_MAGIC_SIZE),
+		                           out)
+		            : ERR_INVFILE;
+	} else {
+		error = load_text_(stream, header, headerSize, out);
+	}
+
+	fclose(stream);
+	return error;
+}
+
+static error_t save_binary_(FILE* stream, const array_t* array,
+                            unsigned char* chunk) {
+	memcpy(chunk, ARRAY_IO_MAGIC, ARRAY_IO_MAGIC_SIZE);
+	encode_u64_(chunk + ARRAY_IO_MAGIC_SIZE, (uint64_t)array_size(array));
+
+	if (fwrite(chunk, 1, ARRAY_IO_HEADER_SIZE, stream) !=
+	    ARRAY_IO_HEADER_SIZE) {
+		return ERROR_IO;
+	}
+
+	size_t perChunk = ARRAY_IO_CHUNK_SIZE / sizeof(int64_t);
+
+	for (size_t i = 0; i != array->sliceCount; ++i) {
+		const array_slice_t* slice = &array->slices[i];
+		const int64_t* items = slice->buffer->items + slice->offset;
+
+		for (size_t done = 0; done != slice->size;) {
+			size_t count = slice->size - done < perChunk ? slice->size - done
+			                                             : perChunk;
+
+			encode_items_(chunk, items + done, count);
+			if (fwrite(chunk, sizeof(int64_t), count, stream) != count) {
+				return ERROR_IO;
+			}
+
+			done += count;
+		}
+	}
+
+	return 0;
+}
+
+static error_t save_text_(FILE* stream, const array_t* array, char* chunk) {
+	size_t used = 0;
+
+	for (size_t i = 0; i != array->sliceCount; ++i) {
+		const array_slice_t* slice = &array->slices[i];
+		const int64_t* items = slice->buffer->items + slice->offset;
+
+		for (size_t j = 0; j != slice->size; ++j) {
+			// Room for the number and the newline.
+			if (ARRAY_IO_CHUNK_SIZE - used < ARRAY_IO_I64_MAX_CHARS + 1) {
+				if (fwrite(chunk, 1, used, stream) != used) return ERROR_IO;
+				used = 0;
+			}
+
+			used += array_format_i64(items[j], chunk + used);
+			chunk[used++] = '\n';
+		}
+	}
+
+	return fwrite(chunk, 1, used, stream) == used ? 0 : ERROR_IO;
+}
+
+error_t array_save(const char* path, const array_t* array,
+                   array_format_t format) {
+	if (!path || !array) return ERROR_INVALID_PARAMETER;
+
+	char* chunk = (char*)malloc(ARRAY_IO_CHUNK_SIZE);
+	if (!chunk) return ERROR_OUT_OF_MEMORY;
+
+	FILE* stream = fopen(path, format == ARRAY_FORMAT_BINARY ? "wb" : "w");
+	if (!stream) {
+		free(chunk);
+		return ERROR_IO;
+	}
+
+	error_t error = format == ARRAY_FORMAT_BINARY
+	                    ? save_binary_(stream, array, (unsigned char*)chunk)
+	                    : save_text_(stream, array, chunk);
+
+	if (fclose(stream) != 0 && !error) error = ERROR_IO;
+	free(chunk);
+
+	return error;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "array.h"
+#include "lib/error.h"
+
+#define ERR_INVFILE 0x20000005
+
+/**
+ * Binary arrays start with this magic, followed by the item count and the
+ * items, all as little-endian 64-bit integers. A text file can't start with
+ * it, so LOAD tells the formats apart by the first bytes.
+ */
+#define ARRAY_IO_MAGIC "I64ARRAY"
+#define ARRAY_IO_MAGIC_SIZE 8
+
+/** Longest formatted |int64_t|: "-9223372036854775808". */
+#define ARRAY_IO_I64_MAX_CHARS 20
+
+typedef enum array_format {
+	/** Whitespace-separated decimal numbers. */
+	ARRAY_FORMAT_TEXT,
+	/** See |ARRAY_IO_MAGIC|. */
+	ARRAY_FORMAT_BINARY
+} array_format_t;
+
+/**
+ * Replaces the contents of |out| with the array at |path|, in either format.
+ * Binary files are mapped into memory and copied into a new buffer; text
+ * files are read in large chunks and parsed in place. |out| is left intact
+ * on failure.
+ *
+ * @return `ERR_INVFILE` if a binary file is truncated,
+ *         `ERROR_UNEXPECTED_TOKEN` or `ERROR_OVERFLOW` if a text file has a
+ *         malformed number.
+ */
+error_t array_load(const char* path, array_t* out);
+
+/** Writes |array| to |path| in |format|. */
+error_t array_save(const char* path, const array_t* array,
+                   array_format_t format);
+
+/**
+ * Formats |value| in decimal into |out|, without a terminator.
+ *
+ * @return the number of characters written, at most
+ *         |ARRAY_IO_I64_MAX_CHARS|.
+ */
+size_t array_format_i64(int64_t value, char* out);
@@ -0,0 +1,363 @@
+#include "bytecode.h"
+
+#include "lib/chars.h"
+#include "lib/convert.h"
+
+IMPL_VECTOR(vector_bc_insn_t, bc_insn_t, bc_insn, {NULL})
+
+bytecode_t bytecode_create(void) {
+	return (bytecode_t){.code = vector_bc_insn_create(),
+	                    .strings = vector_str_create()};
+}
+
+void bytecode_destroy(bytecode_t* bc) {
+	if (!bc) return;
+
+	for (size_t i = 0; i != vector_str_size(&bc->strings); ++i) {
+		string_destroy(vector_str_get(&bc->strings, i));
+	}
+
+	vector_str_destroy(&bc->strings);
+	vector_bc_insn_destroy(&bc->code);
+}
+
+void bytecode_clear(bytecode_t* bc) {
+	if (!bc) return;
+
+	for (size_t i = 0; i != vector_str_size(&bc->strings); ++i) {
+		string_destroy(vector_str_get(&bc->strings, i));
+	}
+
+	// Keep the buffers for the next instructions.
+	bc->strings.size = 0;
+	bc->code.size = 0;
+}
+
+const char* bytecode_str(const bytecode_t* bc, const bc_insn_t* insn) {
+	if (insn->str == BC_NO_STR) return NULL;
+	return string_to_c_str(vector_str_get(&bc->strings, insn->str));
+}
+
+static error_t compile_array_idx_(const char* arg, uint8_t* idx) {
+	if (!arg || !chars_is_alpha(*arg) || *(arg + 1) != '\0') {
+		return ERR_INVARRID;
+	}
+
+	*idx = (uint8_t)(chars_lower(*arg) - 'a');
+	return 0;
+}
+
+static error_t compile_ulong_(const char* arg, int64_t* out) {
+	unsigned long value;
+
+	error_t error = str_to_ulong((char*)arg, &value);
+	if (error) return error;
+
+	*out = (int64_t)value;
+	return 0;
+}
+
+static error_t compile_long_(const char* arg, int64_t* out) {
+	long value;
+
+	error_t error = str_to_long((char*)arg, &value);
+	if (error) return error;
+
+	*out = value;
+	return 0;
+}
+
+static error_t compile_str_(bytecode_t* bc, const char* arg, uint32_t* idx) {
+	string_t string = {.initialized = false};
+	if (!string_from_c_str(&string, arg)) return ERROR_OUT_OF_MEMORY;
+
+	if (!vector_str_push_back(&bc->strings, string)) {
+		string_destroy(&string);
+		return ERROR_OUT_OF_MEMORY;
+	}
+
+	*idx = (uint32_t)(vector_str_size(&bc->strings) - 1);
+	return 0;
+}
+
+/** Checks the argument count of |insn| for its opcode. */
+static bool compile_argc_valid_(const insn_t* insn) {
+	size_t argc = insn_argc(insn);
+
+	switch (insn->op) {
+		case OP_LOAD:
+		case OP_CONCAT:
+			return argc == 2;
+		case OP_RAND:
+		case OP_COPY:
+			return argc == 4;
+		case OP_FREE:
+		case OP_SORT:
+		case OP_SHUFFLE:
+		case OP_STATS:
+			return argc == 1;
+		case OP_REMOVE:
+			return argc == 3;
+		case OP_SAVE:
+			return argc == 2 || argc == 3;
+		case OP_PRINT:
+			return argc >= 2 && argc <= 4;
+		default:
+			return false;
+	}
+}
+
+static error_t compile_insn_(bytecode_t* bc, const insn_t* insn,
+                             bc_insn_t* out) {
+	error_t error = 0;
+
+	*out = (bc_insn_t){.op = (uint8_t)insn->op};
+
+	if (insn->op >= OP_HALT) return ERR_INVOP;
+	if (!compile_argc_valid_(insn)) return ERR_INVARGCNT;
+
+	switch (insn->op) {
+		case OP_LOAD:
+			if ((error = compile_array_idx_(insn_arg(insn, 0), &out->dst))) {
+				fprintf(stderr, "Can't parse array index.\n");
+				return error;
+			}
+			return compile_str_(bc, insn_arg(insn, 1), &out->str);
+		case OP_SAVE:
+			if ((error = compile_array_idx_(insn_arg(insn, 0), &out->dst))) {
+				fprintf(stderr, "Can't parse array index.\n");
+				return error;
+			}
+
+			// "Save a, out.bin, binary;" picks the format, text by default.
+			out->mode = ARRAY_FORMAT_TEXT;
+			if (insn_argc(insn) == 3) {
+				const char* format = insn_arg(insn, 2);
+
+				if (stricmp(format, "binary") == 0) {
+					out->mode = ARRAY_FORMAT_BINARY;
+				} else if (stricmp(format, "text") != 0) {
+					fprintf(stderr, "Invalid file format.\n");
+					return ERROR_INVALID_PARAMETER;
+				}
+			}
+			return compile_str_(bc, insn_arg(insn, 1), &out->str);
+		case OP_RAND:
+			if ((error = compile_array_idx_(insn_arg(insn, 0), &out->dst))) {
+				fprintf(stderr, "Can't parse array index.\n");
+			} else if ((error = compile_ulong_(insn_arg(insn, 1),
+			                                   &out->imm[0]))) {
+				fprintf(stderr, "Can't parse item count.\n");
+			} else if ((error = compile_long_(insn_arg(insn, 2),
+			                                  &out->imm[1]))) {
+				fprintf(stderr, "Can't parse lower bound.\n");
+			} else if ((error = compile_long_(insn_arg(insn, 3),
+			                                  &out->imm[2]))) {
+				fprintf(stderr, "Can't parse upper bound.\n");
+			} else if (out->imm[1] > out->imm[2]) {
+				fprintf(stderr, "Lower bound exceeds upper bound.\n");
+				error = ERROR_INVALID_PARAMETER;
+			}
+			return error;
+		case OP_CONCAT:
+			if ((error = compile_array_idx_(insn_arg(insn, 0), &out->dst))) {
+				fprintf(stderr, "Can't parse destination array index.\n");
+			} else if ((error = compile_array_idx_(insn_arg(insn, 1),
+			                                       &out->src))) {
+				fprintf(stderr, "Can't parse source array index.\n");
+			}
+			return error;
+		case OP_FREE:
+		case OP_SHUFFLE:
+		case OP_STATS:
+			if ((error = compile_array_idx_(insn_arg(insn, 0), &out->dst))) {
+				fprintf(stderr, "Can't parse array index.\n");
+			}
+			return error;
+		case OP_REMOVE:
+			if ((error = compile_array_idx_(insn_arg(insn, 0), &out->dst))) {
+				fprintf(stderr, "Can't parse array index.\n");
+			} else if ((error = compile_ulong_(insn_arg(insn, 1),
+			                                   &out->imm[0])) ||
+			           (error = compile_ulong_(insn_arg(insn, 2),
+			                                   &out->imm[1]))) {
+				fprintf(stderr, "Invalid range.\n");
+			}
+			return error;
+		case OP_COPY:
+			if ((error = compile_array_idx_(insn_arg(insn, 0), &out->src))) {
+				fprintf(stderr, "Can't parse source array index.\n");
+			} else if ((error = compile_ulong_(insn_arg(insn, 1),
+			                                   &out->imm[0])) ||
+			           (error = compile_ulong_(insn_arg(insn, 2),
+			                                   &out->imm[1]))) {
+				fprintf(stderr, "Invalid range.\n");
+			} else if ((error = compile_array_idx_(insn_arg(insn, 3),
+			                                       &out->dst))) {
+				fprintf(stderr, "Can't parse destination array index.\n");
+			}
+			return error;
+		case OP_SORT: {
+			// "a+" sorts ascending, "a-" descending.
+			const char* arg = insn_arg(insn, 0);
+
+			if (!chars_is_alpha(*arg) ||
+			    (*(arg + 1) != '+' && *(arg + 1) != '-') ||
+			    *(arg + 2) != '\0') {
+				fprintf(stderr, "Invalid array index or sort order.\n");
+				return ERROR_INVALID_PARAMETER;
+			}
+
+			out->dst = (uint8_t)(chars_lower(*arg) - 'a');
+			out->mode = *(arg + 1) == '+' ? SORT_ASCENDING : SORT_DESCENDING;
+			return 0;
+		}
+		case OP_PRINT: {
+			if ((error = compile_array_idx_(insn_arg(insn, 0), &out->dst))) {
+				fprintf(stderr, "Can't parse array index.\n");
+				return error;
+			}
+
+			// "Print a, all, >out.txt;" prints into a file.
+			size_t argc = insn_argc(insn);
+			const char* last = insn_arg(insn, argc - 1);
+
+			out->str = BC_NO_STR;
+			if (*last == '>') {
+				if ((error = compile_str_(bc, last + 1, &out->str))) {
+					return error;
+				}
+				--argc;
+			}
+
+			if (argc == 4) {
+				fprintf(stderr, "Too many arguments.\n");
+				return ERR_INVARGCNT;
+			} else if (argc == 3) {
+				out->mode = PRINT_RANGE;
+				if ((error = compile_ulong_(insn_arg(insn, 1), &out->imm[0])) ||
+				    (error = compile_ulong_(insn_arg(insn, 2), &out->imm[1]))) {
+					fprintf(stderr, "Invalid range.\n");
+				}
+			} else if (stricmp(insn_arg(insn, 1), "all") == 0) {
+				out->mode = PRINT_ALL;
+			} else {
+				out->mode = PRINT_ONE;
+				if ((error = compile_ulong_(insn_arg(insn, 1), &out->imm[0]))) {
+					fprintf(stderr, "Invalid `from` index.\n");
+				}
+			}
+			return error;
+		}
+		default:
+			return ERR_INVOP;
+	}
+}
+
+error_t bytecode_compile_insn(bytecode_t* bc, const insn_t* insn) {
+	if (!bc || !insn) return ERROR_INVALID_PARAMETER;
+
+	bc_insn_t compiled;
+
+	error_t error = compile_insn_(bc, insn, &compiled);
+	if (error) return error;
+
+	return vector_bc_insn_push_back(&bc->code, compiled) ? 0
+	                                                     : ERROR_OUT_OF_MEMORY;
+}
+
+void bytecode_report(const insn_t* insn, size_t bci, error_t error) {
+	fprintf(stderr, "----------------------------------------------\n");
+	fprintf(stderr, "While compiling instruction %s (bci = %zu):\n",
+	        opcode_to_string(insn->op), bci);
+
+	error_fmt_t fmt[] = {&interp_error_to_string};
+	error_print_ex(error, fmt, sizeof(fmt) / sizeof(fmt[0]));
+}
+
+error_t bytecode_compile(const vector_insn_t* insns, bytecode_t* out) {
+	if (!insns || !out) return ERROR_INVALID_PARAMETER;
+
+	*out = bytecode_create();
+
+	// One extra slot for the terminator.
+	if (!vector_bc_insn_ensure_capacity(&out->code,
+	                                    vector_insn_size(insns) + 1)) {
+		return ERROR_OUT_OF_MEMORY;
+	}
+
+	for (size_t i = 0; i != vector_insn_size(insns); ++i) {
+		const insn_t* insn = vector_insn_get(insns, i);
+
+		error_t error = bytecode_compile_insn(out, insn);
+		if (error) {
+			bytecode_report(insn, i, error);
+			return error;
+		}
+	}
+
+	bc_insn_t halt = {.op = OP_HALT};
+	return vector_bc_insn_push_back(&out->code, halt) ? 0
+	                                                  : ERROR_OUT_OF_MEMORY;
+}
+
+void bc_insn_print(FILE* stream, const bytecode_t* bc, const bc_insn_t* insn) {
+	char dst = (char)('a' + insn->dst);
+	char src = (char)('a' + insn->src);
+
+	fprintf(stream, "%s", opcode_to_string(insn->op));
+
+	switch (insn->op) {
+		case OP_LOAD:
+			fprintf(stream, " %c, %s", dst, bytecode_str(bc, insn));
+			break;
+		case OP_SAVE:
+			fprintf(stream, " %c, %s, %s", dst, bytecode_str(bc, insn),
+			        insn->mode == ARRAY_FORMAT_BINARY ? "binary" : "text");
+			break;
+		case OP_RAND:
+			fprintf(stream, " %c, %llu, %lld, %lld", dst,
+			        (unsigned long long)insn->imm[0], (long long)insn->imm[1],
+			        (long long)insn->imm[2]);
+			break;
+		case OP_CONCAT:
+			fprintf(stream, " %c, %c", dst, src);
+			break;
+		case OP_REMOVE:
+			fprintf(stream, " %c, %llu, %llu", dst,
+			        (unsigned long long)insn->imm[0],
+			        (unsigned long long)insn->imm[1]);
+			break;
+		case OP_COPY:
+			fprintf(stream, " %c, %llu, %llu, %c", src,
+			        (unsigned long long)insn->imm[0],
+			        (unsigned long long)insn->imm[1], dst);
+			break;
+		case OP_SORT:
+			fprintf(stream, " %c%c", dst,
+			        insn->mode == SORT_ASCENDING ? '+' : '-');
+			break;
+		case OP_PRINT:
+			if (insn->mode == PRINT_ALL) {
+				fprintf(stream, " %c, all", dst);
+			} else if (insn->mode == PRINT_ONE) {
+				fprintf(stream, " %c, %llu", dst,
+				        (unsigned long long)insn->imm[0]);
+			} else {
+				fprintf(stream, " %c, %llu, %llu", dst,
+				        (unsigned long long)insn->imm[0],
+				        (unsigned long long)insn->imm[1]);
+			}
+			if (insn->str != BC_NO_STR) {
+				fprintf(stream, ", >%s", bytecode_str(bc, insn));
+			}
+			break;
+		case OP_HALT:
+			break;
+		default:
+			fprintf(stream, " %c", dst);
+			break;
+	}
+
+	fputc('\n', stream);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "array_io.h"
+#include "interp.h"
+#include "lib/collections/string.h"
+#include "lib/collections/vector.h"
+#include "lib/error.h"
+
+typedef enum sort_order { SORT_ASCENDING, SORT_DESCENDING } sort_order_t;
+
+typedef enum print_mode {
+	/** Print the whole array. */
+	PRINT_ALL,
+	/** Print the element at `imm[0]`. */
+	PRINT_ONE,
+	/** Print the elements in [`imm[0]`; `imm[1]`]. */
+	PRINT_RANGE
+} print_mode_t;
+
+/**
+ * Pre-decoded instruction: array indices, numbers and modes are resolved
+ * while compiling, so handlers don't look at the source text.
+ *
+ *  LOAD    dst, str            SAVE    dst, str, mode = array_format_t
+ *  RAND    dst, imm = {count, lb, ub}
+ *  CONCAT  dst, src            FREE    dst
+ *  REMOVE  dst, imm = {from, count}
+ *  COPY    src, imm = {from, to}, dst
+ *  SORT    dst, mode = sort_order_t
+ *  SHUFFLE dst                 STATS   dst
+ *  PRINT   dst, mode = print_mode_t, imm = {from, to}, str = file or
+ *          `BC_NO_STR`
+ */
+/** |bc_insn_t.str| of an instruction without a string operand. */
+#define BC_NO_STR UINT32_MAX
+
+typedef struct bc_insn {
+	uint8_t op;
+	uint8_t dst;
+	uint8_t src;
+	uint8_t mode;
+	/** Index of a string operand in |bytecode_t.strings|. */
+	uint32_t str;
+	int64_t imm[3];
+} bc_insn_t;
+
+DEFINE_VECTOR(vector_bc_insn_t, bc_insn_t, bc_insn)
+
+typedef struct bytecode {
+	/** Compiled instructions, terminated with `OP_HALT`. */
+	vector_bc_insn_t code;
+	/** File names referenced by LOAD and SAVE. */
+	vector_str_t strings;
+} bytecode_t;
+
+bytecode_t bytecode_create(void);
+
+void bytecode_destroy(bytecode_t* bc);
+
+/** Drops the instructions and strings of |bc|, keeping its buffers. */
+void bytecode_clear(bytecode_t* bc);
+
+/** Compiles |insn| and appends it to |bc|. */
+error_t bytecode_compile_insn(bytecode_t* bc, const insn_t* insn);
+
+/**
+ * Compiles |insns| into |out| and terminates the code with `OP_HALT`. On
+ * failure, reports the offending instruction to stderr.
+ */
+error_t bytecode_compile(const vector_insn_t* insns, bytecode_t* out);
+
+/** Reports that |insn| at |bci| failed to compile with |error| to stderr. */
+void bytecode_report(const insn_t* insn, size_t bci, error_t error);
+
+/** String operand of |insn|, or NULL if it has none. */
+const char* bytecode_str(const bytecode_t* bc, const bc_insn_t* insn);
+
+/** Prints |insn| to |stream| in the source syntax. */
+void bc_insn_print(FILE* stream, const bytecode_t* bc, const bc_insn_t* insn);
@@ -2,24 +2,16 @@
 
 #include "lib/chars.h"
 
-error_t parse_stream_fail(error_t errcode, vector_insn_t* insns, insn_t* insn,
-                          string_t* buffer) {
-	if (insns) {
-		for (size_t i = 0; i != vector_insn_size(insns); ++i) {
-			insn_t* other = vector_insn_get(insns, i);
-
-			// Check if |insn| is in |insns|, preventing double-frees on the
-			// args array.
-			if (insn && other->args.buffer == insn->args.buffer) {
-				insn = NULL;
-			}
-
-			insn_destroy(other);
-		}
-
-		vector_insn_destroy(insns);
+const char* insn_parser_error_to_string(error_t error) {
+	switch (error) {
+		case ERR_INVINSN:
+			return "Unknown instruction";
+		default:
+			return NULL;
 	}
+}
 
+error_t parse_next_fail(error_t errcode, insn_t* insn, string_t* buffer) {
 	if (insn) {
 		insn_destroy(insn);
 	}
@@ -33,19 +25,16 @@ error_t parse_stream_fail(error_t errcode, vector_insn_t* insns, insn_t* insn,
 
 typedef enum { PARSE_OP, PARSE_ARG, PARSE_SEMI } parse_st_t;
 
-error_t insn_parse_stream(vector_insn_t* insns, FILE* stream) {
-	if (!insns) return ERROR_INVALID_PARAMETER;
-
-	*insns = vector_insn_create();
+error_t insn_parse_next(FILE* stream, insn_t* out) {
+	if (!stream || !out) return ERROR_INVALID_PARAMETER;
 
-	// Instruction being parsed. Since vector_str_create doesn't allocate
-	// anything, it's fine if it's overwritten
-	insn_t insn = {.args = vector_str_create()};
+	// Instruction being parsed; `OP_HALT` until the opcode is read.
+	insn_t insn = insn_create(OP_HALT);
 
 	// Temporary buffer to hold stuff being parsed.
 	string_t buffer;
 	if (!string_create(&buffer)) {
-		return parse_stream_fail(ERROR_OUT_OF_MEMORY, insns, &insn, &buffer);
+		return parse_next_fail(ERROR_OUT_OF_MEMORY, &insn, NULL);
 	}
 
 	// Parsing state.
@@ -73,35 +62,32 @@ error_t insn_parse_stream(vector_insn_t* insns, FILE* stream) {
 					// Finish the opcode
 					opcode_t op = opcode_from_string(string_to_c_str(&buffer));
 					if (op == OP_INVALID) {
-						return parse_stream_fail(ERR_INVOP, insns, &insn,
-						                         &buffer);
+						return parse_next_fail(ERR_INVINSN, &insn, &buffer);
 					}
 					// Ensure that only `Free(a);` is parsed with braces.
 					if ((op == OP_FREE && ch != '(') ||
 					    (op != OP_FREE && ch == '(')) {
-						return parse_stream_fail(ERROR_UNEXPECTED_TOKEN, insns, &insn,
-						                         &buffer);
+						return parse_next_fail(ERROR_UNEXPECTED_TOKEN, &insn,
+						                       &buffer);
 					}
-					insn = insn_create(op);
+					insn.op = op;
 					if (!string_clear(&buffer)) {
-						return parse_stream_fail(ERROR_OUT_OF_MEMORY, insns, &insn,
-						                         &buffer);
+						return parse_next_fail(ERROR_OUT_OF_MEMORY, &insn,
+						                       &buffer);
 					}
 				} else {
 					if (!string_append_char(&buffer, ch)) {
-						return parse_stream_fail(ERROR_OUT_OF_MEMORY, insns, &insn,
-						                         &buffer);
+						return parse_next_fail(ERROR_OUT_OF_MEMORY, &insn,
+						                       &buffer);
 					}
 				}
 
 				if (ch == '(' || ch == ' ') {
 					st = PARSE_ARG;
 				} else if (ch == ';') {
-					if (!vector_insn_push_back(insns, insn)) {
-						return parse_stream_fail(ERROR_OUT_OF_MEMORY, insns, &insn,
-						                         &buffer);
-					}
-					st = PARSE_OP;
+					string_destroy(&buffer);
+					*out = insn;
+					return 0;
 				}
 
 				break;
@@ -112,33 +98,31 @@ error_t insn_parse_stream(vector_insn_t* insns, FILE* stream) {
 				    (ch == ')' && insn.op == OP_FREE)) {
 					string_t arg = {.initialized = false};
 					if (!string_copy(&buffer, &arg)) {
-						return parse_stream_fail(ERROR_OUT_OF_MEMORY, insns, &insn,
-						                         &buffer);
+						return parse_next_fail(ERROR_OUT_OF_MEMORY, &insn,
+						                       &buffer);
 					}
 					if (!vector_str_push_back(&insn.args, arg)) {
 						string_destroy(&arg);
-						return parse_stream_fail(ERROR_OUT_OF_MEMORY, insns, &insn,
-						                         &buffer);
+						return parse_next_fail(ERROR_OUT_OF_MEMORY, &insn,
+						                       &buffer);
 					}
 					if (!string_clear(&buffer)) {
-						return parse_stream_fail(ERROR_OUT_OF_MEMORY, insns, &insn,
-						                         &buffer);
+						return parse_next_fail(ERROR_OUT_OF_MEMORY, &insn,
+						                       &buffer);
 					}
 				} else if (!chars_is_space(ch) && ch != '\n') {
 					if (!string_append_char(&buffer, ch)) {
-						return parse_stream_fail(ERROR_OUT_OF_MEMORY, insns, &insn,
-						                         &buffer);
+						return parse_next_fail(ERROR_OUT_OF_MEMORY, &insn,
+						                       &buffer);
 					}
 				}
 
 				if (ch == ',') {
 					st = PARSE_ARG;
 				} else if (ch == ';') {
-					if (!vector_insn_push_back(insns, insn)) {
-						return parse_stream_fail(ERROR_OUT_OF_MEMORY, insns, &insn,
-						                         &buffer);
-					}
-					st = PARSE_OP;
+					string_destroy(&buffer);
+					*out = insn;
+					return 0;
 				} else if (ch == ')' && insn.op == OP_FREE) {
 					st = PARSE_SEMI;
 				}
@@ -147,25 +131,56 @@ error_t insn_parse_stream(vector_insn_t* insns, FILE* stream) {
 			}
 			case PARSE_SEMI: {
 				if (ch != ';') {
-					return parse_stream_fail(ERROR_UNEXPECTED_TOKEN, insns, &insn,
-					                         &buffer);
-				}
-				if (!vector_insn_push_back(insns, insn)) {
-					return parse_stream_fail(ERROR_OUT_OF_MEMORY, insns, &insn, &buffer);
+					return parse_next_fail(ERROR_UNEXPECTED_TOKEN, &insn,
+					                       &buffer);
 				}
-				st = PARSE_OP;
-				break;
+				string_destroy(&buffer);
+				*out = insn;
+				return 0;
 			}
 		}
 	}
 
-	if (st != PARSE_OP) {
-		return parse_stream_fail(ERROR_UNEXPECTED_TOKEN, insns, &insn, &buffer);
+	// An opcode without a semicolon is incomplete too.
+	if (st != PARSE_OP || string_length(&buffer) != 0) {
+		return parse_next_fail(ERROR_UNEXPECTED_TOKEN, &insn, &buffer);
 	}
 	if (ferror(stream)) {
-		return parse_stream_fail(ERROR_IO, insns, &insn, &buffer);
+		return parse_next_fail(ERROR_IO, &insn, &buffer);
 	}
 
 	string_destroy(&buffer);
+	*out = insn_create(OP_HALT);
+	return 0;
+}
+
+error_t parse_stream_fail(error_t errcode, vector_insn_t* insns) {
+	for (size_t i = 0; i != vector_insn_size(insns); ++i) {
+		insn_destroy(vector_insn_get(insns, i));
+	}
+
+	vector_insn_destroy(insns);
+	return errcode;
+}
+
+error_t insn_parse_stream(vector_insn_t* insns, FILE* stream) {
+	if (!insns) return ERROR_INVALID_PARAMETER;
+
+	*insns = vector_insn_create();
+
+	for (;;) {
+		insn_t insn;
+
+		error_t error = insn_parse_next(stream, &insn);
+		if (error) return parse_stream_fail(error, insns);
+
+		if (insn.op == OP_HALT) break;
+
+		if (!vector_insn_push_back(insns, insn)) {
+			insn_destroy(&insn);
+			return parse_stream_fail(ERROR_OUT_OF_MEMORY, insns);
+		}
+	}
+
 	return 0;
 }
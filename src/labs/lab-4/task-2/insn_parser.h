@@ -5,6 +5,17 @@
 #include "interp.h"
 #include "lib/error.h"
 
-#define ERR_INVOP 0x10000001
+#define ERR_INVINSN 0x10000001
 
+const char* insn_parser_error_to_string(error_t error);
+
+/**
+ * Parses the next instruction of |stream| into |out|, reading no further
+ * than its semicolon.
+ *
+ * @return 0 with `OP_HALT` in |out| at the end of |stream|.
+ */
+error_t insn_parse_next(FILE* stream, insn_t* out);
+
+/** Parses every instruction of |stream| into |insns|. */
 error_t insn_parse_stream(vector_insn_t* insns, FILE* stream);
@@ -1,12 +1,22 @@
 #include "interp.h"
 
-#include <math.h>
 #include <time.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define INTERP_POSIX_IO
+#endif
+
+#include "array_io.h"
+#include "bytecode.h"
+#include "insn_parser.h"
 #include "lib/chars.h"
-#include "lib/convert.h"
-#include "lib/lexeme.h"
-#include "lib/mth.h"
+#include "rand_fill.h"
+#include "shuffle.h"
+#include "sort.h"
+#include "stats.h"
 
 IMPL_VECTOR(vector_insn_t, insn_t, insn, {NULL})
 
@@ -18,6 +28,8 @@ const char* interp_error_to_string(error_t error) {
 			return "Invalid array index";
 		case ERR_IDXRANGE:
 			return "Array index out of range";
+		case ERR_INVFILE:
+			return "Malformed array file";
 		default:
 			return NULL;
 	}
@@ -65,6 +77,8 @@ const char* opcode_to_string(opcode_t op) {
 			return "OP_STATS";
 		case OP_PRINT:
 			return "OP_PRINT";
+		case OP_HALT:
+			return "OP_HALT";
 		case OP_INVALID:
 			return "OP_INVALID";
 	}
@@ -132,555 +146,516 @@ interp_t interp_create(void) {
 	interp_t ip;
 
 	for (size_t i = 0; i != sizeof(ip.state) / sizeof(ip.state[0]); ++i) {
-		ip.state[i] = vector_i64_create();
+		ip.state[i] = array_create();
 	}
 
+	interp_seed(&ip, (uint64_t)time(NULL));
+
 	return ip;
 }
 
-void interp_destroy(interp_t* ip) {
+void interp_seed(interp_t* ip, uint64_t seed) {
 	if (!ip) return;
 
-	for (size_t i = 0; i != sizeof(ip->state) / sizeof(ip->state[0]); ++i) {
-		vector_i64_destroy(&ip->state[i]);
-	}
+	ip->rng = rng_create(seed);
+	ip->randKey = rng_next(&ip->rng);
+	ip->randCounter = 0;
 }
 
-error_t get_array_idx_(const char* arg, size_t* idx) {
-	if (!arg || !idx) {
-		return ERROR_INVALID_PARAMETER;
-	}
-	if ((*arg != '\0' && *(arg + 1) != '\0') || !chars_is_alpha(*arg)) {
-		return ERR_INVARRID;
-	}
+void interp_destroy(interp_t* ip) {
+	if (!ip) return;
 
-	*idx = chars_lower(*arg) - 'a';
-	return 0;
+	for (size_t i = 0; i != sizeof(ip->state) / sizeof(ip->state[0]); ++i) {
+		array_destroy(&ip->state[i]);
+	}
 }
 
-error_t load_clean_(error_t errcode, FILE* stream, vector_str_t* lexemes) {
-	fclose(stream);
+error_t interp_load_(interp_t* ip, const bc_insn_t* insn, const char* path) {
+	error_t error = array_load(path, &ip->state[insn->dst]);
 
-	if (lexemes) {
-		lexeme_destroy(lexemes);
+	switch (error) {
+		case 0:
+			break;
+		case ERROR_IO:
+			fprintf(stderr, "Can't read %s.\n", path);
+			break;
+		case ERROR_UNEXPECTED_TOKEN:
+		case ERROR_OVERFLOW:
+			fprintf(stderr, "Can't parse %s: malformed number.\n", path);
+			break;
+		default:
+			fprintf(stderr, "Can't load array from %s.\n", path);
+			break;
 	}
 
-	return errcode;
+	return error;
 }
 
-error_t interp_load_(interp_t* ip, const insn_t* insn) {
-	error_t error;
+/** Size of the buffer PRINT formats items into. */
+#define PRINT_BUFFER_SIZE ((size_t)1 << 16)
 
-	if (!ip || !insn || insn->op != OP_LOAD) return ERROR_INVALID_PARAMETER;
-	if (insn_argc(insn) != 2) return ERR_INVARGCNT;
+/** Longest line of PRINT: "[<index>] <item>\n". */
+#define PRINT_LINE_MAX (2 * ARRAY_IO_I64_MAX_CHARS + 4)
 
-	size_t idx;
-	if ((error = get_array_idx_(insn_arg(insn, 0), &idx))) {
-		fprintf(stderr, "Can't parse array index.\n");
-		return error;
-	}
+/** Where PRINT writes: |stream|, or |fd| when printing into a file. */
+typedef struct print_sink {
+	FILE* stream;
+	int fd;
+	size_t used;
+	char buffer[PRINT_BUFFER_SIZE];
+} print_sink_t;
 
-	FILE* stream = fopen(insn_arg(insn, 1), "r");
-	if (!stream) {
-		fprintf(stderr, "Can't open the input file for reading.\n");
-		return ERROR_IO;
-	}
-
-	vector_str_t lexemes;
-	if ((error = lexeme_read(stream, &lexemes))) {
-		fprintf(stderr, "Can't read lexemes from the input file.\n");
-		return load_clean_(error, stream, &lexemes);
-	}
+static bool print_flush_(print_sink_t* sink) {
+	size_t used = sink->used;
+	sink->used = 0;
 
-	if (!vector_i64_clear(&ip->state[idx])) {
-		fprintf(stderr, "Can't clear state array.\n");
-		return load_clean_(ERROR_OUT_OF_MEMORY, stream, &lexemes);
+	if (sink->stream) {
+		return fwrite(sink->buffer, 1, used, sink->stream) == used;
 	}
 
-	for (size_t i = 0; i != vector_str_size(&lexemes); ++i) {
-		string_t* lexeme = vector_str_get(&lexemes, i);
-
-		long value;
-		if ((error = str_to_long(string_to_c_str(lexeme), &value))) {
-			fprintf(stderr, "Can't parse %s as long number.\n",
-			        string_to_c_str(lexeme));
-			return load_clean_(error, stream, &lexemes);
-		}
+#ifdef INTERP_POSIX_IO
+	for (const char* p = sink->buffer; used != 0;) {
+		ssize_t written = write(sink->fd, p, used);
+		if (written < 0 && errno == EINTR) continue;
+		if (written <= 0) return false;
 
-		if (!vector_i64_push_back(&ip->state[idx], value)) {
-			fprintf(stderr, "Can't insert number into state array.\n");
-			return load_clean_(ERROR_OUT_OF_MEMORY, stream, &lexemes);
-		}
+		p += written;
+		used -= (size_t)written;
 	}
+#endif
+
+	return true;
+}
 
-	return load_clean_(0, stream, &lexemes);
+static void print_put_(print_sink_t* sink, const char* chars, size_t n) {
+	memcpy(sink->buffer + sink->used, chars, n);
+	sink->used += n;
 }
 
-error_t print_range_(const vector_i64_t* array, size_t from, size_t to) {
+static error_t print_range_(print_sink_t* sink, const array_t* array,
+                            size_t from, size_t to) {
 	for (size_t i = from; i != to + 1; ++i) {
-		int64_t* item = vector_i64_get(array, i);
-		if (!item) {
+		if (i >= array_size(array)) {
+			print_flush_(sink);
 			return ERR_IDXRANGE;
 		}
-		printf("[%zu] %lld\n", i, *item);
-	}
-
-	return 0;
-}
-
-error_t save_clean_(error_t errcode, FILE* stream) {
-	fclose(stream);
-	return errcode;
-}
-
-error_t interp_save_(interp_t* ip, const insn_t* insn) {
-	error_t error;
-
-	if (!ip || !insn || insn->op != OP_SAVE) return ERROR_INVALID_PARAMETER;
-	if (insn_argc(insn) != 2) return ERR_INVARGCNT;
 
-	size_t idx;
-	if ((error = get_array_idx_(insn_arg(insn, 0), &idx))) {
-		fprintf(stderr, "Can't parse array index.\n");
-		return error;
-	}
-
-	FILE* stream = fopen(insn_arg(insn, 1), "w");
-	if (!stream) {
-		fprintf(stderr, "Can't open output file for writing.\n");
-		return ERROR_IO;
-	}
-
-	vector_i64_t* array = &ip->state[idx];
-	for (size_t i = 0; i != vector_i64_size(array); ++i) {
-		fprintf(stream, "%lld\n", *vector_i64_get(array, i));
-		if (ferror(stream)) {
-			fprintf(stderr, "Can't write to output file.\n");
-			return save_clean_(ERROR_IO, stream);
+		if (PRINT_BUFFER_SIZE - sink->used < PRINT_LINE_MAX &&
+		    !print_flush_(sink)) {
+			return ERROR_IO;
 		}
-	}
 
-	return save_clean_(0, stream);
-}
-
-error_t interp_rand_(interp_t* ip, const insn_t* insn) {
-	error_t error;
+		char* p = sink->buffer + sink->used;
 
-	if (!ip || !insn || insn->op != OP_RAND) return ERROR_INVALID_PARAMETER;
-	if (insn_argc(insn) != 4) return ERR_INVARGCNT;
+		*p++ = '[';
+		p += array_format_i64((int64_t)i, p);
+		*p++ = ']';
+		*p++ = ' ';
+		p += array_format_i64(array_get(array, i), p);
+		*p++ = '\n';
 
-	size_t idx;
-	if ((error = get_array_idx_(insn_arg(insn, 0), &idx))) {
-		fprintf(stderr, "Can't parse array index.\n");
-		return error;
+		sink->used = (size_t)(p - sink->buffer);
 	}
 
-	size_t count;
-	if ((error = str_to_ulong(insn_arg(insn, 1), &count))) {
-		fprintf(stderr, "Can't parse item count.\n");
-		return error;
-	}
-	long lb;
-	if ((error = str_to_long(insn_arg(insn, 2), &lb))) {
-		fprintf(stderr, "Can't parse lower bound.\n");
-		return error;
-	}
-	long ub;
-	if ((error = str_to_long(insn_arg(insn, 3), &ub))) {
-		fprintf(stderr, "Can't parse upper bound.\n");
-		return error;
-	}
-
-	srand(time(NULL));  // NOLINT(*-msc51-cpp)
+	return print_flush_(sink) ? 0 : ERROR_IO;
+}
 
-	while (count--) {
-		long value = mth_rand(lb, ub + 1);
-		if (!vector_i64_push_back(&ip->state[idx], value)) {
-			fprintf(stderr, "Can't push value into array.\n");
-			return ERROR_OUT_OF_MEMORY;
-		}
+error_t interp_save_(interp_t* ip, const bc_insn_t* insn, const char* path) {
+	error_t error =
+	    array_save(path, &ip->state[insn->dst], (array_format_t)insn->mode);
+	if (error) {
+		fprintf(stderr, "Can't write array to %s.\n", path);
 	}
 
-	return 0;
+	return error;
 }
 
-error_t interp_concat_(interp_t* ip, const insn_t* insn) {
-	error_t error;
+error_t interp_rand_(interp_t* ip, const bc_insn_t* insn) {
+	size_t count = (size_t)insn->imm[0];
 
-	if (!ip || !insn || insn->op != OP_CONCAT) return ERROR_INVALID_PARAMETER;
-	if (insn_argc(insn) != 2) return ERR_INVARGCNT;
+	if (!count) return 0;
 
-	size_t dstIdx;
-	if ((error = get_array_idx_(insn_arg(insn, 0), &dstIdx))) {
-		fprintf(stderr, "Can't parse destination array index.\n");
-		return error;
-	}
-	size_t srcIdx;
-	if ((error = get_array_idx_(insn_arg(insn, 1), &srcIdx))) {
-		fprintf(stderr, "Can't parse source array index.\n");
-		return error;
+	int64_t* items = array_extend(&ip->state[insn->dst], count);
+	if (!items) {
+		fprintf(stderr, "Can't push values into array.\n");
+		return ERROR_OUT_OF_MEMORY;
 	}
 
-	vector_i64_t* src = &ip->state[srcIdx];
-	vector_i64_t* dst = &ip->state[dstIdx];
-
-	for (size_t i = 0; i != vector_i64_size(src); ++i) {
-		int64_t* value = vector_i64_get(src, i);
-		if (!vector_i64_push_back(dst, *value)) {
-			fprintf(stderr, "Can't push into destination array.\n");
-			return ERROR_OUT_OF_MEMORY;
-		}
-	}
+	rand_fill_i64(items, count, insn->imm[1], insn->imm[2], ip->randKey,
+	              ip->randCounter);
+	ip->randCounter += count;
 
 	return 0;
 }
 
-error_t interp_free_(interp_t* ip, const insn_t* insn) {
-	error_t error;
-
-	if (!ip || !insn || insn->op != OP_FREE) return ERROR_INVALID_PARAMETER;
-	if (insn_argc(insn) != 1) return ERR_INVARGCNT;
-
-	size_t idx;
-	if ((error = get_array_idx_(insn_arg(insn, 0), &idx))) {
-		fprintf(stderr, "Can't parse array index.\n");
-		return error;
-	}
-
-	vector_i64_t* array = &ip->state[idx];
-	if (!vector_i64_clear(array)) {
-		fprintf(stderr, "Can't clean state array.\n");
+error_t interp_concat_(interp_t* ip, const bc_insn_t* insn) {
+	// Shares the items of |src|; they're copied on the next write.
+	if (!array_append(&ip->state[insn->dst], &ip->state[insn->src])) {
+		fprintf(stderr, "Can't push into destination array.\n");
 		return ERROR_OUT_OF_MEMORY;
 	}
 
 	return 0;
 }
 
-error_t interp_remove_(interp_t* ip, const insn_t* insn) {
-	error_t error;
-
-	if (!ip || !insn || insn->op != OP_REMOVE) return ERROR_INVALID_PARAMETER;
-	if (insn_argc(insn) != 3) return ERR_INVARGCNT;
-
-	size_t idx;
-	if ((error = get_array_idx_(insn_arg(insn, 0), &idx))) {
-		fprintf(stderr, "Can't parse array index.\n");
-		return error;
-	}
-	size_t from, count;
-	if ((error = str_to_ulong(insn_arg(insn, 1), &from)) ||
-	    (error = str_to_ulong(insn_arg(insn, 2), &count))) {
-		fprintf(stderr, "Invalid range.\n");
-		return error;
-	}
-
-	vector_i64_t* array = &ip->state[idx];
-
-	while (count--) {
-		if (!vector_i64_remove(array, from, NULL)) {
-			fprintf(stderr,
-			        "Can't remove item from vector. Index is out of range or \n"
-			        "the vector couldn't be shrunk.\n");
-			return ERROR_ASSERT;
-		}
-	}
-
+error_t interp_free_(interp_t* ip, const bc_insn_t* insn) {
+	array_destroy(&ip->state[insn->dst]);
 	return 0;
 }
 
-error_t interp_copy_(interp_t* ip, const insn_t* insn) {
-	error_t error;
+error_t interp_remove_(interp_t* ip, const bc_insn_t* insn) {
+	size_t from = (size_t)insn->imm[0];
+	size_t count = (size_t)insn->imm[1];
 
-	if (!ip || !insn || insn->op != OP_COPY) return ERROR_INVALID_PARAMETER;
-	if (insn_argc(insn) != 4) return ERR_INVARGCNT;
+	array_t* array = &ip->state[insn->dst];
 
-	size_t srcIdx;
-	if ((error = get_array_idx_(insn_arg(insn, 0), &srcIdx))) {
-		fprintf(stderr, "Can't parse source array index.\n");
-		return error;
-	}
-	size_t from, to;
-	if ((error = str_to_ulong(insn_arg(insn, 1), &from)) ||
-	    (error = str_to_ulong(insn_arg(insn, 2), &to))) {
-		fprintf(stderr, "Invalid range.\n");
-		return error;
+	if (from > array_size(array) || count > array_size(array) - from) {
+		fprintf(stderr, "Can't remove items: range is out of bounds.\n");
+		return ERROR_ASSERT;
 	}
-	size_t dstIdx;
-	if ((error = get_array_idx_(insn_arg(insn, 3), &dstIdx))) {
-		fprintf(stderr, "Can't parse destination array index.\n");
-		return error;
-	}
-
-	vector_i64_t* src = &ip->state[srcIdx];
-	vector_i64_t* dst = &ip->state[dstIdx];
 
-	if (!vector_i64_clear(dst)) {
+	if (!array_remove_range(array, from, count)) {
+		fprintf(stderr, "Can't remove items: the array can't be copied.\n");
 		return ERROR_OUT_OF_MEMORY;
 	}
 
-	for (size_t i = from; i != to + 1; ++i) {
-		int64_t* value = vector_i64_get(src, i);
-		if (!value) {
-			return ERR_IDXRANGE;
-		}
-		if (!vector_i64_push_back(dst, *value)) {
-			fprintf(stderr, "Can't push value into destination array.\n");
-			return ERROR_OUT_OF_MEMORY;
-		}
-	}
-
 	return 0;
 }
 
-int cmp_long_ascending_(const int64_t* a, const int64_t* b) {
-	if (!a || !b || a == b) return 0;
-	return mth_sign_long(*a - *b);
-}
-
-int cmp_long_descending_(const int64_t* a, const int64_t* b) {
-	if (!a || !b || a == b) return 0;
-	return mth_sign_long(*b - *a);
-}
-
-int cmp_long_random(const int64_t* a, const int64_t* b) {
-	if (!a || !b) return 0;
-	return (int)mth_rand(-1, 2);  // Random value in [-1; 1]
-}
-
-error_t interp_sort_(interp_t* ip, const insn_t* insn) {
-	if (!ip || !insn || insn->op != OP_SORT) return ERROR_INVALID_PARAMETER;
-	if (insn_argc(insn) != 1) return ERR_INVARGCNT;
+error_t interp_copy_(interp_t* ip, const bc_insn_t* insn) {
+	size_t from = (size_t)insn->imm[0];
+	size_t to = (size_t)insn->imm[1];
 
-	const char* arg = insn_arg(insn, 0);
+	array_t* src = &ip->state[insn->src];
 
-	vector_i64_t* array;
-	bool sortAscending;
-
-	if (chars_is_alpha(*arg) && (*(arg + 1) == '+' || *(arg + 1) == '-')) {
-		array = &ip->state[chars_lower(*arg) - 'a'];
-		sortAscending = *(arg + 1) == '+';
-	} else {
-		fprintf(stderr, "Invalid array index or sort order.\n");
-		return ERROR_INVALID_PARAMETER;
+	if (to >= array_size(src) || from > to + 1) {
+		return ERR_IDXRANGE;
 	}
 
-	qsort(array->buffer, array->size, sizeof(int64_t),
-	      (int (*)(const void*, const void*))(
-	          sortAscending ? &cmp_long_ascending_ : &cmp_long_descending_));
+	// Shares the range of |src|; it's copied on the next write.
+	array_share_range(src, from, to + 1 - from, &ip->state[insn->dst]);
 
 	return 0;
 }
 
-error_t interp_shuffle_(interp_t* ip, const insn_t* insn) {
-	error_t error;
+error_t interp_sort_(interp_t* ip, const bc_insn_t* insn) {
+	array_t* array = &ip->state[insn->dst];
+	if (!array_size(array)) return 0;
 
-	if (!ip || !insn || insn->op != OP_SHUFFLE) return ERROR_INVALID_PARAMETER;
-	if (insn_argc(insn) != 1) return ERR_INVARGCNT;
-
-	size_t idx;
-	if ((error = get_array_idx_(insn_arg(insn, 0), &idx))) {
-		return error;
-	}
+	int64_t* items = array_data_mut(array);
+	if (!items) return ERROR_OUT_OF_MEMORY;
 
-	srand(time(NULL));  // NOLINT(*-msc51-cpp)
-
-	vector_i64_t* array = &ip->state[idx];
-	qsort(array->buffer, array->size, sizeof(int64_t),
-	      (int (*)(const void*, const void*)) & cmp_long_random);
+	sort_i64(items, array_size(array), insn->mode == SORT_DESCENDING);
 
 	return 0;
 }
 
-error_t stats_clean_(error_t errcode, vector_i64_t* clone) {
-	vector_i64_destroy(clone);
-	return errcode;
-}
+error_t interp_shuffle_(interp_t* ip, const bc_insn_t* insn) {
+	array_t* array = &ip->state[insn->dst];
+	if (!array_size(array)) return 0;
 
-error_t interp_stats_(interp_t* ip, const insn_t* insn) {
-	error_t error;
+	int64_t* items = array_data_mut(array);
+	if (!items) return ERROR_OUT_OF_MEMORY;
 
-	if (!ip || !insn || insn->op != OP_STATS) return ERROR_INVALID_PARAMETER;
-	if (insn_argc(insn) != 1) return ERR_INVARGCNT;
+	shuffle_i64(items, array_size(array), &ip->rng);
 
-	size_t idx;
-	if ((error = get_array_idx_(insn_arg(insn, 0), &idx))) {
-		return error;
-	}
+	return 0;
+}
 
-	vector_i64_t* array = &ip->state[idx];
-	size_t n = vector_i64_size(array);
+error_t interp_stats_(interp_t* ip, const bc_insn_t* insn, FILE* out) {
+	array_t* array = &ip->state[insn->dst];
 
-	if (vector_i64_is_empty(array)) {
+	if (!array_size(array)) {
 		fprintf(stderr, "The array is empty.\n");
 		return 0;
 	}
 
-	size_t minIdx = 0, maxIdx = 0;
-	double mean = 0, stddev = 0;
+	const int64_t* items = array_data(array);
+	if (!items) return ERROR_OUT_OF_MEMORY;
 
-	for (size_t i = 0; i != n; ++i) {
-		int64_t* value = vector_i64_get(array, i);
+	stats_i64_t stats;
+	if (!stats_i64(items, array_size(array), &stats)) {
+		return ERROR_OUT_OF_MEMORY;
+	}
 
-		if (*value < *vector_i64_get(array, minIdx)) minIdx = i;
-		if (*value > *vector_i64_get(array, maxIdx)) maxIdx = i;
+	fprintf(out, "Min: %lld at %zu, max: %lld at %zu\n", items[stats.minIdx],
+	        stats.minIdx, items[stats.maxIdx], stats.maxIdx);
+	fprintf(out, "Mean: %lf, stddev: %lf, mode: %lld\n", stats.mean,
+	        stats.stddev, stats.mode);
 
-		mean += (double)*value;
+	return 0;
+}
+
+static error_t print_to_(print_sink_t* sink, const array_t* array,
+                         const bc_insn_t* insn) {
+	switch ((print_mode_t)insn->mode) {
+		case PRINT_ALL:
+			// Special case, because (0 - 1) in an ulong is UB.
+			if (!array_size(array)) {
+				static const char EMPTY[] = "<empty array>\n";
+				print_put_(sink, EMPTY, sizeof(EMPTY) - 1);
+				return print_flush_(sink) ? 0 : ERROR_IO;
+			}
+			return print_range_(sink, array, 0, array_size(array) - 1);
+		case PRINT_ONE:
+			return print_range_(sink, array, (size_t)insn->imm[0],
+			                    (size_t)insn->imm[0]);
+		case PRINT_RANGE:
+			return print_range_(sink, array, (size_t)insn->imm[0],
+			                    (size_t)insn->imm[1]);
 	}
 
-	mean /= (double)n;
+	return ERROR_INVALID_PARAMETER;
+}
 
-	for (size_t i = 0; i != n; ++i) {
-		double value = (double)*vector_i64_get(array, i);
-		stddev += (value - mean) * (value - mean);
+/**
+ * Prints into the file at |path| if there's one, or into |out| otherwise.
+ * Files are written with write(2) where it's available, skipping stdio.
+ */
+error_t interp_print_(interp_t* ip, const bc_insn_t* insn, const char* path,
+                      FILE* out) {
+	print_sink_t* sink = (print_sink_t*)malloc(sizeof(print_sink_t));
+	if (!sink) return ERROR_OUT_OF_MEMORY;
+
+	*sink = (print_sink_t){.stream = out, .fd = -1, .used = 0};
+
+	if (path) {
+#ifdef INTERP_POSIX_IO
+		sink->stream = NULL;
+		sink->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (sink->fd < 0) {
+			fprintf(stderr, "Can't open %s for writing.\n", path);
+			free(sink);
+			return ERROR_IO;
+		}
+#else
+		sink->stream = fopen(path, "w");
+		if (!sink->stream) {
+			fprintf(stderr, "Can't open %s for writing.\n", path);
+			free(sink);
+			return ERROR_IO;
+		}
+#endif
 	}
 
-	stddev /= (double)n;
-	stddev = sqrt(stddev);
+	error_t error = print_to_(sink, &ip->state[insn->dst], insn);
 
-	vector_i64_t clone;
-	if (!vector_i64_dup(array, &clone) || !vector_i64_sort(&clone)) {
-		return stats_clean_(ERROR_OUT_OF_MEMORY, &clone);
+	if (path) {
+#ifdef INTERP_POSIX_IO
+		if (close(sink->fd) != 0 && !error) error = ERROR_IO;
+#else
+		if (fclose(sink->stream) != 0 && !error) error = ERROR_IO;
+#endif
 	}
 
-	size_t maxCount = 1, count = 1;
-	int64_t mode = *vector_i64_get(&clone, 0);
+	free(sink);
+	return error;
+}
 
-	for (size_t i = 1; i != n; ++i) {
-		int64_t value = *vector_i64_get(&clone, i);
-		int64_t value0 = *vector_i64_get(&clone, i - 1);
+error_t interp_exec(interp_t* ip, const bytecode_t* bc,
+                    const bc_insn_t* insn, FILE* out) {
+	if (!ip || !bc || !insn || !out) return ERROR_INVALID_PARAMETER;
 
-		if (value == value0) {
-			++count;
-		} else {
-			count = 1;
-		}
-		if (count > maxCount) {
-			maxCount = count;
-			mode = value;
-		} else if (count == maxCount && value > mode) {
-			mode = value;
-		}
+	switch ((opcode_t)insn->op) {
+		case OP_LOAD:
+			return interp_load_(ip, insn, bytecode_str(bc, insn));
+		case OP_SAVE:
+			return interp_save_(ip, insn, bytecode_str(bc, insn));
+		case OP_RAND:
+			return interp_rand_(ip, insn);
+		case OP_CONCAT:
+			return interp_concat_(ip, insn);
+		case OP_FREE:
+			return interp_free_(ip, insn);
+		case OP_REMOVE:
+			return interp_remove_(ip, insn);
+		case OP_COPY:
+			return interp_copy_(ip, insn);
+		case OP_SORT:
+			return interp_sort_(ip, insn);
+		case OP_SHUFFLE:
+			return interp_shuffle_(ip, insn);
+		case OP_STATS:
+			return interp_stats_(ip, insn, out);
+		case OP_PRINT:
+			return interp_print_(ip, insn, bytecode_str(bc, insn), out);
+		case OP_HALT:
+			return 0;
+		default:
+			return ERR_INVOP;
 	}
+}
 
-	printf("Min: %lld at %zu, max: %lld at %zu\n",
-	       *vector_i64_get(array, minIdx), minIdx,
-	       *vector_i64_get(array, maxIdx), maxIdx);
-	printf("Mean: %lf, stddev: %lf, mode: %lld\n", mean, stddev, mode);
+void interp_report(const bc_insn_t* insn, size_t bci, error_t error) {
+	fprintf(stderr, "----------------------------------------------\n");
+	fprintf(stderr, "While executing instruction %s (bci = %zu):\n",
+	        opcode_to_string(insn->op), bci);
 
-	return stats_clean_(0, &clone);
+	error_fmt_t fmt[] = {&interp_error_to_string};
+	error_print_ex(error, fmt, sizeof(fmt) / sizeof(fmt[0]));
 }
 
-error_t interp_print_(interp_t* ip, const insn_t* insn) {
-	error_t error;
+/*
+ * Dispatch jumps straight from one handler to the next through a table of
+ * label addresses where the compiler supports it (GCC, Clang), and falls back
+ * to a switch in a loop otherwise.
+ */
+#if defined(__GNUC__)
+#define INTERP_THREADED 1
+#else
+#define INTERP_THREADED 0
+#endif
+
+#if INTERP_THREADED
+#define INTERP_CASE(OP) L_##OP
+#define INTERP_DISPATCH() goto* DISPATCH_TABLE[pc->op]
+#define INTERP_LOOP_BEGIN INTERP_DISPATCH();
+#define INTERP_LOOP_END
+#else
+#define INTERP_CASE(OP) case OP
+#define INTERP_DISPATCH() continue
+#define INTERP_LOOP_BEGIN \
+	for (;;) {            \
+		switch (pc->op) {
+#define INTERP_LOOP_END    \
+	default:               \
+		error = ERR_INVOP; \
+		goto fail;         \
+		}                  \
+		}
+#endif
+
+/**
+ * Checks the handler's result, then moves on to the next instruction. Not
+ * wrapped in `do {} while (0)`, since `continue` has to reach the loop.
+ */
+#define INTERP_NEXT()                                                       \
+	{                                                                       \
+		if (error) goto fail;                                               \
+		++pc;                                                               \
+		if (verbose) interp_trace_(bc, pc, (size_t)(pc - bc->code.buffer)); \
+		INTERP_DISPATCH();                                                  \
+	}
+
+static void interp_trace_(const bytecode_t* bc, const bc_insn_t* pc,
+                          size_t bci) {
+	printf("> [bci %zu] ", bci);
+	bc_insn_print(stdout, bc, pc);
+}
 
-	if (!ip || !insn || insn->op != OP_PRINT) return ERROR_INVALID_PARAMETER;
-	if (insn_argc(insn) != 2 && insn_argc(insn) != 3) return ERR_INVARGCNT;
+#if INTERP_THREADED
+// Labels as values are a GNU extension.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
 
-	size_t idx;
-	if ((error = get_array_idx_(insn_arg(insn, 0), &idx))) {
-		return error;
+error_t interp_run(interp_t* ip, const bytecode_t* bc, bool verbose) {
+	if (!ip || !bc || vector_bc_insn_is_empty(&bc->code)) {
+		return ERROR_INVALID_PARAMETER;
 	}
 
-	vector_i64_t* array = &ip->state[idx];
+#if INTERP_THREADED
+	static const void* const DISPATCH_TABLE[] = {
+	    [OP_LOAD] = &&L_OP_LOAD,       [OP_SAVE] = &&L_OP_SAVE,
+	    [OP_RAND] = &&L_OP_RAND,       [OP_CONCAT] = &&L_OP_CONCAT,
+	    [OP_FREE] = &&L_OP_FREE,       [OP_REMOVE] = &&L_OP_REMOVE,
+	    [OP_COPY] = &&L_OP_COPY,       [OP_SORT] = &&L_OP_SORT,
+	    [OP_SHUFFLE] = &&L_OP_SHUFFLE, [OP_STATS] = &&L_OP_STATS,
+	    [OP_PRINT] = &&L_OP_PRINT,     [OP_HALT] = &&L_OP_HALT};
+#endif
+
+	const bc_insn_t* pc = bc->code.buffer;
+	error_t error = 0;
+
+	if (verbose) interp_trace_(bc, pc, 0);
+
+	INTERP_LOOP_BEGIN
+
+	INTERP_CASE(OP_LOAD):
+		error = interp_load_(ip, pc, bytecode_str(bc, pc));
+		INTERP_NEXT();
+	INTERP_CASE(OP_SAVE):
+		error = interp_save_(ip, pc, bytecode_str(bc, pc));
+		INTERP_NEXT();
+	INTERP_CASE(OP_RAND):
+		error = interp_rand_(ip, pc);
+		INTERP_NEXT();
+	INTERP_CASE(OP_CONCAT):
+		error = interp_concat_(ip, pc);
+		INTERP_NEXT();
+	INTERP_CASE(OP_FREE):
+		error = interp_free_(ip, pc);
+		INTERP_NEXT();
+	INTERP_CASE(OP_REMOVE):
+		error = interp_remove_(ip, pc);
+		INTERP_NEXT();
+	INTERP_CASE(OP_COPY):
+		error = interp_copy_(ip, pc);
+		INTERP_NEXT();
+	INTERP_CASE(OP_SORT):
+		error = interp_sort_(ip, pc);
+		INTERP_NEXT();
+	INTERP_CASE(OP_SHUFFLE):
+		error = interp_shuffle_(ip, pc);
+		INTERP_NEXT();
+	INTERP_CASE(OP_STATS):
+		error = interp_stats_(ip, pc, stdout);
+		INTERP_NEXT();
+	INTERP_CASE(OP_PRINT):
+		error = interp_print_(ip, pc, bytecode_str(bc, pc), stdout);
+		INTERP_NEXT();
+	INTERP_CASE(OP_HALT):
+		return 0;
 
-	if (insn_argc(insn) == 2) {
-		const char* arg = insn_arg(insn, 1);
-		if (stricmp(arg, "all") == 0) {
-			// Special case, because (0 - 1) in an ulong is UB.
-			if (vector_i64_is_empty(array)) {
-				printf("<empty array>\n");
-			} else {
-				error = print_range_(array, 0, vector_i64_size(array) - 1);
-			}
-		} else {
-			size_t i;
-			if ((error = str_to_ulong(arg, &i))) {
-				fprintf(stderr, "Invalid `from` index.\n");
-				return error;
-			}
-			// Only print this element.
-			error = print_range_(array, i, i);
-		}
-	} else /* argc == 3 */ {
-		size_t from, to;
-		if ((error = str_to_ulong(insn_arg(insn, 1), &from)) ||
-		    (error = str_to_ulong(insn_arg(insn, 2), &to))) {
-			fprintf(stderr, "Invalid range.\n");
-			return error;
-		}
-		error = print_range_(array, from, to);
-	}
+	INTERP_LOOP_END
 
+fail:
+	interp_report(pc, (size_t)(pc - bc->code.buffer), error);
 	return error;
 }
 
-error_t interp_run(interp_t* ip, const vector_insn_t* insns) {
-	if (!ip || !insns) return ERROR_INVALID_PARAMETER;
+#if INTERP_THREADED
+#pragma GCC diagnostic pop
+#endif
 
-	for (size_t i = 0; i != vector_insn_size(insns); ++i) {
-		insn_t* insn = vector_insn_get(insns, i);
-		error_t error;
+error_t interp_run_stream(interp_t* ip, FILE* stream, bool verbose) {
+	if (!ip || !stream) return ERROR_INVALID_PARAMETER;
 
-		string_t dbgInsn;
-		if ((error = insn_to_string(insn, &dbgInsn))) {
-			return error;
+	// Holds the instruction being run only.
+	bytecode_t bc = bytecode_create();
+	error_t error = 0;
+
+	for (size_t bci = 0; !error; ++bci) {
+		insn_t insn;
+		if ((error = insn_parse_next(stream, &insn))) {
+			error_fmt_t fmt[] = {&insn_parser_error_to_string};
+			error_print_ex(error, fmt, sizeof(fmt) / sizeof(fmt[0]));
+			break;
 		}
-		printf(
-		    "> [bci %zu]\n"
-		    ">   %s\n",
-		    i, string_to_c_str(&dbgInsn));
-		string_destroy(&dbgInsn);
-
-		switch (insn->op) {
-			case OP_LOAD:
-				error = interp_load_(ip, insn);
-				break;
-			case OP_SAVE:
-				error = interp_save_(ip, insn);
-				break;
-			case OP_RAND:
-				error = interp_rand_(ip, insn);
-				break;
-			case OP_CONCAT:
-				error = interp_concat_(ip, insn);
-				break;
-			case OP_FREE:
-				error = interp_free_(ip, insn);
-				break;
-			case OP_REMOVE:
-				error = interp_remove_(ip, insn);
-				break;
-			case OP_COPY:
-				error = interp_copy_(ip, insn);
-				break;
-			case OP_SORT:
-				error = interp_sort_(ip, insn);
-				break;
-			case OP_SHUFFLE:
-				error = interp_shuffle_(ip, insn);
-				break;
-			case OP_STATS:
-				error = interp_stats_(ip, insn);
-				break;
-			case OP_PRINT:
-				error = interp_print_(ip, insn);
-				break;
-			default:
-				error = ERR_INVOP;
-				break;
+
+		if (insn.op == OP_HALT) {
+			insn_destroy(&insn);
+			break;
 		}
 
-		if (error) {
-			fprintf(stderr, "----------------------------------------------\n");
-			fprintf(stderr, "While executing instruction %s (bci = %zu):\n",
-			        opcode_to_string(insn->op), i);
+		error = bytecode_compile_insn(&bc, &insn);
+		if (error) bytecode_report(&insn, bci, error);
 
-			error_fmt_t fmt[] = {&interp_error_to_string};
-			error_print_ex(error, fmt, sizeof(fmt) / sizeof(fmt[0]));
+		insn_destroy(&insn);
+		if (error) break;
 
-			return error;
+		const bc_insn_t* pc = vector_bc_insn_get(&bc.code, 0);
+		if (verbose) interp_trace_(&bc, pc, bci);
+
+		if ((error = interp_exec(ip, &bc, pc, stdout))) {
+			interp_report(pc, bci, error);
 		}
+
+		// Show the output before blocking on the next instruction.
+		fflush(stdout);
+		bytecode_clear(&bc);
 	}
 
-	return 0;
+	bytecode_destroy(&bc);
+	return error;
 }
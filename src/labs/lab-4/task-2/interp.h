@@ -1,8 +1,12 @@
 #pragma once
 
+#include <stdio.h>
+
+#include "array.h"
 #include "lib/collections/string.h"
 #include "lib/collections/vector.h"
 #include "lib/error.h"
+#include "lib/rng.h"
 
 #define ERR_INVARGCNT 0x20000001
 #define ERR_INVARRID 0x20000002
@@ -31,6 +35,8 @@ typedef enum opcode {
 	OP_SHUFFLE,
 	OP_STATS,
 	OP_PRINT,
+	/** Ends compiled code, never parsed. */
+	OP_HALT,
 	OP_INVALID
 } opcode_t;
 
@@ -55,12 +61,46 @@ const char* insn_arg(const insn_t* insn, size_t idx);
 
 size_t insn_argc(const insn_t* insn);
 
+/** Compiled program, see bytecode.h. */
+typedef struct bytecode bytecode_t;
+typedef struct bc_insn bc_insn_t;
+
 typedef struct interp {
-	vector_i64_t state[26];
+	/** Arrays A-Z, sharing items after COPY and CONCAT. */
+	array_t state[26];
+	/** Generator of SHUFFLE, seeded with the current time. */
+	rng_t rng;
+	/** Stream of RAND (see |rng_at|), drawn from |rng| on seeding. */
+	uint64_t randKey;
+	/** Items of the stream used by previous RANDs. */
+	uint64_t randCounter;
 } interp_t;
 
 interp_t interp_create(void);
 
+/** Reseeds the generators, making RAND and SHUFFLE reproducible. */
+void interp_seed(interp_t* ip, uint64_t seed);
+
 void interp_destroy(interp_t* ip);
 
-error_t interp_run(interp_t* ip, const vector_insn_t* insns);
+/**
+ * Runs compiled |bc| until `OP_HALT`. With |verbose|, traces every
+ * instruction to stdout before it runs.
+ */
+error_t interp_run(interp_t* ip, const bytecode_t* bc, bool verbose);
+
+/**
+ * Runs the single instruction |insn| of |bc|. PRINT and STATS write to |out|,
+ * errors are reported to stderr as they're found.
+ */
+error_t interp_exec(interp_t* ip, const bytecode_t* bc, const bc_insn_t* insn,
+                    FILE* out);
+
+/** Reports that |insn| at |bci| failed with |error| to stderr. */
+void interp_report(const bc_insn_t* insn, size_t bci, error_t error);
+
+/**
+ * Reads, compiles and runs the instructions of |stream| one at a time, as
+ * they arrive, so memory doesn't grow with the length of the script.
+ */
+error_t interp_run_stream(interp_t* ip, FILE* stream, bool verbose);
@@ -1,8 +1,13 @@
+#include <string.h>
+
+#include "bytecode.h"
 #include "insn_parser.h"
 #include "interp.h"
+#include "lib/convert.h"
+#include "scheduler.h"
 
-error_t main_clean(error_t errcode, vector_insn_t* insns, interp_t* ip,
-                   FILE* stream) {
+error_t main_clean(error_t errcode, vector_insn_t* insns, bytecode_t* bc,
+                   interp_t* ip, FILE* stream) {
 	if (insns) {
 		for (size_t i = 0; i != vector_insn_size(insns); ++i) {
 			insn_destroy(vector_insn_get(insns, i));
@@ -10,6 +15,10 @@ error_t main_clean(error_t errcode, vector_insn_t* insns, interp_t* ip,
 		vector_insn_destroy(insns);
 	}
 
+	if (bc) {
+		bytecode_destroy(bc);
+	}
+
 	if (ip) {
 		interp_destroy(ip);
 	}
@@ -18,37 +27,92 @@ error_t main_clean(error_t errcode, vector_insn_t* insns, interp_t* ip,
 	return errcode;
 }
 
-int main(void) {
+int main(int argc, char** argv) {
 	error_t error;
 
-	FILE* cmds = fopen("cmds.txt", "r");
+	// <prog> [-v] [-s <seed>] [-j <threads>] [commands file | -]
+	bool verbose = false;
+	bool seeded = false;
+	unsigned long seed;
+	unsigned long threads = 1;
+	const char* path = "cmds.txt";
+
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-v") == 0) {
+			verbose = true;
+		} else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+			if (str_to_ulong(argv[++i], &seed)) {
+				fprintf(stderr, "Invalid `seed`: malformed number.\n");
+				return 1;
+			}
+			seeded = true;
+		} else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			if (str_to_ulong(argv[++i], &threads) || threads == 0) {
+				fprintf(stderr, "Invalid `threads`: malformed number.\n");
+				return 1;
+			}
+		} else {
+			path = argv[i];
+		}
+	}
+
+	// "-" runs instructions from stdin as they arrive.
+	if (strcmp(path, "-") == 0) {
+		interp_t ip = interp_create();
+		if (seeded) interp_seed(&ip, seed);
+
+		error = interp_run_stream(&ip, stdin, verbose);
+
+		interp_destroy(&ip);
+		return error;
+	}
+
+	FILE* cmds = fopen(path, "r");
 	if (!cmds) {
-		fprintf(stderr, "Can't open cmds.txt for reading.\n");
+		fprintf(stderr, "Can't open %s for reading.\n", path);
 		return 1;
 	}
 
 	vector_insn_t insns;
+	bytecode_t bc = bytecode_create();
 	interp_t ip = interp_create();
 
+	if (seeded) interp_seed(&ip, seed);
+
 	if ((error = insn_parse_stream(&insns, cmds))) {
-		error_print(error);
-		return main_clean(error, &insns, &ip, cmds);
+		error_fmt_t fmt[] = {&insn_parser_error_to_string};
+		error_print_ex(error, fmt, sizeof(fmt) / sizeof(fmt[0]));
+		return main_clean(error, &insns, &bc, &ip, cmds);
 	}
 
-	printf("[debug] Parsed instruction list:\n");
+	if (verbose) {
+		printf("[debug] Parsed instruction list:\n");
 
-	for (size_t i = 0; i != vector_insn_size(&insns); ++i) {
-		string_t string;
-		if ((error = insn_to_string(vector_insn_get(&insns, i), &string))) {
-			return main_clean(error, &insns, &ip, cmds);
+		for (size_t i = 0; i != vector_insn_size(&insns); ++i) {
+			string_t string;
+			if ((error =
+			         insn_to_string(vector_insn_get(&insns, i), &string))) {
+				return main_clean(error, &insns, &bc, &ip, cmds);
+			}
+			printf("  %s\n", string_to_c_str(&string));
+			string_destroy(&string);
 		}
-		printf("  %s\n", string_to_c_str(&string));
-		string_destroy(&string);
 	}
 
-	if ((error = interp_run(&ip, &insns))) {
-		return main_clean(error, &insns, &ip, cmds);
+	if ((error = bytecode_compile(&insns, &bc))) {
+		return main_clean(error, &insns, &bc, &ip, cmds);
+	}
+
+	// Tracing needs the instructions to run one by one.
+	if (threads > 1 && !verbose) {
+		error = sched_run(&ip, &bc, threads);
+	} else {
+		error = interp_run(&ip, &bc, verbose);
+	}
+
+	if (error) {
+		return main_clean(error, &insns, &bc, &ip, cmds);
 	}
 
-	return main_clean(0, &insns, &ip, cmds);
+	return main_clean(0, &insns, &bc, &ip, cmds);
 }
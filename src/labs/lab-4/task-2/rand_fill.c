@@ -0,0 +1,97 @@
+#include "rand_fill.h"
+
+#include <pthread.h>
+
+#include "lib/rng.h"
+#include "shuffle.h"
+
+const size_t RAND_FILL_PARALLEL_THRESHOLD = 1 << 20;
+
+/** Items generated at once, before they're scaled to the range. */
+#define RAND_FILL_BLOCK 256
+
+#define RAND_FILL_MAX_THREADS 64
+
+void rand_fill_i64_serial(int64_t* data, size_t n, int64_t lb, int64_t ub,
+                          uint64_t key, uint64_t counter) {
+	// Wraps to 0 for the whole range of |int64_t|, see |rng_scale|.
+	uint64_t span = (uint64_t)ub - (uint64_t)lb + 1;
+	uint64_t block[RAND_FILL_BLOCK];
+
+	for (size_t i = 0; i < n; i += RAND_FILL_BLOCK) {
+		size_t size = n - i < RAND_FILL_BLOCK ? n - i : RAND_FILL_BLOCK;
+
+		// Items are independent, and generating them apart from scaling
+		// keeps both loops simple enough for the compiler to vectorize.
+		for (size_t j = 0; j != size; ++j) {
+			block[j] = rng_at(key, counter + i + j);
+		}
+
+		for (size_t j = 0; j != size; ++j) {
+			data[i + j] = (int64_t)((uint64_t)lb + rng_scale(block[j], span));
+		}
+	}
+}
+
+typedef struct rand_fill_job {
+	int64_t* data;
+	size_t n;
+	int64_t lb;
+	int64_t ub;
+	uint64_t key;
+	uint64_t counter;
+} rand_fill_job_t;
+
+static void* rand_fill_worker(void* arg) {
+	const rand_fill_job_t* job = (const rand_fill_job_t*)arg;
+
+	rand_fill_i64_serial(job->data, job->n, job->lb, job->ub, job->key,
+	                     job->counter);
+	return NULL;
+}
+
+bool rand_fill_i64_parallel(int64_t* data, size_t n, int64_t lb, int64_t ub,
+                            uint64_t key, uint64_t counter,
+                            size_t threadCount) {
+	if (threadCount < 1 || threadCount > RAND_FILL_MAX_THREADS) return false;
+
+	pthread_t threads[RAND_FILL_MAX_THREADS];
+	rand_fill_job_t jobs[RAND_FILL_MAX_THREADS];
+	bool started[RAND_FILL_MAX_THREADS];
+
+	for (size_t t = 0; t != threadCount; ++t) {
+		size_t from = n * t / threadCount;
+		size_t to = n * (t + 1) / threadCount;
+
+		jobs[t] = (rand_fill_job_t){.data = data + from,
+		                            .n = to - from,
+		                            .lb = lb,
+		                            .ub = ub,
+		                            .key = key,
+		                            .counter = counter + from};
+		started[t] = pthread_create(&threads[t], NULL, &rand_fill_worker,
+		                            &jobs[t]) == 0;
+	}
+
+	// Chunks whose thread couldn't be started are filled here.
+	for (size_t t = 0; t != threadCount; ++t) {
+		if (started[t]) {
+			pthread_join(threads[t], NULL);
+		} else {
+			rand_fill_worker(&jobs[t]);
+		}
+	}
+
+	return true;
+}
+
+void rand_fill_i64(int64_t* data, size_t n, int64_t lb, int64_t ub,
+                   uint64_t key, uint64_t counter) {
+	if (n >= RAND_FILL_PARALLEL_THRESHOLD && shuffle_thread_count() > 1 &&
+	    rand_fill_i64_parallel(data, n, lb, ub, key, counter,
+	                           shuffle_thread_count())) {
+		return;
+	}
+
+	rand_fill_i64_serial(data, n, lb, ub, key, counter);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Arrays of at least this many items are filled by several threads. */
+extern const size_t RAND_FILL_PARALLEL_THRESHOLD;
+
+/**
+ * Fills |data| with integers in [|lb|; |ub|]: item `i` is derived from item
+ * |counter| + `i` of the stream at |key| (see |rng_at|). The result only
+ * depends on the arguments, not on how the work is split.
+ */
+void rand_fill_i64_serial(int64_t* data, size_t n, int64_t lb, int64_t ub,
+                          uint64_t key, uint64_t counter);
+
+/**
+ * Same as |rand_fill_i64_serial|, but every one of |threadCount| threads fills
+ * its own chunk of |data|.
+ *
+ * @return false if |threadCount| is out of range; |data| is left untouched
+ *         then.
+ */
+bool rand_fill_i64_parallel(int64_t* data, size_t n, int64_t lb, int64_t ub,
+                            uint64_t key, uint64_t counter,
+                            size_t threadCount);
+
+/** Fills |data|, picking the amount of threads by its size. */
+void rand_fill_i64(int64_t* data, size_t n, int64_t lb, int64_t ub,
+                   uint64_t key, uint64_t counter);
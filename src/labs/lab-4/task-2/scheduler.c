@@ -0,0 +1,338 @@
+#include "scheduler.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Resources besides arrays A-Z, which are numbered 0-25. */
+enum {
+	/** |interp_t.randCounter|, used by RAND. */
+	SCHED_RES_RAND = 26,
+	/** |interp_t.rng|, used by SHUFFLE. */
+	SCHED_RES_RNG,
+	SCHED_RES_COUNT
+};
+
+typedef struct sched_node {
+	/** Masks of the resources the instruction uses. */
+	uint32_t reads;
+	uint32_t writes;
+	/** Runs after every instruction before it and before every one after. */
+	bool barrier;
+	/** Instructions waiting for this one. */
+	vector_u32_t next;
+	/** Unfinished instructions this one waits for. */
+	size_t pending;
+	bool done;
+	error_t error;
+	/** What PRINT and STATS printed, flushed in program order. */
+	char* output;
+	size_t outputSize;
+} sched_node_t;
+
+typedef struct sched {
+	interp_t* ip;
+	const bytecode_t* bc;
+	/** One node per instruction, without the final `OP_HALT`. */
+	sched_node_t* nodes;
+	size_t count;
+
+	pthread_mutex_t lock;
+	/** Signalled when |ready| grows or the run is stopping. */
+	pthread_cond_t readyChanged;
+	/** Signalled when an instruction is done. */
+	pthread_cond_t nodeDone;
+
+	/** Instructions whose dependencies are done; each is queued once. */
+	size_t* ready;
+	size_t readyHead;
+	size_t readyTail;
+
+	/** The first failed instruction; the ones after it don't start. */
+	size_t failedAt;
+	bool stopping;
+} sched_t;
+
+static void sched_resources_(const bc_insn_t* insn, sched_node_t* node) {
+	uint32_t dst = UINT32_C(1) << insn->dst;
+	uint32_t src = UINT32_C(1) << insn->src;
+
+	switch ((opcode_t)insn->op) {
+		case OP_SAVE:
+			node->reads = dst;
+			node->barrier = true;
+			break;
+		case OP_PRINT:
+			node->reads = dst;
+			node->barrier = insn->str != BC_NO_STR;
+			break;
+		case OP_CONCAT:
+		case OP_COPY:
+			node->reads = src;
+			node->writes = dst;
+			break;
+		case OP_RAND:
+			node->writes = dst | UINT32_C(1) << SCHED_RES_RAND;
+			break;
+		case OP_SHUFFLE:
+			node->writes = dst | UINT32_C(1) << SCHED_RES_RNG;
+			break;
+		default:
+			// STATS too, as it may copy the array into one buffer.
+			node->writes = dst;
+			break;
+	}
+}
+
+/**
+ * Makes |to| wait for |from|. |linked| remembers the last instruction every
+ * instruction was linked to, so no edge is added twice.
+ */
+static bool sched_link_(sched_t* s, size_t from, size_t to, size_t* linked) {
+	if (linked[from] == to) return true;
+	linked[from] = to;
+
+	if (!vector_u32_push_back(&s->nodes[from].next, (uint32_t)to)) {
+		return false;
+	}
+
+	s->nodes[to].pending++;
+	return true;
+}
+
+/** Builds the dependency graph of the instructions. */
+static error_t sched_build_(sched_t* s) {
+	size_t lastWriter[SCHED_RES_COUNT];
+	vector_u32_t readers[SCHED_RES_COUNT];
+	size_t lastBarrier = SIZE_MAX;
+
+	size_t* linked = (size_t*)malloc(s->count * sizeof(size_t));
+	if (!linked) return ERROR_OUT_OF_MEMORY;
+
+	for (size_t r = 0; r != SCHED_RES_COUNT; ++r) {
+		lastWriter[r] = SIZE_MAX;
+		readers[r] = vector_u32_create();
+	}
+
+	bool linkedAll = true;
+
+	for (size_t j = 0; linkedAll && j != s->count; ++j) {
+		sched_node_t* node = &s->nodes[j];
+		linked[j] = SIZE_MAX;
+
+		sched_resources_(vector_bc_insn_get(&s->bc->code, j), node);
+
+		if (node->barrier) {
+			size_t since = lastBarrier == SIZE_MAX ? 0 : lastBarrier;
+			for (size_t i = since; linkedAll && i != j; ++i) {
+				linkedAll = sched_link_(s, i, j, linked);
+			}
+		} else if (lastBarrier != SIZE_MAX) {
+			linkedAll = sched_link_(s, lastBarrier, j, linked);
+		}
+
+		for (size_t r = 0; linkedAll && r != SCHED_RES_COUNT; ++r) {
+			uint32_t bit = UINT32_C(1) << r;
+			if (!((node->reads | node->writes) & bit)) continue;
+
+			if (lastWriter[r] != SIZE_MAX) {
+				linkedAll = sched_link_(s, lastWriter[r], j, linked);
+			}
+
+			if (node->writes & bit) {
+				// Readers may run together, but a writer waits for them.
+				for (size_t k = 0; linkedAll && k != readers[r].size; ++k) {
+					linkedAll = sched_link_(s, readers[r].buffer[k], j, linked);
+				}
+
+				lastWriter[r] = j;
+				readers[r].size = 0;
+			} else {
+				linkedAll = vector_u32_push_back(&readers[r], (uint32_t)j);
+			}
+		}
+
+		if (node->barrier) lastBarrier = j;
+	}
+
+	for (size_t r = 0; r != SCHED_RES_COUNT; ++r) {
+		vector_u32_destroy(&readers[r]);
+	}
+	free(linked);
+
+	return linkedAll ? 0 : ERROR_OUT_OF_MEMORY;
+}
+
+static error_t sched_exec_(sched_t* s, size_t j) {
+	sched_node_t* node = &s->nodes[j];
+	const bc_insn_t* insn = vector_bc_insn_get(&s->bc->code, j);
+
+	// PRINT into a file writes it directly.
+	bool buffered = insn->op == OP_STATS ||
+	                (insn->op == OP_PRINT && insn->str == BC_NO_STR);
+	if (!buffered) {
+		return interp_exec(s->ip, s->bc, insn, stdout);
+	}
+
+	FILE* out = open_memstream(&node->output, &node->outputSize);
+	if (!out) return ERROR_OUT_OF_MEMORY;
+
+	error_t error = interp_exec(s->ip, s->bc, insn, out);
+	if (fclose(out) != 0 && !error) error = ERROR_OUT_OF_MEMORY;
+
+	return error;
+}
+
+/** Marks |j| done and queues the instructions it held. Locked. */
+static void sched_finish_(sched_t* s, size_t j, error_t error) {
+	sched_node_t* node = &s->nodes[j];
+
+	node->done = true;
+	node->error = error;
+	if (error && j < s->failedAt) s->failedAt = j;
+
+	for (size_t k = 0; k != node->next.size; ++k) {
+		size_t next = node->next.buffer[k];
+		if (--s->nodes[next].pending == 0) s->ready[s->readyTail++] = next;
+	}
+
+	pthread_cond_broadcast(&s->readyChanged);
+	pthread_cond_signal(&s->nodeDone);
+}
+
+static void* sched_worker_(void* arg) {
+	sched_t* s = (sched_t*)arg;
+
+	pthread_mutex_lock(&s->lock);
+
+	for (;;) {
+		while (!s->stopping && s->readyHead == s->readyTail) {
+			pthread_cond_wait(&s->readyChanged, &s->lock);
+		}
+		if (s->stopping) break;
+
+		size_t j = s->ready[s->readyHead++];
+		if (j > s->failedAt) continue;
+
+		pthread_mutex_unlock(&s->lock);
+		error_t error = sched_exec_(s, j);
+		pthread_mutex_lock(&s->lock);
+
+		sched_finish_(s, j, error);
+	}
+
+	pthread_mutex_unlock(&s->lock);
+	return NULL;
+}
+
+static void sched_destroy_(sched_t* s) {
+	if (s->nodes) {
+		for (size_t i = 0; i != s->count; ++i) {
+			vector_u32_destroy(&s->nodes[i].next);
+			free(s->nodes[i].output);
+		}
+	}
+
+	free(s->nodes);
+	free(s->ready);
+
+	pthread_cond_destroy(&s->nodeDone);
+	pthread_cond_destroy(&s->readyChanged);
+	pthread_mutex_destroy(&s->lock);
+}
+
+static error_t sched_create_(sched_t* s, interp_t* ip, const bytecode_t* bc) {
+	*s = (sched_t){.ip = ip,
+	               .bc = bc,
+	               .count = vector_bc_insn_size(&bc->code) - 1,
+	               .failedAt = SIZE_MAX};
+
+	pthread_mutex_init(&s->lock, NULL);
+	pthread_cond_init(&s->readyChanged, NULL);
+	pthread_cond_init(&s->nodeDone, NULL);
+
+	if (s->count > UINT32_MAX) return ERROR_OVERFLOW;
+
+	s->nodes = (sched_node_t*)calloc(s->count, sizeof(sched_node_t));
+	s->ready = (size_t*)malloc(s->count * sizeof(size_t));
+	if (!s->nodes || !s->ready) return ERROR_OUT_OF_MEMORY;
+
+	for (size_t i = 0; i != s->count; ++i) {
+		s->nodes[i].next = vector_u32_create();
+	}
+
+	error_t error = sched_build_(s);
+	if (error) return error;
+
+	for (size_t i = 0; i != s->count; ++i) {
+		if (!s->nodes[i].pending) s->ready[s->readyTail++] = i;
+	}
+
+	return 0;
+}
+
+error_t sched_run(interp_t* ip, const bytecode_t* bc, size_t threadCount) {
+	if (!ip || !bc || vector_bc_insn_is_empty(&bc->code) || !threadCount) {
+		return ERROR_INVALID_PARAMETER;
+	}
+
+	// Nothing but `OP_HALT`.
+	if (vector_bc_insn_size(&bc->code) == 1) return 0;
+
+	if (threadCount > SCHED_MAX_THREADS) threadCount = SCHED_MAX_THREADS;
+
+	sched_t s;
+	error_t error = sched_create_(&s, ip, bc);
+	if (error) {
+		sched_destroy_(&s);
+		return error;
+	}
+
+	pthread_t threads[SCHED_MAX_THREADS];
+	size_t started = 0;
+
+	for (size_t i = 0; i != threadCount; ++i) {
+		if (pthread_create(&threads[started], NULL, sched_worker_, &s) == 0) {
+			++started;
+		}
+	}
+
+	if (!started) {
+		// Nothing has run yet, so the instructions can run one by one.
+		sched_destroy_(&s);
+		return interp_run(ip, bc, false);
+	}
+
+	// Retire the instructions in program order, flushing their output.
+	for (size_t i = 0; !error && i != s.count; ++i) {
+		sched_node_t* node = &s.nodes[i];
+
+		pthread_mutex_lock(&s.lock);
+		while (!node->done) pthread_cond_wait(&s.nodeDone, &s.lock);
+		pthread_mutex_unlock(&s.lock);
+
+		if (node->output) {
+			fwrite(node->output, 1, node->outputSize, stdout);
+			free(node->output);
+			node->output = NULL;
+		}
+
+		if ((error = node->error)) {
+			interp_report(vector_bc_insn_get(&bc->code, i), i, error);
+		}
+	}
+
+	pthread_mutex_lock(&s.lock);
+	s.stopping = true;
+	pthread_cond_broadcast(&s.readyChanged);
+	pthread_mutex_unlock(&s.lock);
+
+	for (size_t i = 0; i != started; ++i) {
+		pthread_join(threads[i], NULL);
+	}
+
+	sched_destroy_(&s);
+	return error;
+}
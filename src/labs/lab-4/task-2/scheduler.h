@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "bytecode.h"
+#include "interp.h"
+#include "lib/error.h"
+
+/** Most worker threads |sched_run| starts. */
+#define SCHED_MAX_THREADS 64
+
+/**
+ * Runs compiled |bc| like |interp_run|, but on |threadCount| worker threads:
+ * an instruction starts as soon as the instructions before it that use the
+ * same arrays are done, so instructions on different arrays run at the same
+ * time.
+ *
+ * The output is the same as with |interp_run|: PRINT and STATS write into
+ * buffers that are flushed in program order, and execution stops at the
+ * first failing instruction. SAVE and PRINT into a file wait for everything
+ * before them and hold off everything after them, so no file is written
+ * past a failure. Messages on stderr from instructions that run after a
+ * failing one may still show up.
+ */
+error_t sched_run(interp_t* ip, const bytecode_t* bc, size_t threadCount);
@@ -0,0 +1,197 @@
+#include "shuffle.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+const size_t SHUFFLE_PARALLEL_THRESHOLD = 1 << 22;
+
+/** Buckets are numbered with a byte, see |shuffle_job_t.labels|. */
+#define SHUFFLE_MAX_THREADS 64
+
+void shuffle_i64_fisher_yates(int64_t* data, size_t n, rng_t* rng) {
+	for (size_t i = n; i > 1; --i) {
+		size_t j = (size_t)rng_below(rng, i);
+
+		int64_t temp = data[i - 1];
+		data[i - 1] = data[j];
+		data[j] = temp;
+	}
+}
+
+typedef enum shuffle_phase {
+	/** Draw a bucket for every item of the chunk and count them. */
+	SHUFFLE_LABEL,
+	/** Move the items of the chunk into their buckets. */
+	SHUFFLE_SCATTER,
+	/** Shuffle a bucket and move it back. */
+	SHUFFLE_BUCKET
+} shuffle_phase_t;
+
+typedef struct shuffle_job {
+	int64_t* data;
+	int64_t* scratch;
+	uint8_t* labels;
+	size_t n;
+	size_t threadCount;
+	/** counts[thread][bucket], turned into offsets before scattering. */
+	size_t (*counts)[SHUFFLE_MAX_THREADS];
+	/** Generators, 2 per thread: for labeling and for shuffling a bucket. */
+	rng_t* rngs;
+	shuffle_phase_t phase;
+} shuffle_job_t;
+
+typedef struct shuffle_worker {
+	shuffle_job_t* job;
+	size_t idx;
+} shuffle_worker_t;
+
+static void* shuffle_worker(void* arg) {
+	const shuffle_worker_t* worker = (const shuffle_worker_t*)arg;
+	shuffle_job_t* job = worker->job;
+	size_t t = worker->idx;
+
+	size_t from = job->n * t / job->threadCount;
+	size_t to = job->n * (t + 1) / job->threadCount;
+
+	switch (job->phase) {
+		case SHUFFLE_LABEL: {
+			rng_t* rng = &job->rngs[t];
+			size_t* counts = job->counts[t];
+
+			for (size_t i = from; i != to; ++i) {
+				uint8_t bucket = (uint8_t)rng_below(rng, job->threadCount);
+				job->labels[i] = bucket;
+				++counts[bucket];
+			}
+			break;
+		}
+		case SHUFFLE_SCATTER: {
+			size_t* offsets = job->counts[t];
+
+			for (size_t i = from; i != to; ++i) {
+				job->scratch[offsets[job->labels[i]]++] = job->data[i];
+			}
+			break;
+		}
+		case SHUFFLE_BUCKET: {
+			// After scattering, the last thread's offsets are the bucket ends.
+			size_t end = job->counts[job->threadCount - 1][t];
+			size_t begin = t ? job->counts[job->threadCount - 1][t - 1] : 0;
+
+			shuffle_i64_fisher_yates(job->scratch + begin, end - begin,
+			                         &job->rngs[job->threadCount + t]);
+			memcpy(job->data + begin, job->scratch + begin,
+			       (end - begin) * sizeof(int64_t));
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Runs the current phase of |job| on all of its threads. Workers whose
+ * thread can't be started run on the calling thread instead.
+ */
+static void shuffle_run_phase(shuffle_job_t* job, pthread_t* threads,
+                              shuffle_worker_t* workers) {
+	bool started[SHUFFLE_MAX_THREADS];
+
+	for (size_t t = 0; t != job->threadCount; ++t) {
+		started[t] = pthread_create(&threads[t], NULL, &shuffle_worker,
+		                            &workers[t]) == 0;
+	}
+
+	for (size_t t = 0; t != job->threadCount; ++t) {
+		if (started[t]) {
+			pthread_join(threads[t], NULL);
+		} else {
+			shuffle_worker(&workers[t]);
+		}
+	}
+}
+
+bool shuffle_i64_parallel(int64_t* data, size_t n, uint64_t seed,
+                          size_t threadCount) {
+	if (threadCount < 1 || threadCount > SHUFFLE_MAX_THREADS) return false;
+
+	shuffle_job_t job = {.data = data,
+	                     .n = n,
+	                     .threadCount = threadCount,
+	                     .scratch = malloc(n * sizeof(int64_t)),
+	                     .labels = malloc(n * sizeof(uint8_t)),
+	                     .counts = calloc(threadCount,
+	                                     sizeof(size_t[SHUFFLE_MAX_THREADS])),
+	                     .rngs = malloc(2 * threadCount * sizeof(rng_t))};
+
+	if (!job.scratch || !job.labels || !job.counts || !job.rngs) {
+		free(job.scratch);
+		free(job.labels);
+		free(job.counts);
+		free(job.rngs);
+		return false;
+	}
+
+	pthread_t threads[SHUFFLE_MAX_THREADS];
+	shuffle_worker_t workers[SHUFFLE_MAX_THREADS];
+
+	// Non-overlapping streams: each generator is 2^128 steps ahead of the
+	// previous one.
+	rng_t rng = rng_create(seed);
+	for (size_t i = 0; i != 2 * threadCount; ++i) {
+		job.rngs[i] = rng;
+		rng_jump(&rng);
+	}
+
+	for (size_t t = 0; t != threadCount; ++t) {
+		workers[t] = (shuffle_worker_t){.job = &job, .idx = t};
+	}
+
+	job.phase = SHUFFLE_LABEL;
+	shuffle_run_phase(&job, threads, workers);
+
+	// Buckets are laid out one after another; within a bucket, chunks keep
+	// their order.
+	size_t offset = 0;
+	for (size_t b = 0; b != threadCount; ++b) {
+		for (size_t t = 0; t != threadCount; ++t) {
+			size_t count = job.counts[t][b];
+			job.counts[t][b] = offset;
+			offset += count;
+		}
+	}
+
+	job.phase = SHUFFLE_SCATTER;
+	shuffle_run_phase(&job, threads, workers);
+
+	job.phase = SHUFFLE_BUCKET;
+	shuffle_run_phase(&job, threads, workers);
+
+	free(job.scratch);
+	free(job.labels);
+	free(job.counts);
+	free(job.rngs);
+
+	return true;
+}
+
+size_t shuffle_thread_count(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	if (count < 1) return 1;
+	return count > SHUFFLE_MAX_THREADS ? SHUFFLE_MAX_THREADS : (size_t)count;
+#else
+	return 4;
+#endif
+}
+
+void shuffle_i64(int64_t* data, size_t n, rng_t* rng) {
+	if (n >= SHUFFLE_PARALLEL_THRESHOLD && shuffle_thread_count() > 1 &&
+	    shuffle_i64_parallel(data, n, rng_next(rng), shuffle_thread_count())) {
+		return;
+	}
+
+	shuffle_i64_fisher_yates(data, n, rng);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lib/rng.h"
+
+/** Arrays of at least this many items are shuffled by several threads. */
+extern const size_t SHUFFLE_PARALLEL_THRESHOLD;
+
+/** Shuffles |data| in place, drawing from |rng|. */
+void shuffle_i64_fisher_yates(int64_t* data, size_t n, rng_t* rng);
+
+/**
+ * Shuffles |data| with |threadCount| threads: every item is sent to a random
+ * bucket, then the buckets are shuffled independently. Every permutation is
+ * as likely as with |shuffle_i64_fisher_yates|.
+ *
+ * @return false if memory couldn't be allocated; |data| is left untouched
+ *         then.
+ */
+bool shuffle_i64_parallel(int64_t* data, size_t n, uint64_t seed,
+                          size_t threadCount);
+
+/** Amount of threads |shuffle_i64| uses for large arrays. */
+size_t shuffle_thread_count(void);
+
+/** Shuffles |data|, picking the algorithm by its size. */
+void shuffle_i64(int64_t* data, size_t n, rng_t* rng);
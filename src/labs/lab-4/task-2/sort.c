@@ -0,0 +1,54 @@
+#include "sort.h"
+
+#include <stdlib.h>
+
+#include "lib/collections/vector.h"
+
+int sort_i64_compare_ascending(const void* a, const void* b) {
+	int64_t x = *(const int64_t*)a, y = *(const int64_t*)b;
+	return (x > y) - (x < y);
+}
+
+int sort_i64_compare_descending(const void* a, const void* b) {
+	return sort_i64_compare_ascending(b, a);
+}
+
+void sort_i64_qsort(int64_t* data, size_t n, bool descending) {
+	qsort(data, n, sizeof(int64_t),
+	      descending ? &sort_i64_compare_descending
+	                 : &sort_i64_compare_ascending);
+}
+
+IMPL_VECTOR_SORT(int64_t, sort_i64_ascending, *a < *b)
+IMPL_VECTOR_SORT(int64_t, sort_i64_descending, *b < *a)
+
+void sort_i64_introsort(int64_t* data, size_t n, bool descending) {
+	if (descending) {
+		sort_i64_descending(data, n);
+	} else {
+		sort_i64_ascending(data, n);
+	}
+}
+
+/** Checks whether |data| is already sorted, which radix sort can't tell. */
+static bool sort_i64_in_order(const int64_t* data, size_t n, bool descending) {
+	for (size_t i = 1; i < n; ++i) {
+		if (descending ? data[i - 1] < data[i] : data[i - 1] > data[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void sort_i64(int64_t* data, size_t n, bool descending) {
+	if (sort_i64_in_order(data, n, descending)) return;
+
+	if (n >= VECTOR_RADIX_SORT_THRESHOLD &&
+	    vector_i64_radix_sort(data, n, descending)) {
+		return;
+	}
+
+	// Small arrays, or no memory for the radix sort's scratch buffer.
+	sort_i64_introsort(data, n, descending);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+int sort_i64_compare_ascending(const void* a, const void* b);
+
+int sort_i64_compare_descending(const void* a, const void* b);
+
+/** Sorts |data| with qsort. */
+void sort_i64_qsort(int64_t* data, size_t n, bool descending);
+
+/** Sorts |data| with an introsort that inlines the comparison. */
+void sort_i64_introsort(int64_t* data, size_t n, bool descending);
+
+/**
+ * Sorts |data|, picking the algorithm by its size: arrays of at least
+ * |VECTOR_RADIX_SORT_THRESHOLD| items are radix sorted.
+ */
+void sort_i64(int64_t* data, size_t n, bool descending);
@@ -0,0 +1,197 @@
+#include "stats.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+/** Items per block, small enough for the block to stay in L1 cache. */
+#define STATS_BLOCK 512
+
+/** Values are counted in a dense table if they span at most this many. */
+static const uint64_t STATS_DENSE_LIMIT = 1 << 22;
+
+static const size_t STATS_HASH_MIN_CAPACITY = 1024;
+
+/**
+ * Merges the extremes, mean and sum of squared deviations of every block.
+ * Within a block, each statistic is a plain loop over the items, which the
+ * compiler vectorizes; blocks are combined with Chan's formula.
+ */
+static void stats_moments(const int64_t* data, size_t n, stats_i64_t* out) {
+	int64_t min = data[0], max = data[0];
+	size_t minIdx = 0, maxIdx = 0;
+	double mean = 0, m2 = 0;
+
+	for (size_t from = 0; from < n; from += STATS_BLOCK) {
+		const int64_t* block = data + from;
+		size_t size = n - from < STATS_BLOCK ? n - from : STATS_BLOCK;
+
+		int64_t blockMin = block[0], blockMax = block[0];
+		double sum = 0;
+
+		for (size_t i = 0; i != size; ++i) {
+			blockMin = block[i] < blockMin ? block[i] : blockMin;
+			blockMax = block[i] > blockMax ? block[i] : blockMax;
+			sum += (double)block[i];
+		}
+
+		double blockMean = sum / (double)size;
+		double blockM2 = 0;
+
+		for (size_t i = 0; i != size; ++i) {
+			double d = (double)block[i] - blockMean;
+			blockM2 += d * d;
+		}
+
+		// Locating the first occurrence is only needed when a block holds a
+		// new extreme, which is rare past the first blocks.
+		if (blockMin < min) {
+			min = blockMin;
+			minIdx = from;
+			while (data[minIdx] != min) ++minIdx;
+		}
+		if (blockMax > max) {
+			max = blockMax;
+			maxIdx = from;
+			while (data[maxIdx] != max) ++maxIdx;
+		}
+
+		double count = (double)from, total = (double)(from + size);
+		double delta = blockMean - mean;
+
+		mean += delta * (double)size / total;
+		m2 += blockM2 + delta * delta * count * (double)size / total;
+	}
+
+	out->minIdx = minIdx;
+	out->maxIdx = maxIdx;
+	out->mean = mean;
+	out->stddev = sqrt(m2 / (double)n);
+}
+
+/** Picks the most frequent value of a dense table, the largest on ties. */
+static bool stats_mode_dense(const int64_t* data, size_t n, int64_t min,
+                             uint64_t range, int64_t* mode) {
+	uint64_t* counts = (uint64_t*)calloc(range, sizeof(uint64_t));
+	if (!counts) return false;
+
+	for (size_t i = 0; i != n; ++i) {
+		++counts[(uint64_t)data[i] - (uint64_t)min];
+	}
+
+	uint64_t best = 0;
+	for (uint64_t v = 1; v != range; ++v) {
+		if (counts[v] >= counts[best]) best = v;
+	}
+
+	*mode = (int64_t)((uint64_t)min + best);
+
+	free(counts);
+	return true;
+}
+
+typedef struct stats_hash {
+	int64_t* keys;
+	/** Zero marks an empty slot. */
+	uint64_t* counts;
+	size_t capacity;
+	size_t size;
+} stats_hash_t;
+
+static size_t stats_hash_slot(const stats_hash_t* table, int64_t key) {
+	size_t mask = table->capacity - 1;
+	size_t slot =
+	    (size_t)(((uint64_t)key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+
+	while (table->counts[slot] && table->keys[slot] != key) {
+		slot = (slot + 1) & mask;
+	}
+
+	return slot;
+}
+
+static bool stats_hash_init(stats_hash_t* table, size_t capacity) {
+	table->keys = (int64_t*)malloc(capacity * sizeof(int64_t));
+	table->counts = (uint64_t*)calloc(capacity, sizeof(uint64_t));
+	table->capacity = capacity;
+	table->size = 0;
+
+	if (!table->keys || !table->counts) {
+		free(table->keys);
+		free(table->counts);
+		return false;
+	}
+
+	return true;
+}
+
+static bool stats_hash_grow(stats_hash_t* table) {
+	stats_hash_t grown;
+	if (!stats_hash_init(&grown, table->capacity * 2)) return false;
+
+	for (size_t i = 0; i != table->capacity; ++i) {
+		if (!table->counts[i]) continue;
+
+		size_t slot = stats_hash_slot(&grown, table->keys[i]);
+		grown.keys[slot] = table->keys[i];
+		grown.counts[slot] = table->counts[i];
+	}
+
+	grown.size = table->size;
+
+	free(table->keys);
+	free(table->counts);
+	*table = grown;
+
+	return true;
+}
+
+static bool stats_mode_hash(const int64_t* data, size_t n, int64_t* mode) {
+	stats_hash_t table;
+	if (!stats_hash_init(&table, STATS_HASH_MIN_CAPACITY)) return false;
+
+	int64_t best = data[0];
+	uint64_t bestCount = 0;
+
+	for (size_t i = 0; i != n; ++i) {
+		// Keep the load factor at most 1/2.
+		if (table.size * 2 >= table.capacity && !stats_hash_grow(&table)) {
+			free(table.keys);
+			free(table.counts);
+			return false;
+		}
+
+		size_t slot = stats_hash_slot(&table, data[i]);
+		if (!table.counts[slot]) {
+			table.keys[slot] = data[i];
+			++table.size;
+		}
+
+		uint64_t count = ++table.counts[slot];
+		if (count > bestCount || (count == bestCount && data[i] > best)) {
+			best = data[i];
+			bestCount = count;
+		}
+	}
+
+	*mode = best;
+
+	free(table.keys);
+	free(table.counts);
+	return true;
+}
+
+bool stats_i64(const int64_t* data, size_t n, stats_i64_t* out) {
+	if (!data || !n || !out) return false;
+
+	stats_moments(data, n, out);
+
+	int64_t min = data[out->minIdx], max = data[out->maxIdx];
+	uint64_t range = (uint64_t)max - (uint64_t)min + 1;
+
+	// A dense table is cheaper than hashing unless it'd be mostly empty.
+	if (range != 0 && range <= STATS_DENSE_LIMIT && range <= 4 * (uint64_t)n) {
+		return stats_mode_dense(data, n, min, range, &out->mode);
+	}
+
+	return stats_mode_hash(data, n, &out->mode);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct stats_i64 {
+	/** First occurrences of the extremes. */
+	size_t minIdx;
+	size_t maxIdx;
+	double mean;
+	/** Population standard deviation. */
+	double stddev;
+	/** Most frequent value; the largest one on ties. */
+	int64_t mode;
+} stats_i64_t;
+
+/**
+ * Computes the statistics of a non-empty |data| without copying or sorting
+ * it: extremes, mean and variance are reduced over cache-sized blocks in a
+ * single pass, and the mode is counted in a table indexed by value when the
+ * values are dense, or in a hash table otherwise.
+ *
+ * @return false if the counting table couldn't be allocated.
+ */
+bool stats_i64(const int64_t* data, size_t n, stats_i64_t* out);
@@ -5,9 +5,6 @@ IMPL_VECTOR(vector_oper_t, oper_t, oper, {NULL})
 void oper_destroy(oper_t* oper) {
 	if (!oper) return;
 
-	free(oper->name);
-	oper->name = NULL;
-
 	oper->request = NULL;
 	oper->remainingTime = 0;
 }
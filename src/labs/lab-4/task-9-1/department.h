@@ -6,9 +6,12 @@
 #include "lib/collections/vector.h"
 #include "request.h"
 
+/** Length of an operator's name, excluding the null-terminator. */
+#define OPER_NAME_LENGTH 16
+
 typedef struct oper {
-	/** Name of the operator. */
-	const char* name;
+	/** Index of the operator's name in the model's name arena. */
+	size_t nameIdx;
 
 	/** Current request being handled.*/
 	request_t* request;
@@ -58,8 +58,8 @@ void dynamic_array_destroy(dynamic_array_t* array) {
 department_t* dynamic_array_get(const dynamic_array_t* array, const char* key) {
 	if (!array || !key || !array->size) return NULL;
 
-	size_t l = 0;
-	size_t r = array->size - 1;
+	ssize_t l = 0;
+	ssize_t r = (ssize_t)array->size - 1;
 
 	while (l <= r) {
 		size_t mid = (l + r) / 2;
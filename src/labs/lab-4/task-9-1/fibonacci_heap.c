@@ -79,10 +79,7 @@ static void node_destroy_all(fibonacci_node_t* node) {
 	do {
 		fibonacci_node_t* next = cur->right;
 
-		if (next != node) {
-			// if |next| == |node|, then |node| has already been freed.
-			node_destroy_all(next->child);
-		}
+		node_destroy_all(cur->child);
 		node_destroy(cur);
 
 		cur = next;
@@ -168,7 +165,9 @@ static fibonacci_node_t* node_dup(const fibonacci_node_t* start) {
 }
 
 static error_t consolidate(fibonacci_heap_t* heap) {
-	size_t D = (size_t)ceil(log2((double)heap->size + 1));
+	// The degree of a node is bounded by log_phi(n) = log2(n) / log2(phi),
+	// log2(phi) ~= 0.694.
+	size_t D = (size_t)(log2((double)heap->size + 1) / 0.694) + 2;
 
 	fibonacci_node_t** A =
 	    (fibonacci_node_t**)calloc(D, sizeof(fibonacci_node_t*));
@@ -213,8 +212,13 @@ static error_t consolidate(fibonacci_heap_t* heap) {
 		A[d] = x;
 	}
 
-	for (int i = 0; i != D; i++) {
-		if (A[i] && request_priority_cmp(A[i]->value, heap->max->value) > 0) {
+	// The old |max| may have been linked under another root, so pick the new
+	// one among the remaining roots only.
+	heap->max = NULL;
+
+	for (size_t i = 0; i != D; i++) {
+		if (A[i] && (!heap->max || request_priority_cmp(
+		                               A[i]->value, heap->max->value) > 0)) {
 			heap->max = A[i];
 		}
 	}
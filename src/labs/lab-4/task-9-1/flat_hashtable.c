@@ -0,0 +1,93 @@
+#include "flat_hashtable.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+IMPL_HASHMAP(flat_hashtable_map_t, strview_t, department_t*, dept,
+             strview_hash, strview_equals)
+
+// =============================================================================
+// VTable functions
+// =============================================================================
+
+static void* vt_create(void) { return (void*)flat_hashtable_create(); }
+
+static void vt_destroy(void* storage) {
+	flat_hashtable_destroy((flat_hashtable_t*)storage);
+}
+
+static department_t* vt_get(const void* storage, const char* key) {
+	return flat_hashtable_get((flat_hashtable_t*)storage, key);
+}
+
+static error_t vt_put(void* storage, const char* key, department_t* value) {
+	return flat_hashtable_put((flat_hashtable_t*)storage, key, value);
+}
+
+const storage_vtable_t FLAT_HASHTABLE_VTABLE = {&vt_create, &vt_destroy,
+                                                &vt_get, &vt_put};
+
+// =============================================================================
+// Storage implementation
+// =============================================================================
+
+flat_hashtable_t* flat_hashtable_create() {
+	flat_hashtable_t* ht = (flat_hashtable_t*)malloc(sizeof(flat_hashtable_t));
+	if (!ht) return NULL;
+
+	ht->map = hashmap_dept_create();
+	return ht;
+}
+
+void flat_hashtable_destroy(flat_hashtable_t* ht) {
+	if (!ht) return;
+
+	size_t cursor = 0;
+	strview_t key;
+
+	while (hashmap_dept_next(&ht->map, &cursor, &key, NULL)) {
+		free((char*)key.chars);
+	}
+
+	hashmap_dept_destroy(&ht->map);
+	free(ht);
+}
+
+department_t* flat_hashtable_get(const flat_hashtable_t* ht, const char* key) {
+	if (!ht || !key) return NULL;
+
+	department_t** value = hashmap_dept_get(&ht->map, strview_from_c_str(key));
+	return value ? *value : NULL;
+}
+
+error_t flat_hashtable_put(flat_hashtable_t* ht, const char* key,
+                           department_t* value) {
+	if (!ht || !key) return ERROR_INVALID_PARAMETER;
+
+	strview_t view = strview_from_c_str(key);
+	bool inserted;
+
+	hashmap_dept_slot_t* slot =
+	    hashmap_dept_get_or_put_slot(&ht->map, view, value, &inserted);
+	if (!slot) return ERROR_OUT_OF_MEMORY;
+
+	if (!inserted) {
+		slot->value = value;
+		return 0;
+	}
+
+	// The new entry still views |key|: point it at a copy the table owns.
+	char* copy = strdup(key);
+	if (!copy) {
+		hashmap_dept_remove(&ht->map, view, NULL);
+		return ERROR_OUT_OF_MEMORY;
+	}
+
+	slot->key.chars = copy;
+	return 0;
+}
+
+size_t flat_hashtable_size(const flat_hashtable_t* ht) {
+	return hashmap_dept_size(&ht->map);
+}
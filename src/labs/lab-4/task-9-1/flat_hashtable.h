@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "department.h"
+#include "lib/collections/hashmap.h"
+#include "lib/collections/string.h"
+#include "lib/error.h"
+#include "storage.h"
+
+extern const storage_vtable_t FLAT_HASHTABLE_VTABLE;
+
+/** Keys are views of copies that the table owns. */
+DEFINE_HASHMAP(flat_hashtable_map_t, strview_t, department_t*, dept)
+
+typedef struct flat_hashtable {
+	flat_hashtable_map_t map;
+} flat_hashtable_t;
+
+flat_hashtable_t* flat_hashtable_create();
+
+void flat_hashtable_destroy(flat_hashtable_t* ht);
+
+department_t* flat_hashtable_get(const flat_hashtable_t* ht, const char* key);
+
+error_t flat_hashtable_put(flat_hashtable_t* ht, const char* key,
+                           department_t* value);
+
+size_t flat_hashtable_size(const flat_hashtable_t* ht);
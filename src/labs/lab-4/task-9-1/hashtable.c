@@ -66,33 +66,38 @@ static hashtable_entry_t* create_entry(const char* key, department_t* value) {
 	return entry;
 }
 
-static error_t set_entry(hashtable_entry_t** table, size_t capacity,
-                         const char* key, department_t* value, size_t* size) {
-	if (!table || !key) return ERROR_INVALID_PARAMETER;
-
-	uint64_t hash = hash_fnv1a(key);
-	size_t index = hash % capacity;
-
-	hashtable_entry_t* entry = create_entry(key, value);
-	if (!entry) return ERROR_OUT_OF_MEMORY;
+/** Links |entry| into the chain of its bucket, before the head. */
+static void link_entry(hashtable_entry_t** table, size_t capacity,
+                       hashtable_entry_t* entry) {
+	size_t index = hash_fnv1a(entry->key) % capacity;
 
 	if (!table[index]) {
+		entry->prev = entry;
+		entry->next = entry;
 		table[index] = entry;
 	} else {
 		hashtable_entry_t* head = table[index];
-		hashtable_entry_t *prev0 = head->prev, *next0 = head->next;
+		hashtable_entry_t* tail = head->prev;
 
-		head->prev = entry;
 		entry->next = head;
-		entry->prev = prev0;
-		next0->next = entry;
+		entry->prev = tail;
+		tail->next = entry;
+		head->prev = entry;
 	}
+}
 
-	if (size) {
-		++(*size);
-	}
+static hashtable_entry_t* find_entry(hashtable_entry_t* const* table,
+                                     size_t capacity, const char* key) {
+	hashtable_entry_t* head = table[hash_fnv1a(key) % capacity];
+	if (!head) return NULL;
 
-	return 0;
+	hashtable_entry_t* cur = head;
+	do {
+		if (strcmp(cur->key, key) == 0) return cur;
+		cur = cur->next;
+	} while (cur != head);
+
+	return NULL;
 }
 
 // =============================================================================
@@ -103,7 +108,7 @@ hashtable_t* hashtable_create(size_t capacity, float loadFactor) {
 	hashtable_t* ht = (hashtable_t*)malloc(sizeof(hashtable_t));
 	if (!ht) return NULL;
 
-	ht->table = calloc(capacity, sizeof(hashtable_entry_t));
+	ht->table = calloc(capacity, sizeof(hashtable_entry_t*));
 	if (!ht->table) {
 		free(ht);
 		return NULL;
@@ -120,9 +125,17 @@ void hashtable_destroy(hashtable_t* ht) {
 	if (!ht) return;
 
 	for (size_t i = 0; i != ht->capacity; ++i) {
-		if (ht->table[i]) {
-			free(ht->table[i]->key);
-			free(ht->table[i]);
+		hashtable_entry_t* head = ht->table[i];
+		if (!head) continue;
+
+		// Break the cycle, then free the chain.
+		head->prev->next = NULL;
+
+		for (hashtable_entry_t* cur = head; cur;) {
+			hashtable_entry_t* next = cur->next;
+			free((char*)cur->key);
+			free(cur);
+			cur = next;
 		}
 	}
 
@@ -133,30 +146,23 @@ void hashtable_destroy(hashtable_t* ht) {
 department_t* hashtable_get(const hashtable_t* ht, const char* key) {
 	if (!ht || !key) return NULL;
 
-	uint64_t hash = hash_fnv1a(key);
-	size_t index = hash % ht->capacity;
-
-	const hashtable_entry_t* head = ht->table[index];
-	if (!head) return NULL;
-
-	const hashtable_entry_t* cur = head;
-	do {
-		if (strcmp(cur->key, key) == 0) {
-			return cur->value;
-		}
-		cur = cur->next;
-	} while (cur != head);
-
-	return NULL;
+	const hashtable_entry_t* entry = find_entry(ht->table, ht->capacity, key);
+	return entry ? entry->value : NULL;
 }
 
 error_t hashtable_put(hashtable_t* ht, const char* key, department_t* value) {
 	if (!ht || !key) return ERROR_INVALID_PARAMETER;
 
+	hashtable_entry_t* existing = find_entry(ht->table, ht->capacity, key);
+	if (existing) {
+		existing->value = value;
+		return 0;
+	}
+
 	float loadFactor = (float)ht->size / (float)ht->capacity;
 
 	if (loadFactor > ht->loadFactor) {
-		// Expand the hash table.
+		// Expand the hash table, moving the entries over.
 		size_t newCapacity = ht->capacity * 2;
 
 		hashtable_entry_t** newTable =
@@ -164,19 +170,16 @@ error_t hashtable_put(hashtable_t* ht, const char* key, department_t* value) {
 		if (!newTable) return ERROR_OUT_OF_MEMORY;
 
 		for (size_t i = 0; i != ht->capacity; ++i) {
-			const hashtable_entry_t* head = ht->table[i];
+			hashtable_entry_t* head = ht->table[i];
 			if (!head) continue;
 
-			const hashtable_entry_t* cur = head;
-			do {
-				error_t error = set_entry(newTable, newCapacity, cur->key,
-				                          cur->value, NULL);
-				if (error) {
-					free(newTable);
-					return error;
-				}
-				cur = cur->next;
-			} while (cur != head);
+			head->prev->next = NULL;
+
+			for (hashtable_entry_t* cur = head; cur;) {
+				hashtable_entry_t* next = cur->next;
+				link_entry(newTable, newCapacity, cur);
+				cur = next;
+			}
 		}
 
 		free(ht->table);
@@ -184,7 +187,13 @@ error_t hashtable_put(hashtable_t* ht, const char* key, department_t* value) {
 		ht->capacity = newCapacity;
 	}
 
-	return set_entry(ht->table, ht->capacity, key, value, &ht->size);
+	hashtable_entry_t* entry = create_entry(key, value);
+	if (!entry) return ERROR_OUT_OF_MEMORY;
+
+	link_entry(ht->table, ht->capacity, entry);
+	++ht->size;
+
+	return 0;
 }
 
 size_t hashtable_size(const hashtable_t* ht) { return ht->size; }
@@ -12,6 +12,8 @@
 const heap_vtable_t* HEAP_VTABLE_LOOKUP[] = {
     &BINARY_HEAP_VTABLE,  &BINOMIAL_HEAP_VTABLE, &FIBONACCI_HEAP_VTABLE,
     &LEFTIST_HEAP_VTABLE, &SKEW_HEAP_VTABLE,     &TREAP_VTABLE};
+const size_t HEAP_VTABLE_COUNT =
+    sizeof(HEAP_VTABLE_LOOKUP) / sizeof(HEAP_VTABLE_LOOKUP[0]);
 
 heap_t* heap_create(heap_type_t type) {
 	heap_t* heap = (heap_t*)malloc(sizeof(heap_t));
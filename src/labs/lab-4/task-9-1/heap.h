@@ -28,6 +28,7 @@ typedef struct heap_vtable {
 } heap_vtable_t;
 
 extern const heap_vtable_t* HEAP_VTABLE_LOOKUP[];
+extern const size_t HEAP_VTABLE_COUNT;
 
 typedef enum heap_type {
 	HEAP_BINARY,
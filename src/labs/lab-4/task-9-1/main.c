@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "heap.h"
 #include "lib/convert.h"
@@ -12,16 +13,12 @@ void app_error_print(error_t error) {
 }
 
 int cleanup(int exitCode, model_t* model, deque_request_t* requests,
-            FILE* logFile) {
-	while (!deque_request_is_empty(requests)) {
-		request_t request;
-		if (deque_request_pop_back(requests, &request)) {
-			request_destroy(&request);
-		}
-	}
+            request_arena_t* arena, FILE* logFile) {
+	if (model->heapTrace) fclose(model->heapTrace);
 
 	model_destroy(model);
 	deque_request_destroy(requests);
+	request_arena_destroy(arena);
 	fclose(logFile);
 
 	return exitCode;
@@ -30,8 +27,9 @@ int cleanup(int exitCode, model_t* model, deque_request_t* requests,
 int main(int argc, char* argv[]) {
 	error_t error;
 
-	model_t model = {.departments = NULL, .departmentMap = NULL};
+	model_t model = model_create();
 	deque_request_t requests = {.size = 0, .buffer = NULL};
+	request_arena_t arena = request_arena_create();
 
 	unsigned long maxPriority;
 
@@ -61,30 +59,30 @@ int main(int argc, char* argv[]) {
 
 	if (error) {
 		app_error_print(error);
-		return cleanup(3, &model, &requests, logFile);
+		return cleanup(3, &model, &requests, &arena, logFile);
 	}
 
 	error = model_init(&model);
 	if (error) {
 		app_error_print(error);
-		return cleanup(4, &model, &requests, logFile);
+		return cleanup(4, &model, &requests, &arena, logFile);
 	}
 
 	error = str_to_ulong(argv[2], &maxPriority);
 	if (error) {
 		app_error_print(error);
-		return cleanup(7, &model, &requests, logFile);
+		return cleanup(7, &model, &requests, &arena, logFile);
 	}
 	if (maxPriority > UINT32_MAX) {
 		fprintf(stderr, "Max priority out of range.\n");
-		return cleanup(8, &model, &requests, logFile);
+		return cleanup(8, &model, &requests, &arena, logFile);
 	}
 
 	size_t nRequestFiles = argc - 3;
 	FILE** requestFiles = (FILE**)calloc(nRequestFiles, sizeof(FILE*));
 
 	if (!requestFiles) {
-		return cleanup(5, &model, &requests, logFile);
+		return cleanup(5, &model, &requests, &arena, logFile);
 	}
 
 	for (size_t i = 0; i != nRequestFiles; ++i) {
@@ -98,12 +96,12 @@ int main(int argc, char* argv[]) {
 			}
 			free(requestFiles);
 
-			return cleanup(6, &model, &requests, logFile);
+			return cleanup(6, &model, &requests, &arena, logFile);
 		}
 	}
 
-	error =
-	    request_from_files(requestFiles, nRequestFiles, &requests, maxPriority);
+	error = request_from_files(requestFiles, nRequestFiles, &arena, &requests,
+	                           maxPriority);
 
 	for (size_t j = 0; j != nRequestFiles; ++j) {
 		fclose(requestFiles[j]);
@@ -112,7 +110,17 @@ int main(int argc, char* argv[]) {
 
 	if (error) {
 		app_error_print(error);
-		return cleanup(9, &model, &requests, logFile);
+		return cleanup(9, &model, &requests, &arena, logFile);
+	}
+
+	// Heap operations can be recorded for the heap benchmark.
+	const char* heapTracePath = getenv("MODEL_HEAP_TRACE");
+	if (heapTracePath) {
+		model.heapTrace = fopen(heapTracePath, "w");
+		if (!model.heapTrace) {
+			fprintf(stderr, "Can't open %s for writing.\n", heapTracePath);
+			return cleanup(12, &model, &requests, &arena, logFile);
+		}
 	}
 
 	printf("Initialized!!!\n");
@@ -120,8 +128,8 @@ int main(int argc, char* argv[]) {
 	error = model_run(&model, &requests, logFile);
 	if (error) {
 		app_error_print(error);
-		return cleanup(11, &model, &requests, logFile);
+		return cleanup(11, &model, &requests, &arena, logFile);
 	}
 
-	return cleanup(0, &model, &requests, logFile);
+	return cleanup(0, &model, &requests, &arena, logFile);
 }
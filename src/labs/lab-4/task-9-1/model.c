@@ -7,6 +7,7 @@
 
 #include "lib/convert.h"
 #include "lib/mth.h"
+#include "lib/rng.h"
 #include "lib/utils.h"
 
 typedef enum read_state {
@@ -55,6 +56,10 @@ error_t storage_type_from_string(const char* string, storage_type_t* outType) {
 		*outType = STORAGE_HASHTABLE;
 	else if (strcmp(string, "STORAGE_TRIE") == 0)
 		*outType = STORAGE_TRIE;
+	else if (strcmp(string, "STORAGE_FLAT_HASHTABLE") == 0)
+		*outType = STORAGE_FLAT_HASHTABLE;
+	else if (strcmp(string, "STORAGE_AUTO") == 0)
+		*outType = STORAGE_AUTO;
 	else {
 		return ERROR_MODEL_UNKNOWN_STORAGE_TYPE;
 	}
@@ -63,7 +68,10 @@ error_t storage_type_from_string(const char* string, storage_type_t* outType) {
 }
 
 model_t model_create() {
-	return (model_t){.departments = NULL, .departmentMap = NULL};
+	return (model_t){.departments = NULL,
+	                 .departmentMap = NULL,
+	                 .operatorNames = NULL,
+	                 .heapTrace = NULL};
 }
 
 void model_destroy(model_t* model) {
@@ -79,6 +87,9 @@ void model_destroy(model_t* model) {
 
 	storage_destroy(model->departmentMap);
 	model->departmentMap = NULL;
+
+	free(model->operatorNames);
+	model->operatorNames = NULL;
 }
 
 error_t model_read_fail(error_t retval, char* line) {
@@ -289,12 +300,43 @@ error_t model_init(model_t* model) {
 
 	model->departments = NULL;
 	model->departmentMap = NULL;
+	model->operatorNames = NULL;
+
+	// Operator names are rendered lazily from the seed, see |model_oper_name|.
+	model->nameSeed = (uint64_t)time(NULL);
+	srand(model->nameSeed);
+
+	size_t operatorTotal = 0;
+	for (size_t i = 0; i != model->departmentCount; ++i) {
+		operatorTotal += model->operatorCount[i];
+	}
+
+	model->operatorNames =
+	    (char*)calloc(operatorTotal, sizeof(char) * (OPER_NAME_LENGTH + 1));
+	if (!model->operatorNames) {
+		return model_init_fail(ERROR_OUT_OF_MEMORY, model);
+	}
+
+	// Index of the next operator's name in |model->operatorNames|.
+	size_t nameIdx = 0;
 
 	model->departments = calloc(model->departmentCount, sizeof(department_t));
 	if (!model->departments) {
 		return model_init_fail(ERROR_OUT_OF_MEMORY, model);
 	}
 
+	if (model->deptStorageType == STORAGE_AUTO) {
+		// Departments are keyed by "D<index>", see below.
+		size_t keyLengthTotal = 0;
+		for (size_t i = 0; i != model->departmentCount; ++i) {
+			keyLengthTotal += snprintf(NULL, 0, "D%zu", i);
+		}
+
+		model->deptStorageType =
+		    storage_auto_select(model->departmentCount,
+		                        keyLengthTotal / model->departmentCount);
+	}
+
 	model->departmentMap = storage_create(model->deptStorageType);
 	if (!model->departmentMap) {
 		return model_init_fail(ERROR_OUT_OF_MEMORY, model);
@@ -320,30 +362,15 @@ error_t model_init(model_t* model) {
 		dept->requestsInQueue = 0;
 
 		dept->operators = vector_oper_create();
+		if (!vector_oper_ensure_capacity(&dept->operators,
+		                                 model->operatorCount[i])) {
+			return model_init_fail(ERROR_OUT_OF_MEMORY, model);
+		}
 
 		for (size_t j = 0; j != model->operatorCount[i]; ++j) {
-			size_t length = 16;
-
-			// For whatever reason, without this `rand()` always produces the
-			// same values for me.
-			srand(time(NULL) + i + j);
-
-			// Generate a random 16-character "name"
-			char* name = (char*)malloc(sizeof(char) * (length + 1));
-			if (!name) {
-				return model_init_fail(ERROR_OUT_OF_MEMORY, model);
-			}
-
-			for (size_t k = 0; k != length; ++k) {
-				name[k] = (char)(rand() % 2 ? mth_rand('a', 'z')
-				                            : mth_rand('A', 'Z'));
-			}
-
-			name[length] = '\0';
-
-			oper_t oper = {.name = name, .request = NULL, .remainingTime = 0};
+			oper_t oper = {
+			    .nameIdx = nameIdx++, .request = NULL, .remainingTime = 0};
 			if (!vector_oper_push_back(&dept->operators, oper)) {
-				free(name);
 				return model_init_fail(ERROR_OUT_OF_MEMORY, model);
 			}
 		}
@@ -356,6 +383,28 @@ error_t model_init(model_t* model) {
 	return 0;
 }
 
+/**
+ * Returns the name of |oper|, rendering it into the model's name arena the
+ * first time it's requested. The name only depends on the seed and the
+ * operator's index, so no per-operator state is stored besides the slot.
+ */
+const char* model_oper_name(model_t* model, const oper_t* oper) {
+	static const char ALPHABET[] =
+	    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+	char* name = model->operatorNames + oper->nameIdx * (OPER_NAME_LENGTH + 1);
+	if (name[0] != '\0') return name;
+
+	uint64_t state = model->nameSeed ^ (oper->nameIdx * 0xD1B54A32D192ED03ull);
+
+	for (size_t k = 0; k != OPER_NAME_LENGTH; ++k) {
+		name[k] = ALPHABET[rng_splitmix64(&state) % (sizeof(ALPHABET) - 1)];
+	}
+
+	name[OPER_NAME_LENGTH] = '\0';
+	return name;
+}
+
 void model_log(FILE* logFile, time_t modelTime, event_t eventId,
                const char* fmt, ...) {
 	// Format message.
@@ -431,6 +480,8 @@ error_t model_assign_requests(model_t* model, FILE* logFile) {
 		error = heap_pop_max(dept->requestQueue, &request);
 		if (error) return error;
 
+		if (model->heapTrace) fprintf(model->heapTrace, "P %zu\n", i);
+
 		--dept->requestsInQueue;
 
 		assignTo->request = request;
@@ -438,7 +489,7 @@ error_t model_assign_requests(model_t* model, FILE* logFile) {
 
 		model_log(logFile, model->time, REQUEST_HANDLING_STARTED,
 		          "request id=%lu, assigned to %s at %s", request->id,
-		          assignTo->name, dept->id);
+		          model_oper_name(model, assignTo), dept->id);
 	}
 
 	return 0;
@@ -471,6 +522,12 @@ error_t model_move_requests(model_t* model, request_t* causingRequest,
 		    heap_meld(overloadedDept->requestQueue, moveTo->requestQueue);
 		if (error) return error;
 
+		if (model->heapTrace) {
+			fprintf(model->heapTrace, "M %zu %zu\n",
+			        (size_t)(overloadedDept - model->departments),
+			        (size_t)(moveTo - model->departments));
+		}
+
 		moveTo->requestsInQueue += overloadedDept->requestsInQueue;
 		overloadedDept->requestsInQueue = 0;
 
@@ -502,7 +559,8 @@ error_t model_tick_departments(model_t* model, FILE* logFile) {
 
 				model_log(logFile, model->time, REQUEST_HANDLING_FINISHED,
 				          "request id=%lu, completed in %u mins by operator %s",
-				          req->id, req->requiredTime, oper->name);
+				          req->id, req->requiredTime,
+				          model_oper_name(model, oper));
 
 				oper->request = NULL;
 			}
@@ -512,67 +570,42 @@ error_t model_tick_departments(model_t* model, FILE* logFile) {
 	return 0;
 }
 
-error_t model_run_clean(error_t error, vector_request_t* offloadedRequests) {
-	for (size_t i = 0; i != vector_request_size(offloadedRequests); ++i) {
-		request_t* request = vector_request_get(offloadedRequests, i);
-		request_destroy(request);
-	}
-	vector_request_destroy(offloadedRequests);
-
-	return error;
-}
-
 error_t model_run(model_t* model, deque_request_t* requests, FILE* logFile) {
 	if (!model || !requests || !logFile) return ERROR_INVALID_PARAMETER;
 
 	error_t error;
 	model->time = model->startTime;
 
-	// When popping a request from the queue, it is returned as a value. It is
-	// then inserted into the respective department's queue by reference.
-	// Because its scope ends right after, a use-after-scope occurs, which is
-	// why this temporary storage exists.
-	vector_request_t offloadedRequests = vector_request_create();
-
-	// Don't want to accidentally resize it.
-	if (!vector_request_ensure_capacity(&offloadedRequests,
-	                                    deque_request_size(requests))) {
-		return model_run_clean(ERROR_OUT_OF_MEMORY, &offloadedRequests);
+	if (model->heapTrace) {
+		fprintf(model->heapTrace, "D %zu\n", model->departmentCount);
 	}
 
 	while (difftime(model->time, model->endTime) <= 0) {
-		const request_t* head = deque_request_peek_front(requests);
+		const request_t** head = deque_request_peek_front(requests);
 
 		// Popped request from the queue.
 		request_t* request;
 		// Department this request was moved to.
 		department_t* dept = NULL;
 
-		if (head && difftime(model->time, head->time) >= 0) {
-			// Insert request into department.
-			request_t temp;
-			deque_request_pop_front(requests, &temp);
-
-			if (!vector_request_push_back(&offloadedRequests, temp)) {
-				return model_run_clean(ERROR_OUT_OF_MEMORY, &offloadedRequests);
-			}
-
-			request =
-			    vector_request_get(&offloadedRequests,
-			                       vector_request_size(&offloadedRequests) - 1);
+		if (head && difftime(model->time, (*head)->time) >= 0) {
+			// Insert request into department. Requests live in the arena
+			// they were parsed into, so the pointer stays valid.
+			deque_request_pop_front(requests, &request);
 
 			request->requiredTime =
 			    mth_rand(model->minProcessTime, model->maxProcessTime);
 
 			dept = storage_get(model->departmentMap, request->departmentId);
-			if (!dept) {
-				return model_run_clean(ERROR_MODEL_UNKNOWN_DEPARTMENT,
-				                       &offloadedRequests);
-			}
+			if (!dept) return ERROR_MODEL_UNKNOWN_DEPARTMENT;
 
 			error = heap_insert(dept->requestQueue, request);
-			if (error) {
-				return model_run_clean(error, &offloadedRequests);
+			if (error) return error;
+
+			if (model->heapTrace) {
+				fprintf(model->heapTrace, "I %zu %u %lld\n",
+				        (size_t)(dept - model->departments), request->priority,
+				        (long long)request->time);
 			}
 
 			++dept->requestsInQueue;
@@ -607,7 +640,7 @@ error_t model_run(model_t* model, deque_request_t* requests, FILE* logFile) {
 		model->time = mktime(tm);
 	}
 
-	return model_run_clean(0, &offloadedRequests);
+	return 0;
 }
 
 const char* model_error_to_string(error_t error) {
@@ -36,6 +36,16 @@ typedef struct model {
 	time_t time;
 	department_t* departments;
 	storage_t* departmentMap;
+
+	/** Operator names, |OPER_NAME_LENGTH| + 1 bytes per operator. A name is
+	 * rendered on first use; an empty slot hasn't been rendered yet. */
+	char* operatorNames;
+	/** Seed the operator names are derived from. */
+	uint64_t nameSeed;
+
+	/** If set, heap operations are recorded here to be replayed by the heap
+	 * benchmark (lab_4_9_4). */
+	FILE* heapTrace;
 } model_t;
 
 typedef enum event {
@@ -1,168 +1,180 @@
 #include "request.h"
 
+#include <stdalign.h>
+
 #include "lib/convert.h"
 #include "lib/mth.h"
 #include "lib/utils.h"
 
-typedef enum read_state {
-	READ_PRIORITY,
-	READ_DEPARTMENT_ID,
-	READ_TEXT,
-} read_state_t;
-
 int request_time_cmp(const void* p1, const void* p2) {
 	if (!p1 || !p2 || p1 == p2) return 0;
 
-	const request_t* a = (const request_t*)p1;
-	const request_t* b = (const request_t*)p2;
+	const request_t* a = *(const request_t**)p1;
+	const request_t* b = *(const request_t**)p2;
 
 	return mth_sign_double(difftime(a->time, b->time));
 }
 
-IMPL_DEQUE(deque_request_t, request_t, request)
-IMPL_VECTOR(vector_request_t, request_t, request, {&request_time_cmp})
+IMPL_DEQUE(deque_request_t, request_t*, request)
+IMPL_VECTOR_WITH_SORT(vector_request_t, request_t*, request,
+                      {&request_time_cmp},
+                      difftime((*a)->time, (*b)->time) < 0)
+
+request_arena_t request_arena_create(void) {
+	return (request_arena_t){.head = NULL, .departmentIds = strpool_create()};
+}
+
+void request_arena_destroy(request_arena_t* arena) {
+	if (!arena) return;
 
-void request_destroy(request_t* request) {
-	if (!request) return;
+	request_arena_block_t* block = arena->head;
+	while (block) {
+		request_arena_block_t* next = block->next;
+		free(block);
+		block = next;
+	}
 
-	free(request->departmentId);
-	request->departmentId = NULL;
-	free(request->text);
-	request->text = NULL;
+	arena->head = NULL;
+	strpool_destroy(&arena->departmentIds);
 }
 
-error_t request_read_fail(error_t error, char* line, request_t* out) {
-	free(line);
+void* request_arena_alloc(request_arena_t* arena, size_t size, size_t align) {
+	if (!arena || !align) return NULL;
 
-	request_destroy(out);
+	request_arena_block_t* block = arena->head;
 
-	return error;
+	// Offset of the allocation in the current block, rounded up to |align|.
+	size_t offset = block ? (block->used + align - 1) / align * align : 0;
+
+	if (!block || offset > block->capacity ||
+	    block->capacity - offset < size) {
+		size_t capacity = size > REQUEST_ARENA_BLOCK_SIZE
+		                      ? size
+		                      : REQUEST_ARENA_BLOCK_SIZE;
+
+		block = (request_arena_block_t*)malloc(sizeof(request_arena_block_t) +
+		                                       capacity);
+		if (!block) return NULL;
+
+		block->next = arena->head;
+		block->used = 0;
+		block->capacity = capacity;
+		arena->head = block;
+
+		offset = 0;
+	}
+
+	void* ptr = (char*)block->data + offset;
+	block->used = offset + size;
+
+	return ptr;
 }
 
-error_t request_from_string(const char* string, request_t* out,
-                            unsigned maxPriority) {
-	if (!out) return ERROR_INVALID_PARAMETER;
+char* request_arena_strdup(request_arena_t* arena, strview_t string) {
+	char* copy = (char*)request_arena_alloc(arena, string.length + 1, 1);
+	if (!copy) return NULL;
+
+	if (string.length) memcpy(copy, string.chars, string.length);
+	copy[string.length] = '\0';
+	return copy;
+}
 
-	error_t error;
+/** Copies |view| into |buffer| of |size| bytes, null-terminating it. */
+static bool request_copy_token(strview_t view, char* buffer, size_t size) {
+	if (view.length >= size) return false;
+
+	memcpy(buffer, view.chars, view.length);
+	buffer[view.length] = '\0';
+	return true;
+}
+
+error_t request_from_string(const char* string, request_arena_t* arena,
+                            request_t* out, unsigned maxPriority) {
+	if (!arena || !out) return ERROR_INVALID_PARAMETER;
 
 	out->text = NULL;
 	out->departmentId = NULL;
 
-	char* line = strdup(string);
-	if (!line) return ERROR_OUT_OF_MEMORY;
+	// The line is tokenized in place: only the tokens that are parsed by
+	// functions expecting null-terminated strings are copied.
+	strview_t rest = strview_from_c_str(string);
+	strview_t date, clock, token;
 
-	// Find a second space to terminate the datetime.
-	char* firstSpace = NULL;
-	char* secondSpace = NULL;
-
-	for (char* p = line; *p; ++p) {
-		if (*p == ' ') {
-			if (!firstSpace) {
-				firstSpace = p;
-			} else {
-				secondSpace = p;
-				break;
-			}
-		}
+	// The datetime ends with the second space.
+	if (!strview_split(&rest, ' ', &date) ||
+	    !strview_split(&rest, ' ', &clock) || !rest.chars) {
+		return ERROR_REQUEST_INVALID_TIME;
 	}
 
-	if (!secondSpace) {
-		return request_read_fail(ERROR_REQUEST_INVALID_TIME, line, out);
+	// "YYYY-MM-DD HH:MM:SS", with some room for malformed input.
+	char datetime[32];
+	strview_t datetimeView = {.chars = date.chars,
+	                          .length = date.length + 1 + clock.length};
+	if (!request_copy_token(datetimeView, datetime, sizeof(datetime))) {
+		return ERROR_REQUEST_INVALID_TIME;
 	}
 
-	// Read the datetime.
-	*secondSpace = '\0';
-
 	struct tm tm;
 	tm.tm_isdst = -1;
 
-	char* pend = strptime(line, "%Y-%m-%d %H:%M:%S", &tm);
+	char* pend = strptime(datetime, "%Y-%m-%d %H:%M:%S", &tm);
 	if (!pend || *pend != '\0' || !tm_validate(tm)) {
-		return request_read_fail(ERROR_REQUEST_INVALID_TIME, line, out);
+		return ERROR_REQUEST_INVALID_TIME;
 	}
 
 	out->time = mktime(&tm);
 
-	// Read the rest of the data from here, tokenizing the string.
-	char* readPtr = secondSpace + 1;
-	char* token;
-	read_state_t state = READ_PRIORITY;
-
-	while ((token = strsep(&readPtr, " "))) {
-		switch (state) {
-			case READ_PRIORITY: {
-				unsigned long priority;
+	// Read the priority.
+	char priorityStr[24];
+	unsigned long priority;
 
-				error = str_to_ulong(token, &priority);
-				if (error || priority > maxPriority) {
-					return request_read_fail(ERROR_REQUEST_INVALID_PRIORITY,
-					                         line, out);
-				}
+	if (!strview_split(&rest, ' ', &token) ||
+	    !request_copy_token(token, priorityStr, sizeof(priorityStr)) ||
+	    str_to_ulong(priorityStr, &priority) || priority > maxPriority) {
+		return ERROR_REQUEST_INVALID_PRIORITY;
+	}
 
-				out->priority = priority;
+	out->priority = priority;
 
-				state = READ_DEPARTMENT_ID;
-				break;
-			}
-			case READ_DEPARTMENT_ID: {
-				out->departmentId = strdup(token);
-				if (!out->departmentId) {
-					return request_read_fail(ERROR_OUT_OF_MEMORY, line, out);
-				}
-
-				state = READ_TEXT;
-				break;
-			}
-		}
-
-		if (state == READ_TEXT) {
-			break;
-		}
+	// Read the department ID, followed by the text.
+	if (!strview_split(&rest, ' ', &token) || !rest.chars) {
+		return ERROR_UNEXPECTED_TOKEN;
 	}
 
-	if (state != READ_TEXT || !readPtr || *readPtr != '"') {
-		return request_read_fail(ERROR_UNEXPECTED_TOKEN, line, out);
+	size_t departmentId;
+	if (!strpool_intern(&arena->departmentIds, token, &departmentId)) {
+		return ERROR_OUT_OF_MEMORY;
 	}
 
-	// Skip the first quote.
-	++readPtr;
+	out->departmentId =
+	    strpool_get(&arena->departmentIds, departmentId).chars;
 
-	// Find the last quote, check that the input string ends after it, and
-	// terminate the token.
-	char* textEnd = strrchr(readPtr, '"');
-	if (!textEnd || *(textEnd + 1) != '\0') {
-		return request_read_fail(ERROR_UNEXPECTED_TOKEN, line, out);
+	// The text is quoted, and the input string ends after it.
+	if (rest.length < 2 || rest.chars[0] != '"' ||
+	    rest.chars[rest.length - 1] != '"') {
+		return ERROR_UNEXPECTED_TOKEN;
 	}
 
-	*textEnd = '\0';
-
-	// Copy text to request.
-	out->text = strdup(readPtr);
-	if (!out->text) {
-		return request_read_fail(ERROR_OUT_OF_MEMORY, line, out);
-	}
+	// Copy text to request, without the quotes.
+	out->text = request_arena_strdup(
+	    arena, (strview_t){.chars = rest.chars + 1, .length = rest.length - 2});
+	if (!out->text) return ERROR_OUT_OF_MEMORY;
 
-	free(line);
 	return 0;
 }
 
 error_t request_files_cleanup(error_t error, vector_request_t* temp,
                               char* line) {
-	for (size_t i = 0; i != vector_request_size(temp); ++i) {
-		request_t* request = vector_request_get(temp, i);
-		request_destroy(request);
-	}
-
 	vector_request_destroy(temp);
-
 	free(line);
 
 	return error;
 }
 
-error_t request_from_files(FILE* files[], size_t nFiles, deque_request_t* out,
+error_t request_from_files(FILE* files[], size_t nFiles,
+                           request_arena_t* arena, deque_request_t* out,
                            unsigned maxPriority) {
-	if (!files || !nFiles || !out) return ERROR_INVALID_PARAMETER;
+	if (!files || !nFiles || !arena || !out) return ERROR_INVALID_PARAMETER;
 
 	*out = deque_request_create();
 
@@ -178,19 +190,22 @@ error_t request_from_files(FILE* files[], size_t nFiles, deque_request_t* out,
 			char* newline = strrchr(line, '\n');
 			if (newline) *newline = '\0';
 
-			request_t request;
+			request_t* request = (request_t*)request_arena_alloc(
+			    arena, sizeof(request_t), alignof(request_t));
+			if (!request) {
+				return request_files_cleanup(ERROR_OUT_OF_MEMORY, &temp, line);
+			}
 
-			// Read line from files[i].
-			error_t error = request_from_string(line, &request, maxPriority);
+			// Parse the line into a request.
+			error_t error =
+			    request_from_string(line, arena, request, maxPriority);
 			if (error) return request_files_cleanup(error, &temp, line);
 
 			// Assign a sequential ID.
-			request.id = idSequence;
+			request->id = idSequence;
 			++idSequence;
 
-			// Parse the line into a request.
 			if (!vector_request_push_back(&temp, request)) {
-				request_destroy(&request);
 				return request_files_cleanup(ERROR_OUT_OF_MEMORY, &temp, line);
 			}
 		}
@@ -204,13 +219,10 @@ error_t request_from_files(FILE* files[], size_t nFiles, deque_request_t* out,
 
 	vector_request_sort(&temp);
 
-	for (size_t i = 0; i != vector_request_size(&temp); ++i) {
-		request_t* request = vector_request_get(&temp, i);
-
-		if (!deque_request_push_back(out, *request)) {
-			deque_request_destroy(out);
-			return request_files_cleanup(ERROR_OUT_OF_MEMORY, &temp, NULL);
-		}
+	if (!deque_request_push_back_n(out, vector_request_to_array(&temp),
+	                               vector_request_size(&temp))) {
+		deque_request_destroy(out);
+		return request_files_cleanup(ERROR_OUT_OF_MEMORY, &temp, NULL);
 	}
 
 	vector_request_destroy(&temp);
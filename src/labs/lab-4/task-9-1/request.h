@@ -1,8 +1,10 @@
 #pragma once
 
+#include <stddef.h>
 #include <time.h>
 
 #include "lib/collections/deque.h"
+#include "lib/collections/strpool.h"
 #include "lib/collections/vector.h"
 #include "lib/error.h"
 
@@ -19,15 +21,46 @@ typedef struct request {
 	unsigned requiredTime;
 } request_t;
 
-DEFINE_DEQUE(deque_request_t, request_t, request)
-DEFINE_VECTOR(vector_request_t, request_t, request)
+DEFINE_DEQUE(deque_request_t, request_t*, request)
+DEFINE_VECTOR(vector_request_t, request_t*, request)
 
-void request_destroy(request_t* request);
+/** Default size of a request arena block, in bytes. */
+#define REQUEST_ARENA_BLOCK_SIZE ((size_t)4 << 20)
 
-error_t request_from_string(const char* string, request_t* out,
-                            unsigned maxPriority);
+typedef struct request_arena_block {
+	/** Previously filled block. */
+	struct request_arena_block* next;
+	/** Bytes used in |data|. */
+	size_t used;
+	/** Size of |data|, in bytes. */
+	size_t capacity;
+	max_align_t data[];
+} request_arena_block_t;
 
-error_t request_from_files(FILE* files[], size_t nFiles, deque_request_t* out,
+/**
+ * Bump allocator owning the requests and their strings. Memory is never moved
+ * or freed individually, so pointers into the arena stay valid until it's
+ * destroyed.
+ */
+typedef struct request_arena {
+	request_arena_block_t* head;
+	/** Department IDs, which repeat across requests, are stored once. */
+	strpool_t departmentIds;
+} request_arena_t;
+
+request_arena_t request_arena_create(void);
+
+void request_arena_destroy(request_arena_t* arena);
+
+void* request_arena_alloc(request_arena_t* arena, size_t size, size_t align);
+
+char* request_arena_strdup(request_arena_t* arena, strview_t string);
+
+error_t request_from_string(const char* string, request_arena_t* arena,
+                            request_t* out, unsigned maxPriority);
+
+error_t request_from_files(FILE* files[], size_t nFiles,
+                           request_arena_t* arena, deque_request_t* out,
                            unsigned maxPriority);
 
 int request_priority_cmp(const request_t* a, const request_t* b);
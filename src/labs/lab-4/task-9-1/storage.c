@@ -2,13 +2,46 @@
 
 #include "bst.h"
 #include "dynamic_array.h"
+#include "flat_hashtable.h"
 #include "hashtable.h"
 #include "trie.h"
 
 const storage_vtable_t* STORAGE_VTABLE_LOOKUP[] = {
-    &BST_VTABLE, &DYNAMIC_ARRAY_VTABLE, &HASHTABLE_VTABLE, &TRIE_VTABLE};
+    &BST_VTABLE, &DYNAMIC_ARRAY_VTABLE, &HASHTABLE_VTABLE, &TRIE_VTABLE,
+    &FLAT_HASHTABLE_VTABLE};
+
+/*
+ * Crossover points measured with `lab_4_9_4 -storage`:
+ *  - a trie looks up short keys in about half the time of the hash table, as
+ *    long as its nodes (half a kilobyte each) fit in the cache hierarchy;
+ *  - binary search over a few long keys beats hashing them in full, since
+ *    most comparisons stop at the first characters;
+ *  - the hash table is the fastest for anything else. The flat hash table
+ *    looks keys up as fast, with half the allocations and fewer cache
+ *    misses, but its puts are slower and its peak memory while growing is
+ *    higher, so it's never picked.
+ */
+static const size_t AUTO_TRIE_MAX_KEY_LENGTH = 5;
+static const size_t AUTO_TRIE_MAX_KEYS = 16384;
+static const size_t AUTO_ARRAY_MIN_KEY_LENGTH = 16;
+static const size_t AUTO_ARRAY_MAX_KEYS = 64;
+
+storage_type_t storage_auto_select(size_t keyCount, size_t meanKeyLength) {
+	if (meanKeyLength <= AUTO_TRIE_MAX_KEY_LENGTH &&
+	    keyCount <= AUTO_TRIE_MAX_KEYS) {
+		return STORAGE_TRIE;
+	}
+	if (meanKeyLength >= AUTO_ARRAY_MIN_KEY_LENGTH &&
+	    keyCount <= AUTO_ARRAY_MAX_KEYS) {
+		return STORAGE_DYNAMIC_ARRAY;
+	}
+
+	return STORAGE_HASHTABLE;
+}
 
 storage_t* storage_create(storage_type_t type) {
+	if (type >= STORAGE_AUTO) return NULL;
+
 	storage_t* storage = (storage_t*)malloc(sizeof(storage_t));
 	if (!storage) return NULL;
 
@@ -15,7 +15,10 @@ typedef enum storage_type {
 	STORAGE_BST,
 	STORAGE_DYNAMIC_ARRAY,
 	STORAGE_HASHTABLE,
-	STORAGE_TRIE
+	STORAGE_TRIE,
+	STORAGE_FLAT_HASHTABLE,
+	/** Resolved to one of the above by |storage_auto_select|. */
+	STORAGE_AUTO
 } storage_type_t;
 
 typedef struct storage {
@@ -24,6 +27,13 @@ typedef struct storage {
 	storage_vtable_t vtable;
 } storage_t;
 
+/**
+ * Picks the backend that's fastest for |keyCount| keys of |meanKeyLength|
+ * characters. The crossover points come from the storage benchmark
+ * (lab-4/task-9-4).
+ */
+storage_type_t storage_auto_select(size_t keyCount, size_t meanKeyLength);
+
 storage_t* storage_create(storage_type_t type);
 
 void storage_destroy(storage_t* storage);
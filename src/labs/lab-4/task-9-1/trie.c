@@ -41,11 +41,11 @@ static int char_idx(char c) {
 	if (c >= 'A' && c <= 'Z') {
 		return c - 'A';
 	} else if (c >= 'a' && c <= 'z') {
-		return 26 + 1 + (c - 'a');
+		return 26 + (c - 'a');
 	} else if (c >= '0' && c <= '9') {
-		return 52 + 1 + (c - '0');
+		return 52 + (c - '0');
 	} else if (c == '_') {
-		return 63;
+		return 62;
 	} else {
 		return -1;
 	}
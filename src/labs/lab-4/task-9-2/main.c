@@ -104,7 +104,8 @@ int main(int argc, char* argv[]) {
 			case PROMPT_STORAGE_TYPE: {
 				printf(
 				    "Enter storage type ('bst', 'dynamic_array', 'hashtable', "
-				    "'trie'): \n");
+				    "'trie', 'flat_hashtable', or 'auto' to pick one from "
+				    "the departments): \n");
 
 				if (getline(&line, &capacity, stdin) <= 0) {
 					return cleanup(1, settingsFile, line, &deptInfo);
@@ -121,6 +122,10 @@ int main(int argc, char* argv[]) {
 					fprintf(settingsFile, "STORAGE_HASHTABLE\n");
 				else if (strcmp("trie", line) == 0)
 					fprintf(settingsFile, "STORAGE_TRIE\n");
+				else if (strcmp("flat_hashtable", line) == 0)
+					fprintf(settingsFile, "STORAGE_FLAT_HASHTABLE\n");
+				else if (strcmp("auto", line) == 0)
+					fprintf(settingsFile, "STORAGE_AUTO\n");
 				else {
 					printf("Invalid storage type. Try again.\n");
 					break;
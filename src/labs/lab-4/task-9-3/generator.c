@@ -0,0 +1,379 @@
+#include "generator.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lib/rng.h"
+
+/** Text attached to every generated request. */
+static const char REQUEST_TEXT[] = " \"doesn't matter\"\n";
+
+/** State of a single output stream (file). */
+typedef struct gen_stream {
+	const gen_settings_t* settings;
+	const gen_zipf_t* departments;
+	const gen_zipf_t* priorities;
+
+	FILE* file;
+	size_t requestCount;
+	uint64_t seed;
+
+	error_t error;
+} gen_stream_t;
+
+/** Returns a uniformly distributed double in (0; 1]. */
+static inline double gen_rng_double(rng_t* rng) {
+	return (double)((rng_next(rng) >> 11) + 1) * 0x1p-53;
+}
+
+/** Returns a uniformly distributed integer in [0; n). */
+static inline size_t gen_rng_below(rng_t* rng, size_t n) {
+	size_t value = (size_t)((double)(rng_next(rng) >> 11) * 0x1p-53 * n);
+	return value < n ? value : n - 1;
+}
+
+/** Returns an exponentially distributed double with the given mean. */
+static inline double gen_rng_exp(rng_t* rng, double mean) {
+	return -log(gen_rng_double(rng)) * mean;
+}
+
+error_t gen_zipf_create(gen_zipf_t* zipf, size_t n, double s) {
+	if (!zipf || !n) return ERROR_INVALID_PARAMETER;
+
+	zipf->cdf = NULL;
+	zipf->n = n;
+
+	// A skew of zero is sampled directly, without a table.
+	if (s == 0.0) return 0;
+	if (n > GEN_MAX_ZIPF_DOMAIN) return ERROR_GEN_INVALID_ZIPF_DOMAIN;
+
+	zipf->cdf = (double*)malloc(n * sizeof(double));
+	if (!zipf->cdf) return ERROR_OUT_OF_MEMORY;
+
+	double sum = 0.0;
+	for (size_t k = 0; k != n; ++k) {
+		sum += 1.0 / pow((double)(k + 1), s);
+		zipf->cdf[k] = sum;
+	}
+	for (size_t k = 0; k != n; ++k) {
+		zipf->cdf[k] /= sum;
+	}
+
+	return 0;
+}
+
+void gen_zipf_destroy(gen_zipf_t* zipf) {
+	if (!zipf) return;
+
+	free(zipf->cdf);
+	zipf->cdf = NULL;
+}
+
+static size_t gen_zipf_sample(const gen_zipf_t* zipf, rng_t* rng) {
+	if (!zipf->cdf) return gen_rng_below(rng, zipf->n);
+
+	// Find the first k with cdf[k] >= u.
+	double u = gen_rng_double(rng);
+	size_t lo = 0, hi = zipf->n - 1;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (zipf->cdf[mid] < u)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/** Writes |value| in decimal to |out|, returning the amount of chars. */
+static inline size_t gen_format_ulong(char* out, unsigned long value) {
+	char digits[24];
+	size_t n = 0;
+
+	do {
+		digits[n++] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value);
+
+	for (size_t i = 0; i != n; ++i) {
+		out[i] = digits[n - i - 1];
+	}
+
+	return n;
+}
+
+/** Generates arrival times of a single stream in ascending order. */
+typedef struct gen_arrivals {
+	gen_arrival_t type;
+	double start;
+	double duration;
+	/** Current arrival time, in seconds since |start|. */
+	double time;
+
+	/** Requests left to generate; used by the uniform process. */
+	size_t remaining;
+	/** Running maximum of the remaining uniforms; used by the uniform
+	 * process. */
+	double maximum;
+
+	/** Mean inter-arrival time in the quiet and burst state. */
+	double quietMean;
+	double burstMean;
+	/** Whether the process is in a burst, and when the state changes. */
+	bool inBurst;
+	double stateEnd;
+} gen_arrivals_t;
+
+static gen_arrivals_t gen_arrivals_create(const gen_settings_t* settings,
+                                          size_t count, rng_t* rng) {
+	double duration = difftime(settings->endTime, settings->startTime);
+	double mean = count ? duration / (double)count : duration;
+
+	gen_arrivals_t a = {.type = settings->arrival,
+	                    .start = (double)settings->startTime,
+	                    .duration = duration,
+	                    .time = 0.0,
+	                    .remaining = count,
+	                    .maximum = 1.0,
+	                    .quietMean = mean,
+	                    .burstMean = mean,
+	                    .inBurst = false,
+	                    .stateEnd = 0.0};
+
+	if (a.type == GEN_ARRIVAL_BURSTY) {
+		// Keep the overall rate at |count| per |duration|:
+		// rate = quietRate * (1 - p) + burstRate * p.
+		double p = GEN_BURST_TIME_FRACTION;
+		double k = settings->burstFactor;
+
+		a.quietMean = mean * (1.0 - p + p * k);
+		a.burstMean = a.quietMean / k;
+
+		double quietDuration = GEN_BURST_MEAN_DURATION * (1.0 - p) / p;
+		a.stateEnd = gen_rng_exp(rng, quietDuration);
+	}
+
+	return a;
+}
+
+static time_t gen_arrivals_next(gen_arrivals_t* a, rng_t* rng) {
+	switch (a->type) {
+		case GEN_ARRIVAL_UNIFORM: {
+			// The maximum of k uniforms is distributed as U^(1/k), which
+			// yields the sorted sample from the top without storing it.
+			a->maximum *= pow(gen_rng_double(rng), 1.0 / (double)a->remaining);
+			--a->remaining;
+			a->time = (1.0 - a->maximum) * a->duration;
+			break;
+		}
+		case GEN_ARRIVAL_POISSON: {
+			a->time += gen_rng_exp(rng, a->quietMean);
+			break;
+		}
+		case GEN_ARRIVAL_BURSTY: {
+			double p = GEN_BURST_TIME_FRACTION;
+			double t = a->time;
+
+			for (;;) {
+				double mean = a->inBurst ? a->burstMean : a->quietMean;
+				double next = t + gen_rng_exp(rng, mean);
+
+				if (next < a->stateEnd) {
+					t = next;
+					break;
+				}
+
+				// The state changes before the next arrival. Inter-arrival
+				// times are memoryless, so restart from the switch point.
+				t = a->stateEnd;
+				a->inBurst = !a->inBurst;
+				a->stateEnd +=
+				    gen_rng_exp(rng, a->inBurst ? GEN_BURST_MEAN_DURATION
+				                                : GEN_BURST_MEAN_DURATION *
+				                                      (1.0 - p) / p);
+			}
+
+			a->time = t;
+			break;
+		}
+	}
+
+	// Processes aren't bounded by the time range, clamp the tail.
+	double time = a->time < a->duration ? a->time : a->duration;
+	return (time_t)(a->start + time);
+}
+
+static error_t gen_flush(FILE* file, const char* buffer, size_t size) {
+	if (size && fwrite(buffer, 1, size, file) != size) return ERROR_IO;
+	return 0;
+}
+
+static void* gen_stream_run(void* arg) {
+	gen_stream_t* stream = (gen_stream_t*)arg;
+	const gen_settings_t* settings = stream->settings;
+
+	stream->error = 0;
+
+	char* buffer = (char*)malloc(GEN_BUFFER_SIZE);
+	if (!buffer) {
+		stream->error = ERROR_OUT_OF_MEMORY;
+		return NULL;
+	}
+
+	size_t used = 0;
+
+	rng_t rng = rng_create(stream->seed);
+	gen_arrivals_t arrivals =
+	    gen_arrivals_create(settings, stream->requestCount, &rng);
+
+	// Formatted "YYYY-MM-DD HH:MM:" of the last minute seen. Arrivals are
+	// sorted, so it only changes once a minute at most.
+	char minutePrefix[64];
+	size_t minutePrefixLength = 0;
+	time_t minute = (time_t)-1;
+
+	for (size_t i = 0; i != stream->requestCount; ++i) {
+		time_t time = gen_arrivals_next(&arrivals, &rng);
+		time_t seconds = time % 60;
+
+		if (time - seconds != minute) {
+			minute = time - seconds;
+
+			struct tm tm;
+			if (!localtime_r(&minute, &tm)) {
+				stream->error = ERROR_INVALID_PARAMETER;
+				break;
+			}
+
+			minutePrefixLength = strftime(minutePrefix, sizeof(minutePrefix),
+			                              "%Y-%m-%d %H:%M:", &tm);
+		}
+
+		// Longest line: prefix, seconds, two numbers, text.
+		if (GEN_BUFFER_SIZE - used < sizeof(minutePrefix) + 64) {
+			if ((stream->error = gen_flush(stream->file, buffer, used))) break;
+			used = 0;
+		}
+
+		char* p = buffer + used;
+
+		memcpy(p, minutePrefix, minutePrefixLength);
+		p += minutePrefixLength;
+		*p++ = (char)('0' + seconds / 10);
+		*p++ = (char)('0' + seconds % 10);
+		*p++ = ' ';
+
+		// Priority ranks are skewed towards 0, the lowest priority.
+		p += gen_format_ulong(p, gen_zipf_sample(stream->priorities, &rng));
+		*p++ = ' ';
+		*p++ = 'D';
+		p += gen_format_ulong(p, gen_zipf_sample(stream->departments, &rng));
+
+		memcpy(p, REQUEST_TEXT, sizeof(REQUEST_TEXT) - 1);
+		p += sizeof(REQUEST_TEXT) - 1;
+
+		used = p - buffer;
+	}
+
+	if (!stream->error) stream->error = gen_flush(stream->file, buffer, used);
+	if (!stream->error && fflush(stream->file)) stream->error = ERROR_IO;
+
+	free(buffer);
+	return NULL;
+}
+
+static error_t gen_write_cleanup(error_t error, gen_zipf_t* departments,
+                                 gen_zipf_t* priorities, gen_stream_t* streams,
+                                 pthread_t* threads) {
+	gen_zipf_destroy(departments);
+	gen_zipf_destroy(priorities);
+	free(streams);
+	free(threads);
+
+	return error;
+}
+
+error_t gen_write_requests(const gen_settings_t* settings, FILE* files[]) {
+	if (!settings || !files || !settings->fileCount ||
+	    !settings->departmentCount ||
+	    difftime(settings->endTime, settings->startTime) <= 0) {
+		return ERROR_INVALID_PARAMETER;
+	}
+
+	error_t error;
+
+	gen_zipf_t departments = {.cdf = NULL};
+	gen_zipf_t priorities = {.cdf = NULL};
+
+	gen_stream_t* streams =
+	    (gen_stream_t*)calloc(settings->fileCount, sizeof(gen_stream_t));
+	pthread_t* threads =
+	    (pthread_t*)calloc(settings->fileCount, sizeof(pthread_t));
+
+	if (!streams || !threads) {
+		return gen_write_cleanup(ERROR_OUT_OF_MEMORY, &departments,
+		                         &priorities, streams, threads);
+	}
+
+	if ((error = gen_zipf_create(&departments, settings->departmentCount,
+	                             settings->departmentSkew)) ||
+	    (error = gen_zipf_create(&priorities, (size_t)settings->maxPriority + 1,
+	                             settings->prioritySkew))) {
+		return gen_write_cleanup(error, &departments, &priorities, streams,
+		                         threads);
+	}
+
+	uint64_t seedState = settings->seed;
+	size_t started = 0;
+
+	for (size_t i = 0; i != settings->fileCount; ++i) {
+		gen_stream_t* stream = &streams[i];
+
+		// Streams cover the whole time range at a fraction of the rate,
+		// which superimposes into the requested process.
+		stream->settings = settings;
+		stream->departments = &departments;
+		stream->priorities = &priorities;
+		stream->file = files[i];
+		stream->requestCount = settings->requestCount / settings->fileCount +
+		                       (i < settings->requestCount % settings->fileCount);
+		stream->seed = rng_splitmix64(&seedState);
+
+		if (settings->fileCount == 1) {
+			gen_stream_run(stream);
+		} else if (pthread_create(&threads[i], NULL, &gen_stream_run, stream)) {
+			error = ERROR_GEN_THREAD;
+			break;
+		} else {
+			++started;
+		}
+	}
+
+	for (size_t i = 0; i != started; ++i) {
+		pthread_join(threads[i], NULL);
+	}
+
+	for (size_t i = 0; !error && i != settings->fileCount; ++i) {
+		error = streams[i].error;
+	}
+
+	return gen_write_cleanup(error, &departments, &priorities, streams,
+	                         threads);
+}
+
+const char* gen_error_to_string(error_t error) {
+	switch (error) {
+		case ERROR_GEN_INVALID_ZIPF_DOMAIN:
+			return "Too many values for a skewed distribution";
+		case ERROR_GEN_THREAD:
+			return "Can't start a generator thread";
+		default:
+			return NULL;
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "lib/error.h"
+
+#define ERROR_GEN_INVALID_ZIPF_DOMAIN 0x50000001
+#define ERROR_GEN_THREAD 0x50000002
+
+/** Size of the output buffer of a single generator stream, in bytes. */
+#define GEN_BUFFER_SIZE ((size_t)1 << 20)
+/** Largest value domain a Zipf distribution table may be built for. */
+#define GEN_MAX_ZIPF_DOMAIN ((size_t)1 << 24)
+/** Mean duration of a burst in the bursty arrival process, in seconds. */
+#define GEN_BURST_MEAN_DURATION 600.0
+/** Fraction of time spent in bursts in the bursty arrival process. */
+#define GEN_BURST_TIME_FRACTION 0.1
+
+typedef enum gen_arrival {
+	/** Arrival times are uniformly random, sorted afterwards. */
+	GEN_ARRIVAL_UNIFORM,
+	/** Arrivals follow a Poisson process. */
+	GEN_ARRIVAL_POISSON,
+	/** Arrivals follow a Poisson process alternating between a quiet and a
+	 * burst rate (Markov-modulated Poisson process). */
+	GEN_ARRIVAL_BURSTY
+} gen_arrival_t;
+
+typedef struct gen_settings {
+	/** Total amount of requests to generate. */
+	size_t requestCount;
+	/** Amount of departments (D0 ... Dn-1). */
+	size_t departmentCount;
+	/** Priorities are generated in [0; maxPriority]. */
+	unsigned maxPriority;
+
+	time_t startTime;
+	time_t endTime;
+
+	gen_arrival_t arrival;
+	/** Ratio between the burst and quiet arrival rates. */
+	double burstFactor;
+	/** Zipf exponent of department choice; 0 is uniform. */
+	double departmentSkew;
+	/** Zipf exponent of priorities, lower priorities being more frequent;
+	 * 0 is uniform. */
+	double prioritySkew;
+
+	uint64_t seed;
+	/** Amount of files the output is split across, written in parallel. */
+	size_t fileCount;
+} gen_settings_t;
+
+/** Cumulative distribution table of a Zipf distribution over [0; n). */
+typedef struct gen_zipf {
+	double* cdf;
+	size_t n;
+} gen_zipf_t;
+
+error_t gen_zipf_create(gen_zipf_t* zipf, size_t n, double s);
+
+void gen_zipf_destroy(gen_zipf_t* zipf);
+
+/**
+ * Generates requests into |files|. Every file receives its share of the
+ * requests, sorted by time, as an independent stream over the whole time
+ * range; files are written in parallel.
+ */
+error_t gen_write_requests(const gen_settings_t* settings, FILE* files[]);
+
+const char* gen_error_to_string(error_t error);
@@ -1,76 +1,207 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
-#include "lib/mth.h"
+#include "generator.h"
+#include "lib/convert.h"
 
-int main() {
-	size_t departmentCount = 2;
-	size_t maxPriority = 100;
+#define MAX_FILES 256
 
-	const char* isoStartTime = "2024-11-12 18:31:01";
-	const char* isoEndTime = "2025-11-12 18:31:01";
+void app_error_print(error_t error) {
+	error_fmt_t fmt[] = {&gen_error_to_string};
+	error_print_ex(error, fmt, sizeof(fmt) / sizeof(fmt[0]));
+}
 
-	time_t startTime;
-	time_t endTime;
+void print_usage(const char* prog) {
+	printf(
+	    "Usage: %s [options...]\n"
+	    "Options:\n"
+	    "  -n <count>: amount of requests (10000)\n"
+	    "  -d <count>: amount of departments (2)\n"
+	    "  -p <priority>: max priority (100)\n"
+	    "  -a <uniform|poisson|bursty>: arrival process (poisson)\n"
+	    "  -b <factor>: burst to quiet arrival rate ratio (10)\n"
+	    "  -z <exponent>: Zipf skew of department choice (0, uniform)\n"
+	    "  -y <exponent>: Zipf skew of priorities, towards 0 (0, uniform)\n"
+	    "  -s <seed>: RNG seed (current time)\n"
+	    "  -j <count>: amount of files to write in parallel (1)\n"
+	    "  -o <prefix>: output file prefix (requests)\n",
+	    prog);
+}
 
-	struct tm tm;
+error_t parse_time(const char* iso, time_t* out) {
+	struct tm tm = {0};
 	tm.tm_isdst = -1;
 
-	char* pend = strptime(isoStartTime, "%Y-%m-%d %H:%M:%S", &tm);
-	if (!pend || *pend != '\0') {
-		fprintf(stderr, "Invalid start time.\n");
-		return 1;
-	}
+	char* pend = strptime(iso, "%Y-%m-%d %H:%M:%S", &tm);
+	if (!pend || *pend != '\0') return ERROR_INVALID_PARAMETER;
 
-	startTime = mktime(&tm);
+	*out = mktime(&tm);
+	return 0;
+}
 
-	pend = strptime(isoEndTime, "%Y-%m-%d %H:%M:%S", &tm);
-	if (!pend || *pend != '\0') {
-		fprintf(stderr, "Invalid end time.\n");
-		return 2;
+error_t parse_args(int argc, char* argv[], gen_settings_t* settings,
+                   const char** prefix) {
+	for (int i = 1; i < argc; i += 2) {
+		const char* flag = argv[i];
+		char* value = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if ((*flag != '-' && *flag != '/') || !flag[1] || flag[2] || !value) {
+			return ERROR_UNRECOGNIZED_OPTION;
+		}
+
+		error_t error = 0;
+		unsigned long number;
+
+		switch (flag[1]) {
+			case 'n':
+				error = str_to_ulong(value, &settings->requestCount);
+				break;
+			case 'd':
+				error = str_to_ulong(value, &settings->departmentCount);
+				if (!error && !settings->departmentCount) {
+					error = ERROR_INVALID_PARAMETER;
+				}
+				break;
+			case 'p':
+				error = str_to_ulong(value, &number);
+				if (!error && number > UINT32_MAX) error = ERROR_OVERFLOW;
+				settings->maxPriority = (unsigned)number;
+				break;
+			case 'a':
+				if (strcmp(value, "uniform") == 0)
+					settings->arrival = GEN_ARRIVAL_UNIFORM;
+				else if (strcmp(value, "poisson") == 0)
+					settings->arrival = GEN_ARRIVAL_POISSON;
+				else if (strcmp(value, "bursty") == 0)
+					settings->arrival = GEN_ARRIVAL_BURSTY;
+				else
+					error = ERROR_INVALID_PARAMETER;
+				break;
+			case 'b':
+				error = str_to_double(value, &settings->burstFactor);
+				if (!error && settings->burstFactor < 1.0) {
+					error = ERROR_INVALID_PARAMETER;
+				}
+				break;
+			case 'z':
+				error = str_to_double(value, &settings->departmentSkew);
+				if (!error && settings->departmentSkew < 0.0) {
+					error = ERROR_INVALID_PARAMETER;
+				}
+				break;
+			case 'y':
+				error = str_to_double(value, &settings->prioritySkew);
+				if (!error && settings->prioritySkew < 0.0) {
+					error = ERROR_INVALID_PARAMETER;
+				}
+				break;
+			case 's':
+				error = str_to_ulong(value, &number);
+				settings->seed = number;
+				break;
+			case 'j':
+				error = str_to_ulong(value, &settings->fileCount);
+				if (!error && (!settings->fileCount ||
+				               settings->fileCount > MAX_FILES)) {
+					error = ERROR_INVALID_PARAMETER;
+				}
+				break;
+			case 'o':
+				*prefix = value;
+				break;
+			default:
+				return ERROR_UNRECOGNIZED_OPTION;
+		}
+
+		if (error) {
+			fprintf(stderr, "Invalid value for %s: %s\n", flag, value);
+			return error;
+		}
 	}
 
-	endTime = mktime(&tm);
+	return 0;
+}
 
-	FILE* requestFile = fopen("requests.txt", "w");
-	if (!requestFile) {
-		fprintf(stderr, "Can't open requests file for writing.\n");
-		return 3;
+int cleanup(int exitCode, FILE* files[], size_t nFiles) {
+	for (size_t i = 0; i != nFiles; ++i) {
+		if (files[i]) fclose(files[i]);
 	}
 
-	srand(time(NULL));
+	free(files);
+	return exitCode;
+}
 
-	size_t requestCount = /*mth_rand(10, 100)*/ 10000;
+int main(int argc, char* argv[]) {
+	error_t error;
+
+	gen_settings_t settings = {.requestCount = 10000,
+	                           .departmentCount = 2,
+	                           .maxPriority = 100,
+	                           .arrival = GEN_ARRIVAL_POISSON,
+	                           .burstFactor = 10.0,
+	                           .departmentSkew = 0.0,
+	                           .prioritySkew = 0.0,
+	                           .seed = (uint64_t)time(NULL),
+	                           .fileCount = 1};
+	const char* prefix = "requests";
+
+	error = parse_args(argc, argv, &settings, &prefix);
+	if (error) {
+		app_error_print(error);
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	if (parse_time("2024-11-12 18:31:01", &settings.startTime)) {
+		fprintf(stderr, "Invalid start time.\n");
+		return 1;
+	}
+	if (parse_time("2025-11-12 18:31:01", &settings.endTime)) {
+		fprintf(stderr, "Invalid end time.\n");
+		return 2;
+	}
 
-	for (size_t i = 0; i != requestCount; ++i) {
-		time_t time = mth_rand(startTime, endTime);
+	FILE** files = (FILE**)calloc(settings.fileCount, sizeof(FILE*));
+	if (!files) {
+		fprintf(stderr, "Out of memory.\n");
+		return 3;
+	}
 
-		char isoTime[128];
-		strftime(isoTime, sizeof(isoTime), "%Y-%m-%d %H:%M:%S",
-		         localtime(&time));
+	for (size_t i = 0; i != settings.fileCount; ++i) {
+		char path[4096];
 
-		// Write request datetime.
-		fprintf(requestFile, "%s ", isoTime);
+		// A single file keeps the old name, "requests.txt".
+		if (settings.fileCount == 1) {
+			snprintf(path, sizeof(path), "%s.txt", prefix);
+		} else {
+			snprintf(path, sizeof(path), "%s-%zu.txt", prefix, i);
+		}
 
-		// Write priority number.
-		unsigned priority = mth_rand(0, maxPriority + 1);
-		fprintf(requestFile, "%u ", priority);
+		files[i] = fopen(path, "w");
+		if (!files[i]) {
+			fprintf(stderr, "Can't open %s for writing.\n", path);
+			return cleanup(3, files, settings.fileCount);
+		}
+	}
 
-		// Write department ID.
-		size_t department = mth_rand(0, departmentCount);
-		fprintf(requestFile, "D%zu ", department);
+	error = gen_write_requests(&settings, files);
+	if (error) {
+		app_error_print(error);
+		fprintf(stderr, "Can't write to request file.\n");
+		return cleanup(4, files, settings.fileCount);
+	}
 
-		// Write request text.
-		fprintf(requestFile, "\"doesn't matter\"\n");
+	for (size_t i = 0; i != settings.fileCount; ++i) {
+		FILE* file = files[i];
+		files[i] = NULL;
 
-		if (ferror(requestFile)) {
+		if (fclose(file)) {
 			fprintf(stderr, "Can't write to request file.\n");
-
-			fclose(requestFile);
-			return 4;
+			return cleanup(4, files, settings.fileCount);
 		}
 	}
 
-	fclose(requestFile);
+	return cleanup(0, files, settings.fileCount);
 }
@@ -0,0 +1,155 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/** Header placed before every counted allocation to remember its size. */
+typedef union bench_alloc_header {
+	size_t size;
+	max_align_t align;
+} bench_alloc_header_t;
+
+static bench_alloc_stats_t stats = {0};
+
+static void bench_alloc_track(size_t size) {
+	++stats.allocs;
+	stats.liveBytes += size;
+	if (stats.liveBytes > stats.peakBytes) stats.peakBytes = stats.liveBytes;
+}
+
+void* bench_malloc(size_t size) {
+	bench_alloc_header_t* header =
+	    (bench_alloc_header_t*)malloc(sizeof(bench_alloc_header_t) + size);
+	if (!header) return NULL;
+
+	header->size = size;
+	bench_alloc_track(size);
+
+	return header + 1;
+}
+
+void* bench_calloc(size_t count, size_t size) {
+	if (size && count > SIZE_MAX / size) return NULL;
+
+	void* ptr = bench_malloc(count * size);
+	if (ptr) memset(ptr, 0, count * size);
+
+	return ptr;
+}
+
+void* bench_realloc(void* ptr, size_t size) {
+	if (!ptr) return bench_malloc(size);
+
+	bench_alloc_header_t* header = (bench_alloc_header_t*)ptr - 1;
+	size_t oldSize = header->size;
+
+	header = (bench_alloc_header_t*)realloc(
+	    header, sizeof(bench_alloc_header_t) + size);
+	if (!header) return NULL;
+
+	header->size = size;
+	stats.liveBytes -= oldSize;
+	bench_alloc_track(size);
+
+	return header + 1;
+}
+
+void bench_free(void* ptr) {
+	if (!ptr) return;
+
+	bench_alloc_header_t* header = (bench_alloc_header_t*)ptr - 1;
+
+	++stats.frees;
+	stats.liveBytes -= header->size;
+
+	free(header);
+}
+
+char* bench_strdup(const char* string) {
+	size_t size = strlen(string) + 1;
+
+	char* copy = (char*)bench_malloc(size);
+	if (copy) memcpy(copy, string, size);
+
+	return copy;
+}
+
+void bench_alloc_reset(void) {
+	stats.allocs = 0;
+	stats.frees = 0;
+	stats.peakBytes = stats.liveBytes;
+}
+
+bench_alloc_stats_t bench_alloc_stats(void) { return stats; }
+
+uint64_t bench_now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+bench_counter_t bench_counter_open(void) {
+	bench_counter_t counter = {.fd = -1};
+
+#ifdef __linux__
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	counter.fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+	if (counter.fd < 0) counter.fd = -1;
+#endif
+
+	return counter;
+}
+
+bool bench_counter_available(const bench_counter_t* counter) {
+	return counter->fd >= 0;
+}
+
+void bench_counter_start(bench_counter_t* counter) {
+#ifdef __linux__
+	if (counter->fd < 0) return;
+
+	ioctl(counter->fd, PERF_EVENT_IOC_RESET, 0);
+	ioctl(counter->fd, PERF_EVENT_IOC_ENABLE, 0);
+#else
+	(void)counter;
+#endif
+}
+
+uint64_t bench_counter_stop(bench_counter_t* counter) {
+#ifdef __linux__
+	if (counter->fd < 0) return 0;
+
+	ioctl(counter->fd, PERF_EVENT_IOC_DISABLE, 0);
+
+	uint64_t value;
+	if (read(counter->fd, &value, sizeof(value)) != sizeof(value)) return 0;
+	return value;
+#else
+	(void)counter;
+	return 0;
+#endif
+}
+
+void bench_counter_close(bench_counter_t* counter) {
+#ifdef __linux__
+	if (counter->fd >= 0) close(counter->fd);
+#endif
+	counter->fd = -1;
+}
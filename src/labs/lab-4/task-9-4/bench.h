@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Benchmarking utilities. Sources of the simulator (task-9-1) and the
+ * interpreter (task-2) are compiled into this target; the simulator's data
+ * structures, and the collections the benchmarks instantiate themselves,
+ * have malloc/calloc/realloc/free redirected to the counting allocator
+ * below, see CMakeLists.txt.
+ */
+
+/** Each measurement covers at least this many items (or operations). */
+#define BENCH_MIN_ITEMS ((size_t)1 << 22)
+
+typedef struct bench_alloc_stats {
+	/** Amount of malloc/calloc/realloc calls. */
+	size_t allocs;
+	/** Amount of free calls. */
+	size_t frees;
+	/** Bytes currently allocated. */
+	size_t liveBytes;
+	/** Most bytes allocated at once. */
+	size_t peakBytes;
+} bench_alloc_stats_t;
+
+void* bench_malloc(size_t size);
+
+void* bench_calloc(size_t count, size_t size);
+
+void* bench_realloc(void* ptr, size_t size);
+
+void bench_free(void* ptr);
+
+char* bench_strdup(const char* string);
+
+/** Resets the counters. Live bytes are kept, the peak is reset to them. */
+void bench_alloc_reset(void);
+
+bench_alloc_stats_t bench_alloc_stats(void);
+
+/**
+ * Returns how many times to repeat a measurement over |n| items to cover
+ * |BENCH_MIN_ITEMS|, at least once.
+ */
+static inline size_t bench_repeats(size_t n) {
+	return n && n < BENCH_MIN_ITEMS ? BENCH_MIN_ITEMS / n : 1;
+}
+
+/** Returns a monotonic timestamp, in nanoseconds. */
+uint64_t bench_now_ns(void);
+
+/** Hardware cache miss counter; unavailable outside Linux or without
+ * permissions for perf events. */
+typedef struct bench_counter {
+	int fd;
+} bench_counter_t;
+
+bench_counter_t bench_counter_open(void);
+
+bool bench_counter_available(const bench_counter_t* counter);
+
+void bench_counter_start(bench_counter_t* counter);
+
+/** Stops the counter and returns the amount of misses since the start. */
+uint64_t bench_counter_stop(bench_counter_t* counter);
+
+void bench_counter_close(bench_counter_t* counter);
+
+/** Returns the next value of a xorshift64* generator. */
+static inline uint64_t bench_rand(uint64_t* state) {
+	uint64_t x = *state;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*state = x;
+	return x * 0x2545F4914F6CDD1Dull;
+}
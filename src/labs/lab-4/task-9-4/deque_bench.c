@@ -0,0 +1,115 @@
+#include "deque_bench.h"
+
+#include <stdint.h>
+
+#include "bench.h"
+#include "lib/collections/deque.h"
+
+/** Items moved at once by the bulk workload. */
+#define DEQUE_BENCH_CHUNK 64
+
+DEFINE_DEQUE(deque_bench_t, int64_t, bench)
+IMPL_DEQUE(deque_bench_t, int64_t, bench)
+
+typedef enum deque_workload {
+	/** Push |n| items, then pop all of them, like the simulator's queue. */
+	DEQUE_WORKLOAD_FILL_DRAIN,
+	/** Keep |n| items queued, pushing one for every one popped. */
+	DEQUE_WORKLOAD_STREAM,
+	/** Fill and drain |DEQUE_BENCH_CHUNK| items at a time. */
+	DEQUE_WORKLOAD_BULK
+} deque_workload_t;
+
+static const char* DEQUE_WORKLOAD_NAMES[] = {"fill-drain", "stream", "bulk"};
+
+/**
+ * Moves |rounds| times |n| items through |d| as |workload| does; false if
+ * the deque fails to grow.
+ */
+static bool deque_bench_churn(deque_bench_t* d, deque_workload_t workload,
+                              size_t n, size_t rounds) {
+	int64_t chunk[DEQUE_BENCH_CHUNK];
+	int64_t item;
+
+	for (size_t i = 0; i != DEQUE_BENCH_CHUNK; ++i) chunk[i] = (int64_t)i;
+
+	switch (workload) {
+		case DEQUE_WORKLOAD_FILL_DRAIN:
+			for (size_t round = 0; round != rounds; ++round) {
+				for (size_t i = 0; i != n; ++i) {
+					if (!deque_bench_push_back(d, (int64_t)i)) return false;
+				}
+				while (deque_bench_pop_front(d, &item)) continue;
+			}
+			break;
+		case DEQUE_WORKLOAD_STREAM:
+			for (size_t i = 0; i != n; ++i) {
+				if (!deque_bench_push_back(d, (int64_t)i)) return false;
+			}
+			for (size_t i = 0; i != rounds * n; ++i) {
+				if (!deque_bench_push_back(d, (int64_t)i)) return false;
+				deque_bench_pop_front(d, &item);
+			}
+			while (deque_bench_pop_front(d, &item)) continue;
+			break;
+		case DEQUE_WORKLOAD_BULK:
+			for (size_t round = 0; round != rounds; ++round) {
+				for (size_t i = 0; i < n; i += DEQUE_BENCH_CHUNK) {
+					size_t count = n - i;
+					if (count > DEQUE_BENCH_CHUNK) count = DEQUE_BENCH_CHUNK;
+
+					if (!deque_bench_push_back_n(d, chunk, count)) return false;
+				}
+				while (deque_bench_pop_front_n(d, chunk, DEQUE_BENCH_CHUNK))
+					continue;
+			}
+			break;
+	}
+
+	return true;
+}
+
+error_t deque_bench_run(size_t maxCount, FILE* out) {
+	if (!maxCount || !out) return ERROR_INVALID_PARAMETER;
+
+	fprintf(out, "%-10s %-7s %10s %12s %14s\n", "workload", "shrink", "items",
+	        "ns per item", "allocs per 1k");
+
+	for (int workload = DEQUE_WORKLOAD_FILL_DRAIN;
+	     workload <= DEQUE_WORKLOAD_BULK; ++workload) {
+		for (int policy = DEQUE_SHRINK_NEVER; policy <= DEQUE_SHRINK_QUARTER;
+		     ++policy) {
+			for (size_t n = 16; n <= maxCount; n *= 4) {
+				size_t rounds = bench_repeats(n);
+				// Every round pushes and pops |n| items; the stream also
+				// fills and drains the deque once.
+				size_t ops = 2 * n *
+				             (rounds + (workload == DEQUE_WORKLOAD_STREAM));
+
+				deque_bench_t d = deque_bench_create();
+				deque_bench_set_shrink_policy(&d,
+				                              (deque_shrink_policy_t)policy);
+
+				bench_alloc_reset();
+				uint64_t start = bench_now_ns();
+
+				bool pushed = deque_bench_churn(&d, (deque_workload_t)workload,
+				                                n, rounds);
+
+				uint64_t elapsed = bench_now_ns() - start;
+				bench_alloc_stats_t stats = bench_alloc_stats();
+
+				deque_bench_destroy(&d);
+				if (!pushed) return ERROR_OUT_OF_MEMORY;
+
+				fprintf(out, "%-10s %-7s %10zu %12.2f %14.3f\n",
+				        DEQUE_WORKLOAD_NAMES[workload],
+				        policy == DEQUE_SHRINK_NEVER ? "never" : "quarter", n,
+				        (double)elapsed / (double)ops,
+				        1000.0 * (double)stats.allocs / (double)ops);
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "lib/error.h"
+
+/**
+ * Streams items through FIFO deques holding up to |maxCount| items and prints
+ * the time and reallocations per operation.
+ */
+error_t deque_bench_run(size_t maxCount, FILE* out);
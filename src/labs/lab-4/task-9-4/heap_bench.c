@@ -0,0 +1,329 @@
+#include "heap_bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "heap.h"
+
+/** Names of the heap backends, indexed by |heap_type_t|. */
+static const char* HEAP_NAMES[] = {"HEAP_BINARY",    "HEAP_BINOMIAL",
+                                   "HEAP_FIBONACCI", "HEAP_LEFTIST",
+                                   "HEAP_SKEW",      "HEAP_TREAP"};
+
+/** Priorities of synthetic requests are in [0; SYNTHETIC_MAX_PRIORITY]. */
+static const unsigned SYNTHETIC_MAX_PRIORITY = 100;
+
+IMPL_VECTOR(vector_heap_op_t, heap_op_t, heap_op, {NULL})
+
+static heap_trace_t heap_trace_create(const char* name, size_t heapCount) {
+	heap_trace_t trace = {.heapCount = heapCount,
+	                      .ops = vector_heap_op_create(),
+	                      .requests = NULL,
+	                      .requestCount = 0};
+	snprintf(trace.name, sizeof(trace.name), "%s", name);
+
+	return trace;
+}
+
+void heap_trace_destroy(heap_trace_t* trace) {
+	if (!trace) return;
+
+	vector_heap_op_destroy(&trace->ops);
+	free(trace->requests);
+	trace->requests = NULL;
+	trace->requestCount = 0;
+}
+
+/** Appends an insert of a new request into |heap|. */
+static error_t heap_trace_insert(heap_trace_t* trace, size_t* requestCap,
+                                 size_t heap, unsigned priority, time_t time) {
+	if (trace->requestCount == *requestCap) {
+		size_t capacity = *requestCap ? *requestCap * 2 : 1024;
+
+		request_t* requests = (request_t*)realloc(
+		    trace->requests, capacity * sizeof(request_t));
+		if (!requests) return ERROR_OUT_OF_MEMORY;
+
+		trace->requests = requests;
+		*requestCap = capacity;
+	}
+
+	size_t idx = trace->requestCount++;
+	trace->requests[idx] = (request_t){.id = idx,
+	                                   .time = time,
+	                                   .priority = priority,
+	                                   .departmentId = NULL,
+	                                   .text = NULL,
+	                                   .requiredTime = 0};
+
+	heap_op_t op = {.type = HEAP_OP_INSERT, .heap = heap, .arg = idx};
+	return vector_heap_op_push_back(&trace->ops, op) ? 0 : ERROR_OUT_OF_MEMORY;
+}
+
+static error_t heap_trace_push(heap_trace_t* trace, heap_op_type_t type,
+                               size_t heap, size_t arg) {
+	heap_op_t op = {.type = type, .heap = heap, .arg = arg};
+	return vector_heap_op_push_back(&trace->ops, op) ? 0 : ERROR_OUT_OF_MEMORY;
+}
+
+static error_t heap_trace_fail(error_t error, heap_trace_t* trace,
+                               char* line) {
+	heap_trace_destroy(trace);
+	free(line);
+
+	return error;
+}
+
+error_t heap_trace_from_file(FILE* stream, const char* name,
+                             heap_trace_t* out) {
+	if (!stream || !name || !out) return ERROR_INVALID_PARAMETER;
+
+	error_t error;
+
+	*out = heap_trace_create(name, 0);
+
+	// Sizes of the heaps, to validate pops.
+	size_t* sizes = NULL;
+	size_t requestCap = 0;
+
+	char* line = NULL;
+	size_t cap;
+
+	while (getline(&line, &cap, stream) > 0) {
+		size_t a, b;
+		unsigned priority;
+		long long time;
+
+		if (!sizes) {
+			// The header declares the amount of heaps.
+			if (sscanf(line, "D %zu", &a) != 1 || !a) break;
+
+			sizes = (size_t*)calloc(a, sizeof(size_t));
+			if (!sizes) return heap_trace_fail(ERROR_OUT_OF_MEMORY, out, line);
+
+			out->heapCount = a;
+			continue;
+		}
+
+		if (sscanf(line, "I %zu %u %lld", &a, &priority, &time) == 3 &&
+		    a < out->heapCount) {
+			error = heap_trace_insert(out, &requestCap, a, priority,
+			                          (time_t)time);
+			++sizes[a];
+		} else if (sscanf(line, "P %zu", &a) == 1 && a < out->heapCount &&
+		           sizes[a]) {
+			error = heap_trace_push(out, HEAP_OP_POP, a, 0);
+			--sizes[a];
+		} else if (sscanf(line, "M %zu %zu", &a, &b) == 2 &&
+		           a < out->heapCount && b < out->heapCount && a != b) {
+			error = heap_trace_push(out, HEAP_OP_MELD, a, b);
+			sizes[b] += sizes[a];
+			sizes[a] = 0;
+		} else {
+			error = ERROR_BENCH_INVALID_TRACE;
+		}
+
+		if (error) {
+			free(sizes);
+			return heap_trace_fail(error, out, line);
+		}
+	}
+
+	free(sizes);
+
+	if (ferror(stream)) return heap_trace_fail(ERROR_IO, out, line);
+	if (!out->heapCount) {
+		return heap_trace_fail(ERROR_BENCH_INVALID_TRACE, out, line);
+	}
+
+	free(line);
+	return 0;
+}
+
+error_t heap_trace_fill_drain(size_t opCount, uint64_t seed,
+                              heap_trace_t* out) {
+	if (!out) return ERROR_INVALID_PARAMETER;
+
+	error_t error = 0;
+	size_t requestCap = 0;
+
+	*out = heap_trace_create("fill-drain", 1);
+
+	for (size_t i = 0; !error && i < opCount / 2; ++i) {
+		unsigned priority = bench_rand(&seed) % (SYNTHETIC_MAX_PRIORITY + 1);
+		error = heap_trace_insert(out, &requestCap, 0, priority, (time_t)i);
+	}
+	for (size_t i = 0; !error && i < opCount / 2; ++i) {
+		error = heap_trace_push(out, HEAP_OP_POP, 0, 0);
+	}
+
+	if (error) heap_trace_destroy(out);
+	return error;
+}
+
+error_t heap_trace_steady(size_t opCount, uint64_t seed, heap_trace_t* out) {
+	if (!out) return ERROR_INVALID_PARAMETER;
+
+	error_t error = 0;
+	size_t requestCap = 0;
+	size_t size = 0;
+
+	*out = heap_trace_create("steady", 1);
+
+	// Prefill a tenth of the operations, then keep the size around it.
+	for (size_t i = 0; !error && i != opCount; ++i) {
+		bool insert = i < opCount / 10 || !size || bench_rand(&seed) % 2;
+
+		if (insert) {
+			unsigned priority =
+			    bench_rand(&seed) % (SYNTHETIC_MAX_PRIORITY + 1);
+			error = heap_trace_insert(out, &requestCap, 0, priority, (time_t)i);
+			++size;
+		} else {
+			error = heap_trace_push(out, HEAP_OP_POP, 0, 0);
+			--size;
+		}
+	}
+
+	if (error) heap_trace_destroy(out);
+	return error;
+}
+
+error_t heap_trace_meld(size_t opCount, uint64_t seed, heap_trace_t* out) {
+	if (!out) return ERROR_INVALID_PARAMETER;
+
+	// Heaps are drained once they grow past |HEAP_LIMIT|, like departments
+	// whose operators keep up with the load.
+	enum { HEAPS = 8, MELD_PERIOD = 64, HEAP_LIMIT = 1024 };
+
+	error_t error = 0;
+	size_t requestCap = 0;
+	size_t sizes[HEAPS] = {0};
+
+	*out = heap_trace_create("meld", HEAPS);
+
+	for (size_t i = 0; !error && i != opCount; ++i) {
+		size_t heap = bench_rand(&seed) % HEAPS;
+
+		if (i % MELD_PERIOD == MELD_PERIOD - 1) {
+			size_t to = (heap + 1 + bench_rand(&seed) % (HEAPS - 1)) % HEAPS;
+
+			error = heap_trace_push(out, HEAP_OP_MELD, heap, to);
+			sizes[to] += sizes[heap];
+			sizes[heap] = 0;
+		} else if (sizes[heap] &&
+		           (sizes[heap] >= HEAP_LIMIT || bench_rand(&seed) % 2)) {
+			error = heap_trace_push(out, HEAP_OP_POP, heap, 0);
+			--sizes[heap];
+		} else {
+			unsigned priority =
+			    bench_rand(&seed) % (SYNTHETIC_MAX_PRIORITY + 1);
+			error =
+			    heap_trace_insert(out, &requestCap, heap, priority, (time_t)i);
+			++sizes[heap];
+		}
+	}
+
+	if (error) heap_trace_destroy(out);
+	return error;
+}
+
+static error_t heap_bench_replay(const heap_trace_t* trace, heap_t** heaps) {
+	error_t error = 0;
+
+	for (size_t i = 0; !error && i != trace->ops.size; ++i) {
+		const heap_op_t* op = &trace->ops.buffer[i];
+
+		switch (op->type) {
+			case HEAP_OP_INSERT:
+				error =
+				    heap_insert(heaps[op->heap], &trace->requests[op->arg]);
+				break;
+			case HEAP_OP_POP: {
+				request_t* request;
+				error = heap_pop_max(heaps[op->heap], &request);
+				break;
+			}
+			case HEAP_OP_MELD:
+				error = heap_meld(heaps[op->heap], heaps[op->arg]);
+				break;
+		}
+	}
+
+	return error;
+}
+
+static error_t heap_bench_cleanup(error_t error, heap_t** heaps,
+                                  size_t count) {
+	for (size_t i = 0; i != count; ++i) {
+		heap_destroy(heaps[i]);
+	}
+	free(heaps);
+
+	return error;
+}
+
+error_t heap_bench_run(const heap_trace_t* trace, FILE* out) {
+	if (!trace || !out) return ERROR_INVALID_PARAMETER;
+
+	bench_counter_t counter = bench_counter_open();
+
+	for (size_t type = 0; type != HEAP_VTABLE_COUNT; ++type) {
+		heap_t** heaps = (heap_t**)calloc(trace->heapCount, sizeof(heap_t*));
+		if (!heaps) return ERROR_OUT_OF_MEMORY;
+
+		bench_alloc_reset();
+		size_t baseBytes = bench_alloc_stats().liveBytes;
+
+		for (size_t i = 0; i != trace->heapCount; ++i) {
+			heaps[i] = heap_create((heap_type_t)type);
+			if (!heaps[i]) {
+				bench_counter_close(&counter);
+				return heap_bench_cleanup(ERROR_OUT_OF_MEMORY, heaps, i);
+			}
+		}
+
+		bench_counter_start(&counter);
+		uint64_t start = bench_now_ns();
+
+		error_t error = heap_bench_replay(trace, heaps);
+
+		uint64_t elapsed = bench_now_ns() - start;
+		uint64_t misses = bench_counter_stop(&counter);
+
+		bench_alloc_stats_t stats = bench_alloc_stats();
+		heap_bench_cleanup(0, heaps, trace->heapCount);
+
+		if (error) {
+			bench_counter_close(&counter);
+			return error;
+		}
+
+		double ops = trace->ops.size ? (double)trace->ops.size : 1.0;
+
+		fprintf(out, "%-12s %-16s %10.1f ", trace->name, HEAP_NAMES[type],
+		        (double)elapsed / ops);
+
+		if (bench_counter_available(&counter)) {
+			fprintf(out, "%12.3f ", (double)misses / ops);
+		} else {
+			fprintf(out, "%12s ", "n/a");
+		}
+
+		fprintf(out, "%10zu %12.1f\n", stats.allocs,
+		        (double)(stats.peakBytes - baseBytes) / 1024.0);
+	}
+
+	bench_counter_close(&counter);
+	return 0;
+}
+
+const char* heap_bench_error_to_string(error_t error) {
+	switch (error) {
+		case ERROR_BENCH_INVALID_TRACE:
+			return "Malformed heap trace";
+		default:
+			return NULL;
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "lib/collections/vector.h"
+#include "lib/error.h"
+#include "request.h"
+
+#define ERROR_BENCH_INVALID_TRACE 0x60000001
+
+typedef enum heap_op_type {
+	HEAP_OP_INSERT,
+	HEAP_OP_POP,
+	HEAP_OP_MELD
+} heap_op_type_t;
+
+typedef struct heap_op {
+	heap_op_type_t type;
+	/** Heap the operation is applied to; the source heap of a meld. */
+	size_t heap;
+	/** Request index for an insert; the target heap of a meld. */
+	size_t arg;
+} heap_op_t;
+
+DEFINE_VECTOR(vector_heap_op_t, heap_op_t, heap_op)
+
+/** Sequence of heap operations over a set of heaps. */
+typedef struct heap_trace {
+	char name[64];
+	size_t heapCount;
+	vector_heap_op_t ops;
+	/** Requests referenced by inserts. */
+	request_t* requests;
+	size_t requestCount;
+} heap_trace_t;
+
+void heap_trace_destroy(heap_trace_t* trace);
+
+/**
+ * Reads a trace recorded by the simulator (MODEL_HEAP_TRACE) from |stream|.
+ *
+ * @return `ERROR_BENCH_INVALID_TRACE` if the trace is malformed.
+ */
+error_t heap_trace_from_file(FILE* stream, const char* name,
+                             heap_trace_t* out);
+
+/** Inserts random requests into a single heap, then pops all of them. */
+error_t heap_trace_fill_drain(size_t opCount, uint64_t seed,
+                              heap_trace_t* out);
+
+/** Random inserts and pops on a single heap of a stable size. */
+error_t heap_trace_steady(size_t opCount, uint64_t seed, heap_trace_t* out);
+
+/** Inserts and pops over several heaps, periodically melding one into
+ * another, like overloaded departments do. */
+error_t heap_trace_meld(size_t opCount, uint64_t seed, heap_trace_t* out);
+
+/** Replays |trace| against every heap backend and prints the results. */
+error_t heap_bench_run(const heap_trace_t* trace, FILE* out);
+
+const char* heap_bench_error_to_string(error_t error);
@@ -0,0 +1,262 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "deque_bench.h"
+#include "heap.h"
+#include "heap_bench.h"
+#include "lib/convert.h"
+#include "lib/error.h"
+#include "ring_bench.h"
+#include "shuffle_bench.h"
+#include "sort_bench.h"
+#include "storage_bench.h"
+#include "vector_bench.h"
+
+typedef error_t (*opt_handler_t)(int argc, char** argv);
+
+typedef struct opt {
+	char name[16];
+	char args[64];
+	char desc[256];
+	opt_handler_t handler;
+} opt_t;
+
+void app_error_print(error_t error) {
+	error_fmt_t fmt[] = {&heap_error_to_string, &heap_bench_error_to_string,
+	                      &storage_bench_error_to_string,
+	                      &sort_bench_error_to_string};
+	error_print_ex(error, fmt, sizeof(fmt) / sizeof(fmt[0]));
+}
+
+error_t parse_opt(const char* flag, opt_t opts[], int nOpts, opt_t* outOpt) {
+	if (*flag != '-' && *flag != '/') return ERROR_INVALID_PARAMETER;
+	++flag;
+
+	for (int i = 0; i != nOpts; ++i) {
+		if (strncmp(opts[i].name, flag, 16) == 0) {
+			*outOpt = opts[i];
+			return 0;
+		}
+	}
+
+	return ERROR_UNRECOGNIZED_OPTION;
+}
+
+void print_opts(opt_t opts[], int nOpts) {
+	for (int i = 0; i != nOpts; ++i) {
+		opt_t opt = opts[i];
+		fprintf(stdout, "  /%s, -%s %s: %s\n", opt.name, opt.name, opt.args,
+		        opt.desc);
+	}
+}
+
+error_t bench_heap_trace(heap_trace_t* trace) {
+	error_t error = heap_bench_run(trace, stdout);
+	heap_trace_destroy(trace);
+
+	return error;
+}
+
+error_t cmd_heap(int argc, char** argv) {
+	// <prog> <flag> <ops> [trace files...]
+	if (argc < 3) {
+		fprintf(stderr, "Invalid arguments. See usage for more info.\n");
+		return 0;
+	}
+
+	error_t error;
+	unsigned long opCount;
+
+	if (str_to_ulong(argv[2], &opCount) || !opCount) {
+		fprintf(stderr, "Invalid `ops`: malformed number or zero.\n");
+		return 0;
+	}
+
+	printf("%-12s %-16s %10s %12s %10s %12s\n", "trace", "backend", "ns/op",
+	       "misses/op", "allocs", "peak KiB");
+
+	for (int i = 3; i < argc; ++i) {
+		FILE* file = fopen(argv[i], "r");
+		if (!file) {
+			fprintf(stderr, "Can't open %s for reading.\n", argv[i]);
+			return ERROR_IO;
+		}
+
+		// Name the trace after the file, without its directory.
+		const char* name = strrchr(argv[i], '/');
+		name = name ? name + 1 : argv[i];
+
+		heap_trace_t trace;
+		error = heap_trace_from_file(file, name, &trace);
+		fclose(file);
+
+		if (error || (error = bench_heap_trace(&trace))) return error;
+	}
+
+	uint64_t seed = (uint64_t)time(NULL) | 1;
+
+	error_t (*synthetic[])(size_t, uint64_t, heap_trace_t*) = {
+	    &heap_trace_fill_drain, &heap_trace_steady, &heap_trace_meld};
+
+	for (size_t i = 0; i != sizeof(synthetic) / sizeof(synthetic[0]); ++i) {
+		heap_trace_t trace;
+
+		if ((error = synthetic[i](opCount, seed, &trace)) ||
+		    (error = bench_heap_trace(&trace))) {
+			return error;
+		}
+	}
+
+	return 0;
+}
+
+error_t cmd_storage(int argc, char** argv) {
+	// <prog> <flag> <max keys>
+	if (argc != 3) {
+		fprintf(stderr, "Invalid arguments. See usage for more info.\n");
+		return 0;
+	}
+
+	// Lookups per measurement.
+	static const size_t LOOKUP_COUNT = 1000000;
+	// Key counts grow by this factor from the first one.
+	static const size_t KEY_COUNT_MIN = 4, KEY_COUNT_STEP = 4;
+
+	error_t error;
+	unsigned long maxKeys;
+
+	if (str_to_ulong(argv[2], &maxKeys) || maxKeys < KEY_COUNT_MIN) {
+		fprintf(stderr,
+		        "Invalid `max keys`: malformed number or less than %zu.\n",
+		        KEY_COUNT_MIN);
+		return 0;
+	}
+
+	printf("%-9s %9s  %-22s %10s %10s %12s %10s %12s\n", "shape", "keys",
+	       "backend", "put ns", "get ns", "misses/get", "allocs", "peak KiB");
+
+	uint64_t seed = (uint64_t)time(NULL) | 1;
+
+	for (int shape = KEY_SHAPE_DEPT; shape <= KEY_SHAPE_PREFIXED; ++shape) {
+		for (size_t count = KEY_COUNT_MIN; count <= maxKeys;
+		     count *= KEY_COUNT_STEP) {
+			storage_keys_t keys;
+
+			error = storage_keys_generate((storage_key_shape_t)shape, count,
+			                              seed, &keys);
+			if (error) return error;
+
+			error = storage_bench_run(&keys, LOOKUP_COUNT, seed, stdout);
+			storage_keys_destroy(&keys);
+
+			if (error) return error;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Parses `<prog> <flag> <count>` into |out|, printing why it can't be parsed
+ * otherwise. |what| names the count in the message.
+ */
+bool parse_count(int argc, char** argv, const char* what, unsigned long* out) {
+	if (argc != 3) {
+		fprintf(stderr, "Invalid arguments. See usage for more info.\n");
+		return false;
+	}
+
+	if (str_to_ulong(argv[2], out) || !*out) {
+		fprintf(stderr, "Invalid `%s`: malformed number or zero.\n", what);
+		return false;
+	}
+
+	return true;
+}
+
+error_t cmd_sort(int argc, char** argv) {
+	unsigned long n;
+	if (!parse_count(argc, argv, "max items", &n)) return 0;
+	return sort_bench_run(n, (uint64_t)time(NULL) | 1, stdout);
+}
+
+error_t cmd_shuffle(int argc, char** argv) {
+	unsigned long n;
+	if (!parse_count(argc, argv, "max items", &n)) return 0;
+	return shuffle_bench_run(n, (uint64_t)time(NULL) | 1, stdout);
+}
+
+error_t cmd_vector(int argc, char** argv) {
+	unsigned long n;
+	if (!parse_count(argc, argv, "max items", &n)) return 0;
+	return vector_bench_run(n, stdout);
+}
+
+error_t cmd_deque(int argc, char** argv) {
+	unsigned long n;
+	if (!parse_count(argc, argv, "max items", &n)) return 0;
+	return deque_bench_run(n, stdout);
+}
+
+error_t cmd_ring(int argc, char** argv) {
+	unsigned long n;
+	if (!parse_count(argc, argv, "items", &n)) return 0;
+	return ring_bench_run(n, stdout);
+}
+
+error_t main_(int argc, char** argv) {
+	opt_t opts[] = {
+	    {"heap", "<ops> [trace files...]",
+	     "replays simulator traces (MODEL_HEAP_TRACE) and synthetic mixes of "
+	     "<ops> operations against every heap backend",
+	     &cmd_heap},
+	    {"storage", "<max keys>",
+	     "measures put/get throughput and memory of every storage backend "
+	     "for key counts up to <max keys> and several key shapes; `*` marks "
+	     "the backend STORAGE_AUTO picks",
+	     &cmd_storage},
+	    {"sort", "<max items>",
+	     "compares qsort with the interpreter's (lab-4/task-2) introsort and "
+	     "radix sort for arrays of up to <max items> integers",
+	     &cmd_sort},
+	    {"shuffle", "<max items>",
+	     "times the interpreter's shuffles for arrays of up to <max items> "
+	     "integers and tests that they are uniform",
+	     &cmd_shuffle},
+	    {"vector", "<max items>",
+	     "times filling and draining or clearing vectors of up to <max items> "
+	     "integers and counts their reallocations",
+	     &cmd_vector},
+	    {"deque", "<max items>",
+	     "streams integers through FIFO deques of up to <max items> items, "
+	     "with and without shrinking, and counts their reallocations",
+	     &cmd_deque},
+	    {"ring", "<items>",
+	     "streams <items> integers through SPSC and MPMC rings with several "
+	     "threads and batch sizes, and checks that none are lost or reordered",
+	     &cmd_ring}};
+	int nOpts = sizeof(opts) / sizeof(opt_t);
+
+	if (argc == 1) {
+		printf("Usage: %s <flag> <...>\nFlags:\n", argv[0]);
+		print_opts(opts, nOpts);
+		return 0;
+	}
+
+	opt_t opt;
+
+	error_t error = parse_opt(argv[1], opts, nOpts, &opt);
+	if (error) return error;
+
+	return opt.handler(argc, argv);
+}
+
+int main(int argc, char** argv) {
+	error_t error = main_(argc, argv);
+	if (error) {
+		app_error_print(error);
+		return error;
+	}
+}
@@ -0,0 +1,250 @@
+#include "ring_bench.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bench.h"
+#include "lib/collections/ring.h"
+
+/** Capacity of the benchmarked rings. */
+static const size_t RING_BENCH_CAPACITY = 1024;
+
+/** Most threads on either side of a ring. */
+#define RING_BENCH_MAX_THREADS 4
+
+/** Items moved at once in the batched runs. */
+#define RING_BENCH_BATCH 32
+
+/** Items carry their producer in the upper bits and their number below. */
+#define RING_BENCH_PRODUCER_SHIFT 48
+
+typedef enum ring_kind { RING_KIND_SPSC, RING_KIND_MPMC } ring_kind_t;
+
+static const char* RING_KIND_NAMES[] = {"spsc", "mpmc"};
+
+typedef struct ring_bench {
+	ring_kind_t kind;
+	spsc_ring_u64_t spsc;
+	mpmc_ring_u64_t mpmc;
+	/** Items to move at once. */
+	size_t batch;
+	/** Items each producer pushes. */
+	size_t perProducer;
+	size_t producers;
+	/** Items popped by all consumers so far. */
+	atomic_size_t popped;
+	size_t total;
+	/** Set when a thread failed to start, to stop the others. */
+	atomic_bool stopped;
+} ring_bench_t;
+
+typedef struct ring_worker {
+	ring_bench_t* bench;
+	size_t index;
+	/** Consumers: amount of items popped, and the next number expected
+	 * from each producer. */
+	size_t popped;
+	uint64_t next[RING_BENCH_MAX_THREADS];
+	/** Consumers: whether a producer's items arrived out of order. */
+	bool reordered;
+} ring_worker_t;
+
+static size_t ring_bench_push_n(ring_bench_t* b, const uint64_t* items,
+                                size_t count) {
+	return b->kind == RING_KIND_SPSC
+	           ? spsc_ring_u64_push_n(&b->spsc, items, count)
+	           : mpmc_ring_u64_push_n(&b->mpmc, items, count);
+}
+
+static size_t ring_bench_pop_n(ring_bench_t* b, uint64_t* out, size_t count) {
+	return b->kind == RING_KIND_SPSC
+	           ? spsc_ring_u64_pop_n(&b->spsc, out, count)
+	           : mpmc_ring_u64_pop_n(&b->mpmc, out, count);
+}
+
+static void* ring_bench_producer(void* arg) {
+	ring_worker_t* w = (ring_worker_t*)arg;
+	ring_bench_t* b = w->bench;
+
+	uint64_t items[RING_BENCH_BATCH];
+	uint64_t tag = (uint64_t)w->index << RING_BENCH_PRODUCER_SHIFT;
+
+	for (size_t i = 0; i != b->perProducer;) {
+		size_t n = b->perProducer - i < b->batch ? b->perProducer - i
+		                                         : b->batch;
+		for (size_t j = 0; j != n; ++j) items[j] = tag | (i + j);
+
+		// Retry the rest of the batch while the ring is full.
+		for (size_t sent = 0; sent != n;) {
+			size_t pushed = ring_bench_push_n(b, items + sent, n - sent);
+			if (!pushed) {
+				if (atomic_load_explicit(&b->stopped, memory_order_relaxed)) {
+					return NULL;
+				}
+				sched_yield();
+			}
+			sent += pushed;
+		}
+
+		i += n;
+	}
+
+	return NULL;
+}
+
+static void* ring_bench_consumer(void* arg) {
+	ring_worker_t* w = (ring_worker_t*)arg;
+	ring_bench_t* b = w->bench;
+
+	uint64_t items[RING_BENCH_BATCH];
+
+	while (atomic_load_explicit(&b->popped, memory_order_relaxed) !=
+	       b->total) {
+		size_t n = ring_bench_pop_n(b, items, b->batch);
+		if (!n) {
+			if (atomic_load_explicit(&b->stopped, memory_order_relaxed)) {
+				return NULL;
+			}
+			sched_yield();
+			continue;
+		}
+
+		atomic_fetch_add_explicit(&b->popped, n, memory_order_relaxed);
+		w->popped += n;
+
+		for (size_t j = 0; j != n; ++j) {
+			size_t producer = items[j] >> RING_BENCH_PRODUCER_SHIFT;
+			uint64_t number =
+			    items[j] & ((1ull << RING_BENCH_PRODUCER_SHIFT) - 1);
+
+			// A consumer sees every producer's items in increasing order,
+			// though not all of them.
+			if (producer >= b->producers || number < w->next[producer]) {
+				w->reordered = true;
+			} else {
+				w->next[producer] = number + 1;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Starts a thread per worker, stopping at the first that fails. Returns the
+ * amount of threads started.
+ */
+static size_t ring_bench_start(pthread_t* threads, ring_worker_t* workers,
+                               size_t count, void* (*routine)(void*)) {
+	size_t t = 0;
+	while (t != count &&
+	       pthread_create(&threads[t], NULL, routine, &workers[t]) == 0) {
+		++t;
+	}
+
+	return t;
+}
+
+static void ring_bench_join(pthread_t* threads, size_t count) {
+	for (size_t t = 0; t != count; ++t) pthread_join(threads[t], NULL);
+}
+
+static error_t ring_bench_one(ring_kind_t kind, size_t producers,
+                              size_t consumers, size_t batch, size_t count,
+                              FILE* out) {
+	ring_bench_t b = {.kind = kind,
+	                  .batch = batch,
+	                  .perProducer = count / producers,
+	                  .producers = producers,
+	                  .total = count / producers * producers};
+	atomic_init(&b.popped, 0);
+	atomic_init(&b.stopped, false);
+
+	bool created = kind == RING_KIND_SPSC
+	                   ? spsc_ring_u64_create(&b.spsc, RING_BENCH_CAPACITY)
+	                   : mpmc_ring_u64_create(&b.mpmc, RING_BENCH_CAPACITY);
+	if (!created) return ERROR_OUT_OF_MEMORY;
+
+	ring_worker_t producerWorkers[RING_BENCH_MAX_THREADS] = {0};
+	ring_worker_t consumerWorkers[RING_BENCH_MAX_THREADS] = {0};
+	pthread_t producerThreads[RING_BENCH_MAX_THREADS];
+	pthread_t consumerThreads[RING_BENCH_MAX_THREADS];
+
+	for (size_t t = 0; t != RING_BENCH_MAX_THREADS; ++t) {
+		producerWorkers[t] = (ring_worker_t){.bench = &b, .index = t};
+		consumerWorkers[t] = (ring_worker_t){.bench = &b, .index = t};
+	}
+
+	uint64_t start = bench_now_ns();
+
+	size_t consumersStarted = ring_bench_start(
+	    consumerThreads, consumerWorkers, consumers, &ring_bench_consumer);
+	size_t producersStarted =
+	    consumersStarted != consumers
+	        ? 0
+	        : ring_bench_start(producerThreads, producerWorkers, producers,
+	                           &ring_bench_producer);
+
+	// Producers and consumers wait on each other, so the work of a missing
+	// thread can't be run inline: stop the run instead.
+	bool started = producersStarted == producers;
+	if (!started) {
+		atomic_store_explicit(&b.stopped, true, memory_order_relaxed);
+	}
+
+	ring_bench_join(producerThreads, producersStarted);
+	ring_bench_join(consumerThreads, consumersStarted);
+
+	uint64_t elapsed = bench_now_ns() - start;
+
+	size_t popped = 0;
+	bool reordered = false;
+	for (size_t t = 0; t != consumers; ++t) {
+		popped += consumerWorkers[t].popped;
+		reordered |= consumerWorkers[t].reordered;
+	}
+
+	if (kind == RING_KIND_SPSC) {
+		spsc_ring_u64_destroy(&b.spsc);
+	} else {
+		mpmc_ring_u64_destroy(&b.mpmc);
+	}
+
+	// Creating a thread fails for lack of resources.
+	if (!started) return ERROR_OUT_OF_MEMORY;
+
+	const char* check = reordered           ? "REORDERED"
+	                    : popped != b.total ? "LOST"
+	                                        : "ok";
+
+	fprintf(out, "%-6s %4zux%-4zu %6zu %12.2f  %s\n", RING_KIND_NAMES[kind],
+	        producers, consumers, batch,
+	        (double)b.total * 1000.0 / (double)elapsed, check);
+
+	return popped == b.total && !reordered ? 0 : ERROR_ASSERT;
+}
+
+error_t ring_bench_run(size_t count, FILE* out) {
+	if (!count || !out) return ERROR_INVALID_PARAMETER;
+
+	fprintf(out, "%-6s %9s %6s %12s  %s\n", "ring", "threads", "batch",
+	        "M items/s", "check");
+
+	size_t batches[] = {1, RING_BENCH_BATCH};
+	error_t error = 0;
+
+	for (size_t i = 0; !error && i != sizeof(batches) / sizeof(batches[0]);
+	     ++i) {
+		error = ring_bench_one(RING_KIND_SPSC, 1, 1, batches[i], count, out);
+
+		for (size_t threads = 1;
+		     !error && threads <= RING_BENCH_MAX_THREADS; threads *= 2) {
+			error = ring_bench_one(RING_KIND_MPMC, threads, threads,
+			                       batches[i], count, out);
+		}
+	}
+
+	return error;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "lib/error.h"
+
+/**
+ * Streams |count| items through SPSC and MPMC rings with growing amounts of
+ * producer and consumer threads, one item or a batch at a time. Prints the
+ * throughput and checks that every item arrives once and that the items of
+ * each producer arrive in order.
+ */
+error_t ring_bench_run(size_t count, FILE* out);
@@ -0,0 +1,203 @@
+#include "shuffle_bench.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "shuffle.h"
+
+/** The qsort-based shuffle is O(n log n) calls to rand(), skip large arrays. */
+static const size_t SHUFFLE_BENCH_QSORT_LIMIT = 1 << 22;
+
+/** Threads of the parallel shuffle in the uniformity tests. */
+static const size_t SHUFFLE_TEST_THREADS = 4;
+
+/** Comparator of the shuffle SHUFFLE used to have. */
+static int shuffle_bench_compare_random(const void* a, const void* b) {
+	(void)a;
+	(void)b;
+	return rand() % 3 - 1;
+}
+
+typedef enum shuffle_kind {
+	SHUFFLE_KIND_QSORT,
+	SHUFFLE_KIND_FISHER_YATES,
+	SHUFFLE_KIND_PARALLEL
+} shuffle_kind_t;
+
+static const char* SHUFFLE_KIND_NAMES[] = {"qsort", "fisher-yates",
+                                           "parallel"};
+
+static error_t shuffle_bench_apply(shuffle_kind_t kind, int64_t* data,
+                                   size_t n, rng_t* rng, size_t threads) {
+	switch (kind) {
+		case SHUFFLE_KIND_QSORT:
+			qsort(data, n, sizeof(int64_t), &shuffle_bench_compare_random);
+			return 0;
+		case SHUFFLE_KIND_FISHER_YATES:
+			shuffle_i64_fisher_yates(data, n, rng);
+			return 0;
+		case SHUFFLE_KIND_PARALLEL:
+			return shuffle_i64_parallel(data, n, rng_next(rng), threads)
+			           ? 0
+			           : ERROR_OUT_OF_MEMORY;
+	}
+
+	return ERROR_INVALID_PARAMETER;
+}
+
+/** Upper 0.1% quantile of the chi-squared distribution (Wilson-Hilferty). */
+static double shuffle_chi2_critical(double df) {
+	const double z = 3.090;
+	double k = 2.0 / (9.0 * df);
+	return df * pow(1.0 - k + z * sqrt(k), 3);
+}
+
+/** Index of a permutation of 0..n-1 among all n! (Lehmer code). */
+static size_t shuffle_perm_index(const int64_t* perm, size_t n) {
+	size_t index = 0;
+
+	for (size_t i = 0; i != n; ++i) {
+		size_t smaller = 0;
+		for (size_t j = i + 1; j != n; ++j) {
+			smaller += perm[j] < perm[i];
+		}
+		index = index * (n - i) + smaller;
+	}
+
+	return index;
+}
+
+/**
+ * Shuffles 5 items many times and tests that all 120 permutations are
+ * equally likely, then shuffles 64 items and tests that every item lands at
+ * every position equally often.
+ */
+static error_t shuffle_bench_uniformity(shuffle_kind_t kind, uint64_t seed,
+                                        FILE* out) {
+	enum { PERM_ITEMS = 5, PERMS = 120, PERM_TRIALS = 120000 };
+	enum { POS_ITEMS = 64, POS_TRIALS = 20000 };
+
+	rng_t rng = rng_create(seed);
+	error_t error;
+
+	size_t permCounts[PERMS] = {0};
+	int64_t perm[PERM_ITEMS];
+
+	for (size_t trial = 0; trial != PERM_TRIALS; ++trial) {
+		for (size_t i = 0; i != PERM_ITEMS; ++i) perm[i] = (int64_t)i;
+
+		error = shuffle_bench_apply(kind, perm, PERM_ITEMS, &rng,
+		                            SHUFFLE_TEST_THREADS);
+		if (error) return error;
+
+		++permCounts[shuffle_perm_index(perm, PERM_ITEMS)];
+	}
+
+	double expected = (double)PERM_TRIALS / PERMS;
+	double chi2 = 0;
+	for (size_t i = 0; i != PERMS; ++i) {
+		double d = (double)permCounts[i] - expected;
+		chi2 += d * d / expected;
+	}
+
+	double critical = shuffle_chi2_critical(PERMS - 1);
+	fprintf(out, "%-14s %-12s %12.1f %12.1f  %s\n", SHUFFLE_KIND_NAMES[kind],
+	        "permutations", chi2, critical, chi2 < critical ? "ok" : "BIASED");
+
+	size_t(*posCounts)[POS_ITEMS] =
+	    calloc(POS_ITEMS, sizeof(size_t[POS_ITEMS]));
+	int64_t* items = malloc(POS_ITEMS * sizeof(int64_t));
+	if (!posCounts || !items) {
+		free(posCounts);
+		free(items);
+		return ERROR_OUT_OF_MEMORY;
+	}
+
+	for (size_t trial = 0; trial != POS_TRIALS; ++trial) {
+		for (size_t i = 0; i != POS_ITEMS; ++i) items[i] = (int64_t)i;
+
+		error = shuffle_bench_apply(kind, items, POS_ITEMS, &rng,
+		                            SHUFFLE_TEST_THREADS);
+		if (error) break;
+
+		for (size_t pos = 0; pos != POS_ITEMS; ++pos) {
+			++posCounts[items[pos]][pos];
+		}
+	}
+
+	if (!error) {
+		expected = (double)POS_TRIALS / POS_ITEMS;
+		chi2 = 0;
+		for (size_t i = 0; i != POS_ITEMS; ++i) {
+			for (size_t pos = 0; pos != POS_ITEMS; ++pos) {
+				double d = (double)posCounts[i][pos] - expected;
+				chi2 += d * d / expected;
+			}
+		}
+
+		critical = shuffle_chi2_critical((POS_ITEMS - 1) * (POS_ITEMS - 1));
+		fprintf(out, "%-14s %-12s %12.1f %12.1f  %s\n",
+		        SHUFFLE_KIND_NAMES[kind], "positions", chi2, critical,
+		        chi2 < critical ? "ok" : "BIASED");
+	}
+
+	free(posCounts);
+	free(items);
+
+	return error;
+}
+
+error_t shuffle_bench_run(size_t maxCount, uint64_t seed, FILE* out) {
+	if (!maxCount || !out) return ERROR_INVALID_PARAMETER;
+
+	int64_t* data = (int64_t*)malloc(maxCount * sizeof(int64_t));
+	if (!data) return ERROR_OUT_OF_MEMORY;
+
+	rng_t rng = rng_create(seed);
+	srand((unsigned)seed);
+
+	size_t threads = shuffle_thread_count();
+	error_t error = 0;
+
+	fprintf(out, "%-14s %10s %12s  (%zu threads)\n", "shuffle", "items",
+	        "ns/item", threads);
+
+	for (size_t n = 16; !error && n <= maxCount; n *= 4) {
+		for (size_t i = 0; i != n; ++i) data[i] = (int64_t)i;
+
+		size_t reps = bench_repeats(n);
+
+		for (int kind = SHUFFLE_KIND_QSORT;
+		     !error && kind <= SHUFFLE_KIND_PARALLEL; ++kind) {
+			if (kind == SHUFFLE_KIND_QSORT && n > SHUFFLE_BENCH_QSORT_LIMIT) {
+				continue;
+			}
+
+			uint64_t start = bench_now_ns();
+			for (size_t rep = 0; !error && rep != reps; ++rep) {
+				error = shuffle_bench_apply((shuffle_kind_t)kind, data, n,
+				                            &rng, threads);
+			}
+			double elapsed = (double)(bench_now_ns() - start);
+
+			fprintf(out, "%-14s %10zu %12.2f\n", SHUFFLE_KIND_NAMES[kind], n,
+			        elapsed / (double)(reps * n));
+		}
+	}
+
+	free(data);
+
+	if (error) return error;
+
+	fprintf(out, "\n%-14s %-12s %12s %12s\n", "shuffle", "test", "chi2",
+	        "p=0.001");
+
+	for (int kind = SHUFFLE_KIND_QSORT; !error && kind <= SHUFFLE_KIND_PARALLEL;
+	     ++kind) {
+		error = shuffle_bench_uniformity((shuffle_kind_t)kind, seed, out);
+	}
+
+	return error;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "lib/error.h"
+
+/**
+ * Times shuffling arrays of growing sizes, up to |maxCount| items, with the
+ * previous qsort-based shuffle, Fisher-Yates and the parallel shuffle, then
+ * runs chi-squared uniformity tests on all three.
+ */
+error_t shuffle_bench_run(size_t maxCount, uint64_t seed, FILE* out);
@@ -0,0 +1,139 @@
+#include "sort_bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "lib/collections/vector.h"
+#include "sort.h"
+
+typedef enum sort_dist {
+	SORT_DIST_RANDOM,
+	/** Values in [0; 1000). */
+	SORT_DIST_NARROW,
+	SORT_DIST_SORTED,
+	SORT_DIST_REVERSED
+} sort_dist_t;
+
+static const char* SORT_DIST_NAMES[] = {"random", "narrow", "sorted",
+                                        "reversed"};
+
+static void sort_bench_fill(int64_t* data, size_t n, sort_dist_t dist,
+                            uint64_t* seed) {
+	for (size_t i = 0; i != n; ++i) {
+		switch (dist) {
+			case SORT_DIST_RANDOM:
+				data[i] = (int64_t)bench_rand(seed);
+				break;
+			case SORT_DIST_NARROW:
+				data[i] = (int64_t)(bench_rand(seed) % 1000);
+				break;
+			case SORT_DIST_SORTED:
+				data[i] = (int64_t)i - (int64_t)(n / 2);
+				break;
+			case SORT_DIST_REVERSED:
+				data[i] = (int64_t)(n / 2) - (int64_t)i;
+				break;
+		}
+	}
+}
+
+typedef void (*sort_fn_t)(int64_t* data, size_t n, bool descending);
+
+static void sort_bench_radix(int64_t* data, size_t n, bool descending) {
+	if (!vector_i64_radix_sort(data, n, descending)) abort();
+}
+
+/** Returns the time per item of sorting copies of |source| |reps| times. */
+static double sort_bench_measure(sort_fn_t sort, const int64_t* source,
+                                 int64_t* data, size_t n, size_t reps,
+                                 bool descending, double copyNs) {
+	uint64_t start = bench_now_ns();
+
+	for (size_t rep = 0; rep != reps; ++rep) {
+		memcpy(data, source, n * sizeof(int64_t));
+		sort(data, n, descending);
+	}
+
+	double elapsed = (double)(bench_now_ns() - start) - copyNs;
+	return elapsed / (double)(reps * n);
+}
+
+error_t sort_bench_run(size_t maxCount, uint64_t seed, FILE* out) {
+	if (!maxCount || !out) return ERROR_INVALID_PARAMETER;
+
+	int64_t* source = (int64_t*)malloc(maxCount * sizeof(int64_t));
+	int64_t* data = (int64_t*)malloc(maxCount * sizeof(int64_t));
+	int64_t* expected = (int64_t*)malloc(maxCount * sizeof(int64_t));
+
+	if (!source || !data || !expected) {
+		free(source);
+		free(data);
+		free(expected);
+		return ERROR_OUT_OF_MEMORY;
+	}
+
+	error_t error = 0;
+
+	fprintf(out, "%-9s %10s %-5s %12s %12s %12s  %s\n", "dist", "items",
+	        "order", "qsort ns", "intro ns", "radix ns", "auto");
+
+	for (int dist = SORT_DIST_RANDOM; !error && dist <= SORT_DIST_REVERSED;
+	     ++dist) {
+		for (size_t n = 16; !error && n <= maxCount; n *= 4) {
+			sort_bench_fill(source, n, (sort_dist_t)dist, &seed);
+
+			size_t reps = bench_repeats(n);
+
+			// Time of the copies alone, subtracted from the sorts.
+			uint64_t start = bench_now_ns();
+			for (size_t rep = 0; rep != reps; ++rep) {
+				memcpy(data, source, n * sizeof(int64_t));
+			}
+			double copyNs = (double)(bench_now_ns() - start);
+
+			for (int descending = 0; !error && descending <= 1; ++descending) {
+				double qsortNs =
+				    sort_bench_measure(&sort_i64_qsort, source, expected, n,
+				                       reps, descending, copyNs);
+				double introNs =
+				    sort_bench_measure(&sort_i64_introsort, source, data, n,
+				                       reps, descending, copyNs);
+
+				if (memcmp(data, expected, n * sizeof(int64_t)) != 0) {
+					error = ERROR_BENCH_SORT_MISMATCH;
+					break;
+				}
+
+				double radixNs =
+				    sort_bench_measure(&sort_bench_radix, source, data, n,
+				                       reps, descending, copyNs);
+
+				if (memcmp(data, expected, n * sizeof(int64_t)) != 0) {
+					error = ERROR_BENCH_SORT_MISMATCH;
+					break;
+				}
+
+				fprintf(out, "%-9s %10zu %-5s %12.2f %12.2f %12.2f  %s\n",
+				        SORT_DIST_NAMES[dist], n, descending ? "desc" : "asc",
+				        qsortNs, introNs, radixNs,
+				        n >= VECTOR_RADIX_SORT_THRESHOLD ? "radix" : "intro");
+			}
+		}
+	}
+
+	free(source);
+	free(data);
+	free(expected);
+
+	return error;
+}
+
+const char* sort_bench_error_to_string(error_t error) {
+	switch (error) {
+		case ERROR_BENCH_SORT_MISMATCH:
+			return "Introsort or radix sort disagrees with qsort";
+		default:
+			return NULL;
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "lib/error.h"
+
+#define ERROR_BENCH_SORT_MISMATCH 0x60000003
+
+/**
+ * Sorts arrays of growing sizes, up to |maxCount| items, with the
+ * interpreter's qsort, introsort and radix sorts and prints the time per
+ * item.
+ *
+ * @return `ERROR_BENCH_SORT_MISMATCH` if the sorts disagree.
+ */
+error_t sort_bench_run(size_t maxCount, uint64_t seed, FILE* out);
+
+const char* sort_bench_error_to_string(error_t error);
@@ -0,0 +1,195 @@
+#include "storage_bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "department.h"
+#include "storage.h"
+
+/** Names of the storage backends, indexed by |storage_type_t|. */
+static const char* STORAGE_NAMES[] = {"STORAGE_BST", "STORAGE_DYNAMIC_ARRAY",
+                                      "STORAGE_HASHTABLE", "STORAGE_TRIE",
+                                      "STORAGE_FLAT_HASHTABLE"};
+
+/** Characters of random keys; every backend must accept them. */
+static const char KEY_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_";
+
+/**
+ * A trie node takes half a kilobyte, so a trie over random keys takes about
+ * that much per character. Tries with more characters than this are skipped.
+ */
+static const size_t TRIE_CHARACTER_LIMIT = 1 << 18;
+
+static const char* KEY_SHAPE_NAMES[] = {"dept", "short", "long", "prefixed"};
+
+error_t storage_keys_generate(storage_key_shape_t shape, size_t count,
+                              uint64_t seed, storage_keys_t* out) {
+	if (!out || !count) return ERROR_INVALID_PARAMETER;
+
+	// Longest key of any shape, with the terminator.
+	enum { MAX_KEY_SIZE = 48 };
+
+	*out = (storage_keys_t){.keys = NULL, .buffer = NULL, .count = count};
+	snprintf(out->name, sizeof(out->name), "%s", KEY_SHAPE_NAMES[shape]);
+
+	out->keys = (char**)malloc(count * sizeof(char*));
+	out->buffer = (char*)malloc(count * MAX_KEY_SIZE);
+	if (!out->keys || !out->buffer) {
+		storage_keys_destroy(out);
+		return ERROR_OUT_OF_MEMORY;
+	}
+
+	char* p = out->buffer;
+
+	for (size_t i = 0; i != count; ++i) {
+		int length = 0;
+
+		switch (shape) {
+			case KEY_SHAPE_DEPT:
+				length = snprintf(p, MAX_KEY_SIZE, "D%zu", i);
+				break;
+			case KEY_SHAPE_PREFIXED:
+				length = snprintf(p, MAX_KEY_SIZE, "DEPARTMENT_%zu", i);
+				break;
+			case KEY_SHAPE_SHORT:
+			case KEY_SHAPE_LONG: {
+				bool isShort = shape == KEY_SHAPE_SHORT;
+
+				length = isShort ? 4 + (int)(bench_rand(&seed) % 5)
+				                 : 24 + (int)(bench_rand(&seed) % 17);
+
+				for (int j = 0; j != length; ++j) {
+					p[j] = KEY_ALPHABET[bench_rand(&seed) %
+					                    (sizeof(KEY_ALPHABET) - 1)];
+				}
+				p[length] = '\0';
+				break;
+			}
+		}
+
+		out->keys[i] = p;
+		out->totalLength += length;
+		p += length + 1;
+	}
+
+	return 0;
+}
+
+void storage_keys_destroy(storage_keys_t* keys) {
+	if (!keys) return;
+
+	free(keys->keys);
+	free(keys->buffer);
+	keys->keys = NULL;
+	keys->buffer = NULL;
+	keys->count = 0;
+}
+
+static error_t storage_bench_backend(const storage_keys_t* keys,
+                                     const size_t* lookups, size_t lookupCount,
+                                     storage_type_t type,
+                                     bench_counter_t* counter, FILE* out) {
+	// Values are never dereferenced; lookups only check they're intact.
+	static department_t dummy;
+
+	bench_alloc_reset();
+	size_t baseBytes = bench_alloc_stats().liveBytes;
+
+	storage_t* storage = storage_create(type);
+	if (!storage) return ERROR_OUT_OF_MEMORY;
+
+	error_t error = 0;
+
+	uint64_t start = bench_now_ns();
+	for (size_t i = 0; !error && i != keys->count; ++i) {
+		error = storage_put(storage, keys->keys[i], &dummy);
+	}
+	uint64_t putElapsed = bench_now_ns() - start;
+
+	bench_alloc_stats_t stats = bench_alloc_stats();
+
+	if (error) {
+		storage_destroy(storage);
+		return error;
+	}
+
+	size_t found = 0;
+
+	bench_counter_start(counter);
+	start = bench_now_ns();
+
+	for (size_t i = 0; i != lookupCount; ++i) {
+		found += storage_get(storage, keys->keys[lookups[i]]) == &dummy;
+	}
+
+	uint64_t getElapsed = bench_now_ns() - start;
+	uint64_t misses = bench_counter_stop(counter);
+
+	storage_destroy(storage);
+
+	if (found != lookupCount) return ERROR_BENCH_STORAGE_MISMATCH;
+
+	size_t meanLength = keys->totalLength / keys->count;
+	bool isAuto = storage_auto_select(keys->count, meanLength) == type;
+
+	fprintf(out, "%-9s %9zu %c%-22s %10.1f %10.1f ", keys->name, keys->count,
+	        isAuto ? '*' : ' ', STORAGE_NAMES[type],
+	        (double)putElapsed / (double)keys->count,
+	        (double)getElapsed / (double)lookupCount);
+
+	if (bench_counter_available(counter)) {
+		fprintf(out, "%12.3f ", (double)misses / (double)lookupCount);
+	} else {
+		fprintf(out, "%12s ", "n/a");
+	}
+
+	fprintf(out, "%10zu %12.1f\n", stats.allocs,
+	        (double)(stats.peakBytes - baseBytes) / 1024.0);
+
+	return 0;
+}
+
+error_t storage_bench_run(const storage_keys_t* keys, size_t lookupCount,
+                          uint64_t seed, FILE* out) {
+	if (!keys || !keys->count || !lookupCount || !out) {
+		return ERROR_INVALID_PARAMETER;
+	}
+
+	// Draw the lookups up front to keep the generator out of the timings.
+	size_t* lookups = (size_t*)malloc(lookupCount * sizeof(size_t));
+	if (!lookups) return ERROR_OUT_OF_MEMORY;
+
+	for (size_t i = 0; i != lookupCount; ++i) {
+		lookups[i] = bench_rand(&seed) % keys->count;
+	}
+
+	bench_counter_t counter = bench_counter_open();
+	error_t error = 0;
+
+	for (size_t type = 0; !error && type != STORAGE_AUTO; ++type) {
+		if (type == STORAGE_TRIE && keys->totalLength > TRIE_CHARACTER_LIMIT) {
+			fprintf(out, "%-9s %9zu  %-22s %10s\n", keys->name, keys->count,
+			        STORAGE_NAMES[type], "skipped");
+			continue;
+		}
+
+		error = storage_bench_backend(keys, lookups, lookupCount,
+		                              (storage_type_t)type, &counter, out);
+	}
+
+	bench_counter_close(&counter);
+	free(lookups);
+
+	return error;
+}
+
+const char* storage_bench_error_to_string(error_t error) {
+	switch (error) {
+		case ERROR_BENCH_STORAGE_MISMATCH:
+			return "Storage backend lost a key";
+		default:
+			return NULL;
+	}
+}
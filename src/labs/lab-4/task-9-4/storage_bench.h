@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "lib/error.h"
+
+#define ERROR_BENCH_STORAGE_MISMATCH 0x60000002
+
+typedef enum storage_key_shape {
+	/** "D<n>", as generated by the simulator. */
+	KEY_SHAPE_DEPT,
+	/** Random keys of 4-8 characters. */
+	KEY_SHAPE_SHORT,
+	/** Random keys of 24-40 characters. */
+	KEY_SHAPE_LONG,
+	/** "DEPARTMENT_<n>": a long shared prefix and a short suffix. */
+	KEY_SHAPE_PREFIXED
+} storage_key_shape_t;
+
+typedef struct storage_keys {
+	char name[16];
+	/** Keys, pointing into |buffer|. */
+	char** keys;
+	char* buffer;
+	size_t count;
+	size_t totalLength;
+} storage_keys_t;
+
+error_t storage_keys_generate(storage_key_shape_t shape, size_t count,
+                              uint64_t seed, storage_keys_t* out);
+
+void storage_keys_destroy(storage_keys_t* keys);
+
+/**
+ * Puts |keys| into every storage backend, then looks up |lookupCount| random
+ * keys and prints the results. The backend |STORAGE_AUTO| resolves to is
+ * marked with an asterisk.
+ *
+ * @return `ERROR_BENCH_STORAGE_MISMATCH` if a backend loses a key.
+ */
+error_t storage_bench_run(const storage_keys_t* keys, size_t lookupCount,
+                          uint64_t seed, FILE* out);
+
+const char* storage_bench_error_to_string(error_t error);
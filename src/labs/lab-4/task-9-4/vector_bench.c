@@ -0,0 +1,81 @@
+#include "vector_bench.h"
+
+#include <stdint.h>
+
+#include "bench.h"
+#include "lib/collections/vector.h"
+
+DEFINE_VECTOR(vector_bench_t, int64_t, bench)
+IMPL_VECTOR(vector_bench_t, int64_t, bench, {NULL})
+
+typedef enum vector_workload {
+	/** Push |n| items, then pop all of them. */
+	VECTOR_WORKLOAD_FILL_DRAIN,
+	/** Push |n| items, then clear the vector. */
+	VECTOR_WORKLOAD_REFILL
+} vector_workload_t;
+
+static const char* VECTOR_WORKLOAD_NAMES[] = {"fill-drain", "refill"};
+
+/** Fills |v| with |n| items and empties it, |rounds| times; false if a push
+ * fails. */
+static bool vector_bench_churn(vector_bench_t* v, vector_workload_t workload,
+                               size_t n, size_t rounds) {
+	for (size_t round = 0; round != rounds; ++round) {
+		for (size_t i = 0; i != n; ++i) {
+			if (!vector_bench_push_back(v, (int64_t)i)) return false;
+		}
+
+		switch (workload) {
+			case VECTOR_WORKLOAD_FILL_DRAIN: {
+				int64_t item;
+				while (vector_bench_pop_back(v, &item)) continue;
+				break;
+			}
+			case VECTOR_WORKLOAD_REFILL:
+				vector_bench_clear(v);
+				break;
+		}
+	}
+
+	return true;
+}
+
+error_t vector_bench_run(size_t maxCount, FILE* out) {
+	if (!maxCount || !out) return ERROR_INVALID_PARAMETER;
+
+	fprintf(out, "%-10s %10s %12s %14s\n", "workload", "items", "ns per op",
+	        "allocs per 1k");
+
+	for (int workload = VECTOR_WORKLOAD_FILL_DRAIN;
+	     workload <= VECTOR_WORKLOAD_REFILL; ++workload) {
+		for (size_t n = 16; n <= maxCount; n *= 4) {
+			size_t rounds = bench_repeats(n);
+			// Pushes, plus a pop per item or a single clear.
+			size_t ops = rounds * (workload == VECTOR_WORKLOAD_REFILL
+			                           ? n + 1
+			                           : 2 * n);
+
+			vector_bench_t v = vector_bench_create();
+
+			bench_alloc_reset();
+			uint64_t start = bench_now_ns();
+
+			bool pushed =
+			    vector_bench_churn(&v, (vector_workload_t)workload, n, rounds);
+
+			uint64_t elapsed = bench_now_ns() - start;
+			bench_alloc_stats_t stats = bench_alloc_stats();
+
+			vector_bench_destroy(&v);
+			if (!pushed) return ERROR_OUT_OF_MEMORY;
+
+			fprintf(out, "%-10s %10zu %12.2f %14.3f\n",
+			        VECTOR_WORKLOAD_NAMES[workload], n,
+			        (double)elapsed / (double)ops,
+			        1000.0 * (double)stats.allocs / (double)ops);
+		}
+	}
+
+	return 0;
+}
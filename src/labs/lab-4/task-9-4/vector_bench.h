@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "lib/error.h"
+
+/**
+ * Runs fill/drain churn workloads on vectors of growing sizes, up to
+ * |maxCount| items, and prints the time and reallocations per operation.
+ */
+error_t vector_bench_run(size_t maxCount, FILE* out);
@@ -2,6 +2,15 @@
 
 const int DEQUE_MIN_CAPACITY = 4;
 
+size_t deque_capacity_for(size_t size) {
+	if (size > SIZE_MAX / 2 + 1) return 0;
+
+	size_t capacity = (size_t)DEQUE_MIN_CAPACITY;
+	while (capacity < size) capacity *= 2;
+
+	return capacity;
+}
+
 IMPL_DEQUE(deque_i64_t, int64_t, i64)
 IMPL_DEQUE(deque_i32_t, int32_t, i32)
 IMPL_DEQUE(deque_i16_t, int16_t, i16)
@@ -0,0 +1,13 @@
+#include "lib/collections/hashmap.h"
+
+const size_t HASHMAP_MIN_CAPACITY = 8;
+
+size_t hashmap_capacity_for(size_t count) {
+	// The slots are indexed by 32-bit hashes.
+	if (count > hashmap_max_size((size_t)UINT32_MAX + 1)) return 0;
+
+	size_t capacity = HASHMAP_MIN_CAPACITY;
+	while (count > hashmap_max_size(capacity)) capacity *= 2;
+
+	return capacity;
+}
@@ -0,0 +1,17 @@
+#include "lib/collections/ring.h"
+
+size_t ring_capacity_for(size_t capacity) {
+	if (capacity > SIZE_MAX / 2 + 1) return 0;
+
+	size_t rounded = 2;
+	while (rounded < capacity) rounded *= 2;
+
+	return rounded;
+}
+
+IMPL_SPSC_RING(spsc_ring_i64_t, int64_t, i64)
+IMPL_SPSC_RING(spsc_ring_u64_t, uint64_t, u64)
+IMPL_SPSC_RING(spsc_ring_ptr_t, void*, ptr)
+IMPL_MPMC_RING(mpmc_ring_i64_t, int64_t, i64)
+IMPL_MPMC_RING(mpmc_ring_u64_t, uint64_t, u64)
+IMPL_MPMC_RING(mpmc_ring_ptr_t, void*, ptr)
@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "lib/mth.h"
+#include "lib/strsimd.h"
 #include "lib/utils.h"
 
 /** Comparison function for |vector_str_t|, which takes multiple void
@@ -13,25 +14,52 @@ inline static int string_vector_compare(const void* p1, const void* p2) {
 
 IMPL_VECTOR(vector_str_t, string_t, str, {&string_vector_compare})
 
-bool string_enlarge(string_t* s, size_t size) {
-	if (!s->initialized) return false;
-	return vector_i8_ensure_capacity(&s->buffer,
-	                                 vector_i8_size(&s->buffer) + size);
-}
+bool string_grow(string_t* string, size_t capacity) {
+	if (!string->initialized) return false;
+	if (capacity <= string_capacity_(string)) return true;
+	if (capacity > SIZE_MAX / 2) return false;
 
-bool string_create(string_t* string) {
-	if (!string) return false;
+	size_t grown = string_capacity_(string) * 2;
+	if (grown < capacity) grown = capacity;
 
-	*string = (string_t){.buffer = vector_i8_create(), .initialized = false};
+	if (string->isLarge) {
+		char* chars = (char*)realloc(string->data.large.chars, grown + 1);
+		if (!chars) return false;
 
-	// Null-terminate the string by default.
-	if (vector_i8_push_back(&string->buffer, '\0')) {
-		string->initialized = true;
-		return true;
+		string->data.large.chars = chars;
 	} else {
-		string_destroy(string);
-		return false;
+		char* chars = (char*)malloc(grown + 1);
+		if (!chars) return false;
+
+		// Copy the short string out before its storage is overwritten.
+		memcpy(chars, string->data.small, string->length + 1);
+		string->data.large.chars = chars;
+		string->isLarge = true;
 	}
+
+	string->data.large.capacity = grown;
+	return true;
+}
+
+/** Appends |n| characters, which may belong to |string| if it has room. */
+static bool string_append_chars_(string_t* string, const char* chars,
+                                 size_t n) {
+	if (!string_grow(string, string->length + n)) return false;
+
+	char* dst = string_chars_(string);
+	if (n) memcpy(dst + string->length, chars, n);
+
+	string->length += n;
+	dst[string->length] = '\0';
+	return true;
+}
+
+bool string_create(string_t* string) {
+	if (!string) return false;
+
+	// Empty strings are short, and |data.small| is null-terminated.
+	*string = (string_t){.length = 0, .isLarge = false, .initialized = true};
+	return true;
 }
 
 bool string_from_c_str(string_t* string, const char* cStr) {
@@ -39,106 +67,82 @@ bool string_from_c_str(string_t* string, const char* cStr) {
 }
 
 void string_destroy(string_t* string) {
-	vector_i8_destroy(&string->buffer);
-	string->initialized = false;
+	if (string->isLarge) free(string->data.large.chars);
+	*string = (string_t){.initialized = false};
 }
 
-bool string_append_char(string_t* string, char c) {
-	if (!string->initialized) return false;
-
-	int8_t t;
-	return (vector_i8_pop_back(&string->buffer, &t) && t == '\0') &&
-	       vector_i8_push_back(&string->buffer, c) &&
-	       vector_i8_push_back(&string->buffer, '\0');
-}
+char* string_release(string_t* string) {
+	if (!string->initialized) return NULL;
 
-bool string_append_c_str(string_t* string, const char* cStr) {
-	if (!string->initialized || !cStr) return false;
+	char* chars = string->data.large.chars;
+	if (!string->isLarge) {
+		chars = (char*)malloc(string->length + 1);
+		if (!chars) return NULL;
 
-	// 1) Remove null-terminator.
-	int8_t t;
-	if (!vector_i8_pop_back(&string->buffer, &t) || t != '\0') {
-		return false;
+		memcpy(chars, string->data.small, string->length + 1);
 	}
 
-	// 2) Copy characters from |cStr| to |string| (including the null-term.)
-	char* ptr = (char*)cStr;
-
-	do {
-		if (!vector_i8_push_back(&string->buffer, *ptr)) {
-			return false;
-		}
-	} while (*(ptr++) != '\0');
+	// The characters are the caller's now.
+	*string = (string_t){.initialized = false};
+	return chars;
+}
 
-	return true;
+bool string_append_c_str(string_t* string, const char* cStr) {
+	if (!string->initialized || !cStr) return false;
+	return string_append_chars_(string, cStr, strlen(cStr));
 }
 
 bool string_append(string_t* string, string_t* other) {
 	if (!string->initialized || !other->initialized) return false;
 
-	// 1) Enlarge the string ahead of time.
-	// 2) Remove the null-terminator.
-	int8_t t;
-	if (!string_enlarge(string, string_length(other)) ||
-	    !vector_i8_pop_back(&string->buffer, &t) || t != '\0')
-		return false;
+	// Grow the string ahead of time: |other| may be |string|, and its
+	// characters must stay in place while they're copied.
+	if (!string_grow(string, string->length + other->length)) return false;
 
-	// 3) Copy characters from |other| to |string|.
-	for (size_t i = 0; i != string_length(other); i++) {
-		char ch = string_char_at(other, i);
-		if (!vector_i8_push_back(&string->buffer, ch)) return false;
-	}
-
-	// 4) Add the null-terminator.
-	if (!vector_i8_push_back(&string->buffer, '\0')) return false;
+	return string_append_chars_(string, string_chars_(other), other->length);
+}
 
-	return true;
+bool string_append_view(string_t* string, strview_t view) {
+	if (!string->initialized || (view.length && !view.chars)) return false;
+	return string_append_chars_(string, view.chars, view.length);
 }
 
 bool string_copy(string_t* src, string_t* dst) {
+	if (!src->initialized) return false;
+	if (src == dst) return true;
+
 	// Initialize |dst| if it's not initialized.
 	if (!string_created(dst)) {
 		if (!string_create(dst)) return false;
 	}
 
-	// Resize the dest buffer to fit the source string.
-	if (!vector_i8_ensure_capacity(&dst->buffer, vector_i8_size(&src->buffer)))
-		return false;
-
-	// Copy contents of |dst| into |src|.
-	memcpy((char*)vector_i8_to_array(&dst->buffer),
-	       (char*)vector_i8_to_array(&src->buffer),
-	       vector_i8_size(&src->buffer));
-
-	dst->buffer.size = src->buffer.size;
-	return true;
+	// Keeps the buffer of |dst| if the source string fits in it.
+	dst->length = 0;
+	return string_append_chars_(dst, string_chars_(src), src->length);
 }
 
 size_t string_length(string_t* s) {
-	// Account for the null-term.
-	return s->initialized ? vector_i8_size(&s->buffer) - 1 : 0;
+	return s->initialized ? s->length : 0;
 }
 
 const char* string_to_c_str(string_t* s) {
-	return s->initialized ? (const char*)vector_i8_to_array(&s->buffer) : NULL;
+	return s->initialized ? string_chars_(s) : NULL;
 }
 
 char string_char_at(string_t* s, size_t index) {
-	if (!s->initialized) return INT8_MAX;
-
-	char* ch = (char*)vector_i8_get(&s->buffer, index);
-	return (char)(ch == NULL ? INT8_MAX : *ch);
+	// The null-terminator can be read too.
+	if (!s->initialized || index > s->length) return INT8_MAX;
+	return string_chars_(s)[index];
 }
 
 void string_reverse(string_t* string) {
-	if (!string->initialized) return;
+	if (!string->initialized || string->length < 2) return;
 
-	vector_i8_t* buffer = &string->buffer;
-	int8_t* l = vector_i8_get(buffer, 0);
-	int8_t* r = vector_i8_get(buffer, string_length(string) - 1);
+	char* l = string_chars_(string);
+	char* r = l + string->length - 1;
 
 	for (; l < r; ++l, --r) {
-		SWAP(*l, *r, int8_t);
+		SWAP(*l, *r, char);
 	}
 }
 
@@ -154,53 +158,44 @@ int string_compare(const string_t* str1, const string_t* str2) {
 	const char* buf2 = string_to_c_str((string_t*)str2);
 	if (buf1 == buf2) return 0;
 
-	return mth_sign_long(strcmp(buf1, buf2));
+	size_t length = string_length((string_t*)str1);
+	size_t i = strsimd_mismatch(buf1, buf2, length);
+	if (i == length) return 0;
+
+	return (unsigned char)buf1[i] < (unsigned char)buf2[i] ? -1 : 1;
 }
 
 bool string_clear(string_t* string) {
 	if (!string || !string->initialized) return false;
-	return vector_i8_clear(&string->buffer) &&
-	       vector_i8_push_back(&string->buffer, '\0');
-}
-
-bool char_in_charset(char ch, const char* chars) {
-	for (char* p = (char*)chars; *p; ++p) {
-		if (*p == ch) return true;
-	}
 
-	return false;
+	// Keep the buffer for the next contents.
+	string->length = 0;
+	string_chars_(string)[0] = '\0';
+	return true;
 }
 
 bool string_strip0(string_t* string, const char* chars, bool leading,
                    bool trailing) {
 	if (!string || !string->initialized) return false;
-	if (!string_length(string)) return true;
+	if (!string->length) return true;
 
-	// Index of the first non-whitespace char
-	size_t first = 0;
-	// Index of the last non-whitespace char
-	size_t last = string_length(string) - 1;
+	char* buffer = string_chars_(string);
 
 	if (trailing) {
-		for (; last > 0; --last) {
-			if (!char_in_charset(string_char_at(string, last), chars)) break;
-		}
+		// Index of the last non-whitespace char, |length| if there's none.
+		size_t last = strsimd_rfind_not_set(buffer, string->length, chars);
 
-		*vector_i8_get(&string->buffer, last + 1) = '\0';
-		string->buffer.size = last + 2;  // Account for the '\0'
+		string->length = last == string->length ? 0 : last + 1;
+		buffer[string->length] = '\0';
 	}
 
 	if (leading) {
-		for (; first < string_length(string); ++first) {
-			if (!char_in_charset(string_char_at(string, first), chars)) break;
-		}
-
-		if (first) {
-			int8_t* buffer = (int8_t*)vector_i8_to_array(&string->buffer);
-			memmove(buffer, buffer + first,
-			        (vector_i8_size(&string->buffer) - first) * sizeof(int8_t));
-			string->buffer.size -= first;
-		}
+		// Index of the first non-whitespace char
+		size_t first = strsimd_find_not_set(buffer, string->length, chars);
+
+		// Moves the '\0' too.
+		memmove(buffer, buffer + first, string->length - first + 1);
+		string->length -= first;
 	}
 
 	return true;
@@ -217,3 +212,90 @@ bool string_lstrip(string_t* string, const char* chars) {
 bool string_rstrip(string_t* string, const char* chars) {
 	return string_strip0(string, chars, false, true);
 }
+
+strview_t strview_from_c_str(const char* cStr) {
+	return (strview_t){.chars = cStr, .length = cStr ? strlen(cStr) : 0};
+}
+
+strview_t strview_from_string(string_t* string) {
+	return (strview_t){.chars = string_to_c_str(string),
+	                   .length = string_length(string)};
+}
+
+bool strview_equals(strview_t a, strview_t b) {
+	if (a.length != b.length) return false;
+	return a.chars == b.chars || !a.length ||
+	       memcmp(a.chars, b.chars, a.length) == 0;
+}
+
+int strview_compare(strview_t a, strview_t b) {
+	size_t length = a.length < b.length ? a.length : b.length;
+
+	size_t i = length ? strsimd_mismatch(a.chars, b.chars, length) : 0;
+	if (i != length) {
+		return (unsigned char)a.chars[i] < (unsigned char)b.chars[i] ? -1 : 1;
+	}
+
+	// A prefix goes before the longer view.
+	if (a.length == b.length) return 0;
+	return a.length < b.length ? -1 : 1;
+}
+
+uint64_t strview_hash(strview_t view) {
+	static const uint64_t FNV_offset_basis = 0xcbf29ce484222325;
+	static const uint64_t FNV_prime = 0x100000001b3;
+
+	uint64_t hash = FNV_offset_basis;
+
+	for (size_t i = 0; i != view.length; ++i) {
+		hash ^= (unsigned char)view.chars[i];
+		hash *= FNV_prime;
+	}
+
+	return hash;
+}
+
+size_t strview_find(strview_t haystack, strview_t needle) {
+	if (needle.length > haystack.length) return SIZE_MAX;
+	if (!needle.length) return 0;
+
+	size_t i = strsimd_find(haystack.chars, haystack.length, needle.chars,
+	                        needle.length);
+	return i == haystack.length ? SIZE_MAX : i;
+}
+
+bool strview_split(strview_t* rest, char sep, strview_t* token) {
+	if (!rest || !token || !rest->chars) return false;
+
+	const char* end = (const char*)memchr(rest->chars, sep, rest->length);
+	if (!end) {
+		*token = *rest;
+		*rest = (strview_t){.chars = NULL, .length = 0};
+		return true;
+	}
+
+	*token = (strview_t){.chars = rest->chars,
+	                     .length = (size_t)(end - rest->chars)};
+	*rest = (strview_t){.chars = end + 1,
+	                    .length = rest->length - token->length - 1};
+	return true;
+}
+
+bool strview_next_token(strview_t* rest, const char* delims,
+                        strview_t* token) {
+	if (!rest || !delims || !token || !rest->chars) return false;
+
+	size_t first = strsimd_find_not_set(rest->chars, rest->length, delims);
+	size_t last = first + strsimd_find_set(rest->chars + first,
+	                                       rest->length - first, delims);
+
+	if (first == last) {
+		*rest = (strview_t){.chars = NULL, .length = 0};
+		return false;
+	}
+
+	*token = (strview_t){.chars = rest->chars + first, .length = last - first};
+	*rest = (strview_t){.chars = rest->chars + last,
+	                    .length = rest->length - last};
+	return true;
+}
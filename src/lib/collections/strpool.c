@@ -0,0 +1,164 @@
+#include "lib/collections/strpool.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t STRPOOL_BLOCK_SIZE = 4096;
+
+/** Number of slots in a new table. */
+#define STRPOOL_MIN_SLOTS 16
+
+strpool_t strpool_create(void) {
+	return (strpool_t){.strings = NULL,
+	                   .size = 0,
+	                   .capacity = 0,
+	                   .slots = NULL,
+	                   .slotCount = 0,
+	                   .head = NULL};
+}
+
+void strpool_destroy(strpool_t* pool) {
+	if (!pool) return;
+
+	strpool_block_t* block = pool->head;
+	while (block) {
+		strpool_block_t* next = block->next;
+		free(block);
+		block = next;
+	}
+
+	free(pool->strings);
+	free(pool->slots);
+	*pool = strpool_create();
+}
+
+/**
+ * Returns the slot holding |string|, or the empty slot where it belongs.
+ * The table must have an empty slot.
+ */
+static size_t strpool_slot_(const strpool_t* pool, strview_t string,
+                            uint64_t hash) {
+	size_t mask = pool->slotCount - 1;
+	size_t slot = (size_t)hash & mask;
+
+	while (pool->slots[slot] &&
+	       !strview_equals(pool->strings[pool->slots[slot] - 1], string)) {
+		slot = (slot + 1) & mask;
+	}
+
+	return slot;
+}
+
+/** Doubles the table, keeping it at most half full. */
+static bool strpool_grow_slots_(strpool_t* pool) {
+	size_t slotCount =
+	    pool->slotCount ? pool->slotCount * 2 : STRPOOL_MIN_SLOTS;
+
+	size_t* slots = (size_t*)calloc(slotCount, sizeof(size_t));
+	if (!slots) return false;
+
+	free(pool->slots);
+	pool->slots = slots;
+	pool->slotCount = slotCount;
+
+	// Interned strings are distinct, so each one takes the first empty slot.
+	for (size_t id = 0; id != pool->size; ++id) {
+		strview_t string = pool->strings[id];
+		pool->slots[strpool_slot_(pool, string, strview_hash(string))] =
+		    id + 1;
+	}
+
+	return true;
+}
+
+/** Copies |string| into the blocks, null-terminating it. */
+static const char* strpool_store_(strpool_t* pool, strview_t string) {
+	strpool_block_t* block = pool->head;
+	size_t size = string.length + 1;
+
+	if (!block || block->capacity - block->used < size) {
+		size_t capacity =
+		    size > STRPOOL_BLOCK_SIZE ? size : STRPOOL_BLOCK_SIZE;
+
+		block = (strpool_block_t*)malloc(sizeof(strpool_block_t) + capacity);
+		if (!block) return NULL;
+
+		block->next = pool->head;
+		block->used = 0;
+		block->capacity = capacity;
+		pool->head = block;
+	}
+
+	char* chars = block->data + block->used;
+	if (string.length) memcpy(chars, string.chars, string.length);
+	chars[string.length] = '\0';
+
+	block->used += size;
+	return chars;
+}
+
+bool strpool_intern(strpool_t* pool, strview_t string, size_t* id) {
+	if (!pool || !id || (string.length && !string.chars)) return false;
+
+	uint64_t hash = strview_hash(string);
+	size_t slot = 0;
+
+	if (pool->slotCount) {
+		slot = strpool_slot_(pool, string, hash);
+
+		if (pool->slots[slot]) {
+			*id = pool->slots[slot] - 1;
+			return true;
+		}
+	}
+
+	// Only new strings grow the table, which moves their slot.
+	if (2 * (pool->size + 1) > pool->slotCount) {
+		if (!strpool_grow_slots_(pool)) return false;
+		slot = strpool_slot_(pool, string, hash);
+	}
+
+	if (pool->size == pool->capacity) {
+		size_t capacity = pool->capacity ? pool->capacity * 2 : 16;
+
+		strview_t* strings = (strview_t*)realloc(
+		    pool->strings, capacity * sizeof(strview_t));
+		if (!strings) return false;
+
+		pool->strings = strings;
+		pool->capacity = capacity;
+	}
+
+	const char* chars = strpool_store_(pool, string);
+	if (!chars) return false;
+
+	pool->strings[pool->size] =
+	    (strview_t){.chars = chars, .length = string.length};
+	pool->slots[slot] = ++pool->size;
+
+	*id = pool->size - 1;
+	return true;
+}
+
+bool strpool_find(const strpool_t* pool, strview_t string, size_t* id) {
+	if (!pool || !id || !pool->slotCount) return false;
+
+	size_t slot = strpool_slot_(pool, string, strview_hash(string));
+	if (!pool->slots[slot]) return false;
+
+	*id = pool->slots[slot] - 1;
+	return true;
+}
+
+strview_t strpool_get(const strpool_t* pool, size_t id) {
+	if (!pool || id >= pool->size) {
+		return (strview_t){.chars = NULL, .length = 0};
+	}
+
+	return pool->strings[id];
+}
+
+size_t strpool_size(const strpool_t* pool) {
+	return pool ? pool->size : 0;
+}
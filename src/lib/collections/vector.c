@@ -1,8 +1,10 @@
 #include "lib/collections/vector.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 const size_t VECTOR_MIN_CAPACITY = 4;
+const size_t VECTOR_RADIX_SORT_THRESHOLD = 2048;
 
 #define COMPARATOR(TYPE)                              \
 	int comp_##TYPE(const void* p1, const void* p2) { \
@@ -30,14 +32,94 @@ COMPARATOR(uint8_t)
 COMPARATOR(float)
 COMPARATOR(double)
 
-IMPL_VECTOR(vector_i64_t, int64_t, i64, {&comp_int64_t})
-IMPL_VECTOR(vector_i32_t, int32_t, i32, {&comp_int32_t})
-IMPL_VECTOR(vector_i16_t, int16_t, i16, {&comp_int16_t})
-IMPL_VECTOR(vector_i8_t, int8_t, i8, {&comp_int8_t})
-IMPL_VECTOR(vector_u64_t, uint64_t, u64, {&comp_uint64_t})
-IMPL_VECTOR(vector_u32_t, uint32_t, u32, {&comp_uint32_t})
-IMPL_VECTOR(vector_u16_t, uint16_t, u16, {&comp_uint16_t})
-IMPL_VECTOR(vector_u8_t, uint8_t, u8, {&comp_uint8_t})
-IMPL_VECTOR(vector_flt_t, float, flt, {&comp_float})
-IMPL_VECTOR(vector_dbl_t, double, dbl, {&comp_double})
+/** Bits sorted by a single radix pass. */
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_DIGIT(KEY, PASS) \
+	(((KEY) >> ((PASS) * RADIX_BITS)) & (RADIX_BUCKETS - 1))
+
+/** Implements `vector_##TYPE##_radix_sort`, see vector.h. */
+#define RADIX_SORT(TYPE_T, UTYPE_T, TYPE, SIGNED)                           \
+	bool vector_##TYPE##_radix_sort(TYPE_T* items, size_t n,                \
+	                                bool descending) {                      \
+		if (n < 2) return true;                                             \
+                                                                            \
+		UTYPE_T* scratch = (UTYPE_T*)malloc(n * sizeof(UTYPE_T));           \
+		if (!scratch) return false;                                         \
+                                                                            \
+		/* Flipping the sign bit maps signed order onto unsigned order; */  \
+		/* flipping every other bit as well reverses it. */                 \
+		UTYPE_T flip =                                                      \
+		    SIGNED ? (UTYPE_T)1 << (RADIX_BITS * sizeof(TYPE_T) - 1) : 0;   \
+		if (descending) flip = (UTYPE_T)~flip;                              \
+                                                                            \
+		UTYPE_T* src = (UTYPE_T*)items;                                     \
+		UTYPE_T* dst = scratch;                                             \
+                                                                            \
+		/* Histograms of every byte, collected in a single pass. */         \
+		size_t counts[sizeof(TYPE_T)][RADIX_BUCKETS];                       \
+		memset(counts, 0, sizeof(counts));                                  \
+                                                                            \
+		for (size_t i = 0; i != n; ++i) {                                   \
+			UTYPE_T key = src[i] ^ flip;                                    \
+			for (size_t pass = 0; pass != sizeof(TYPE_T); ++pass) {         \
+				++counts[pass][RADIX_DIGIT(key, pass)];                     \
+			}                                                               \
+		}                                                                   \
+                                                                            \
+		for (size_t pass = 0; pass != sizeof(TYPE_T); ++pass) {             \
+			size_t* count = counts[pass];                                   \
+                                                                            \
+			/* Every item has the same byte, the pass wouldn't move any. */ \
+			if (count[RADIX_DIGIT(src[0] ^ flip, pass)] == n) continue;     \
+                                                                            \
+			size_t offset = 0;                                              \
+			for (size_t bucket = 0; bucket != RADIX_BUCKETS; ++bucket) {    \
+				size_t c = count[bucket];                                   \
+				count[bucket] = offset;                                     \
+				offset += c;                                                \
+			}                                                               \
+                                                                            \
+			for (size_t i = 0; i != n; ++i) {                               \
+				dst[count[RADIX_DIGIT(src[i] ^ flip, pass)]++] = src[i];    \
+			}                                                               \
+                                                                            \
+			UTYPE_T* temp = src;                                            \
+			src = dst;                                                      \
+			dst = temp;                                                     \
+		}                                                                   \
+                                                                            \
+		if (src != (UTYPE_T*)items) memcpy(items, src, n * sizeof(TYPE_T)); \
+                                                                            \
+		free(scratch);                                                      \
+		return true;                                                        \
+	}
+
+/** Built-in integer vectors: radix sort for large ones, introsort else. */
+#define IMPL_VECTOR_INT(VECTOR_T, TYPE_T, UTYPE_T, TYPE, SIGNED)      \
+	IMPL_VECTOR_COMMON(VECTOR_T, TYPE_T, TYPE, {&comp_##TYPE_T})      \
+	IMPL_VECTOR_SORT(TYPE_T, introsort_##TYPE, *a < *b)               \
+	RADIX_SORT(TYPE_T, UTYPE_T, TYPE, SIGNED)                         \
+                                                                      \
+	bool vector_##TYPE##_sort(VECTOR_T* v) {                          \
+		if (!v) return false;                                         \
+                                                                      \
+		if (v->size < VECTOR_RADIX_SORT_THRESHOLD ||                  \
+		    !vector_##TYPE##_radix_sort(v->buffer, v->size, false)) { \
+			introsort_##TYPE(v->buffer, v->size);                     \
+		}                                                             \
+                                                                      \
+		return true;                                                  \
+	}
+
+IMPL_VECTOR_INT(vector_i64_t, int64_t, uint64_t, i64, true)
+IMPL_VECTOR_INT(vector_i32_t, int32_t, uint32_t, i32, true)
+IMPL_VECTOR_INT(vector_i16_t, int16_t, uint16_t, i16, true)
+IMPL_VECTOR_INT(vector_i8_t, int8_t, uint8_t, i8, true)
+IMPL_VECTOR_INT(vector_u64_t, uint64_t, uint64_t, u64, false)
+IMPL_VECTOR_INT(vector_u32_t, uint32_t, uint32_t, u32, false)
+IMPL_VECTOR_INT(vector_u16_t, uint16_t, uint16_t, u16, false)
+IMPL_VECTOR_INT(vector_u8_t, uint8_t, uint8_t, u8, false)
+IMPL_VECTOR_WITH_SORT(vector_flt_t, float, flt, {&comp_float}, *a < *b)
+IMPL_VECTOR_WITH_SORT(vector_dbl_t, double, dbl, {&comp_double}, *a < *b)
 IMPL_VECTOR(vector_ptr_t, void*, ptr, {NULL})
@@ -0,0 +1,402 @@
+#include "lib/strsimd.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define STRSIMD_X86 1
+#include <immintrin.h>
+#else
+#define STRSIMD_X86 0
+#endif
+
+static strsimd_level_t strsimd_limit_ = STRSIMD_AVX2;
+
+/** The level in use, or -1 until the CPU is inspected on the first call. */
+static atomic_int strsimd_level_ = -1;
+
+strsimd_level_t strsimd_level(void) {
+	int cached = atomic_load_explicit(&strsimd_level_, memory_order_relaxed);
+	if (cached >= 0) return (strsimd_level_t)cached;
+
+#if STRSIMD_X86
+	strsimd_level_t level =
+	    __builtin_cpu_supports("avx2") ? STRSIMD_AVX2 : STRSIMD_SSE2;
+#else
+	strsimd_level_t level = STRSIMD_SCALAR;
+#endif
+
+	if (level > strsimd_limit_) level = strsimd_limit_;
+	atomic_store_explicit(&strsimd_level_, (int)level, memory_order_relaxed);
+	return level;
+}
+
+void strsimd_limit(strsimd_level_t level) {
+	strsimd_limit_ = level;
+	atomic_store_explicit(&strsimd_level_, -1, memory_order_relaxed);
+}
+
+// =============================================================================
+// Scalar implementations, also used for the tails of the vectorized ones
+// =============================================================================
+
+static inline bool strsimd_in_set(char ch, const char* set) {
+	for (; *set; ++set) {
+		if (*set == ch) return true;
+	}
+
+	return false;
+}
+
+static inline unsigned char strsimd_lower_char(char ch) {
+	unsigned char c = (unsigned char)ch;
+	return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+/** Searches [|from|; |n|) for a character that's |in| the set or not. */
+static size_t strsimd_find_set_scalar(const char* s, size_t from, size_t n,
+                                      const char* set, bool in) {
+	for (size_t i = from; i != n; ++i) {
+		if (strsimd_in_set(s[i], set) == in) return i;
+	}
+
+	return n;
+}
+
+/** Searches [0; |to|) backwards; returns `SIZE_MAX` if there's no match. */
+static size_t strsimd_rfind_not_set_scalar(const char* s, size_t to,
+                                           const char* set) {
+	for (size_t i = to; i-- > 0;) {
+		if (!strsimd_in_set(s[i], set)) return i;
+	}
+
+	return SIZE_MAX;
+}
+
+static size_t strsimd_mismatch_scalar(const char* a, const char* b,
+                                      size_t from, size_t n) {
+	for (size_t i = from; i != n; ++i) {
+		if (a[i] != b[i]) return i;
+	}
+
+	return n;
+}
+
+static int strsimd_casecmp_scalar(const char* a, const char* b, size_t from,
+                                  size_t n) {
+	for (size_t i = from; i != n; ++i) {
+		unsigned char ca = strsimd_lower_char(a[i]);
+		unsigned char cb = strsimd_lower_char(b[i]);
+
+		if (ca != cb) return ca < cb ? -1 : 1;
+	}
+
+	return 0;
+}
+
+static void strsimd_lower_scalar(char* dst, const char* src, size_t from,
+                                 size_t n) {
+	for (size_t i = from; i != n; ++i) {
+		dst[i] = (char)strsimd_lower_char(src[i]);
+	}
+}
+
+/** Searches from |from| on; |m| is at least 1. */
+static size_t strsimd_find_scalar(const char* haystack, size_t from, size_t n,
+                                  const char* needle, size_t m) {
+	for (size_t i = from; n - i >= m; ++i) {
+		if (haystack[i] == needle[0] &&
+		    memcmp(haystack + i + 1, needle + 1, m - 1) == 0) {
+			return i;
+		}
+	}
+
+	return n;
+}
+
+#if STRSIMD_X86
+
+// =============================================================================
+// Vectorized implementations
+// =============================================================================
+
+/**
+ * Defines the kernels for an instruction set |ISA|, whose vectors of |WIDTH|
+ * characters have the type |VEC_T|. The kernels are built from the
+ * `ISA##_op` functions below; |FULL| is the mask of a vector of matches, and
+ * |ATTR| enables the instruction set for the kernels.
+ */
+#define STRSIMD_KERNELS(ISA, VEC_T, WIDTH, FULL, ATTR)                       \
+	ATTR static size_t strsimd_find_set_##ISA(const char* s, size_t n,       \
+	                                          const char* set, bool in) {    \
+		size_t k = strlen(set);                                              \
+		VEC_T chars[STRSIMD_SET_MAX];                                        \
+		for (size_t j = 0; j != k; ++j) chars[j] = ISA##_set1(set[j]);       \
+                                                                             \
+		size_t i = 0;                                                        \
+		for (; WIDTH <= n - i; i += WIDTH) {                                 \
+			VEC_T block = ISA##_load(s + i);                                 \
+			VEC_T hits = ISA##_zero();                                       \
+			for (size_t j = 0; j != k; ++j) {                                \
+				hits = ISA##_or(hits, ISA##_eq(block, chars[j]));            \
+			}                                                                \
+                                                                             \
+			uint32_t mask = ISA##_mask(hits) ^ (in ? 0 : FULL);              \
+			if (mask) return i + (size_t)__builtin_ctz(mask);                \
+		}                                                                    \
+                                                                             \
+		return strsimd_find_set_scalar(s, i, n, set, in);                    \
+	}                                                                        \
+                                                                             \
+	ATTR static size_t strsimd_rfind_not_set_##ISA(const char* s, size_t n,  \
+	                                               const char* set) {        \
+		size_t k = strlen(set);                                              \
+		VEC_T chars[STRSIMD_SET_MAX];                                        \
+		for (size_t j = 0; j != k; ++j) chars[j] = ISA##_set1(set[j]);       \
+                                                                             \
+		size_t end = n;                                                      \
+		for (; end >= WIDTH; end -= WIDTH) {                                 \
+			VEC_T block = ISA##_load(s + end - WIDTH);                       \
+			VEC_T hits = ISA##_zero();                                       \
+			for (size_t j = 0; j != k; ++j) {                                \
+				hits = ISA##_or(hits, ISA##_eq(block, chars[j]));            \
+			}                                                                \
+                                                                             \
+			uint32_t mask = ISA##_mask(hits) ^ FULL;                         \
+			if (mask) return end - WIDTH + 31 - (size_t)__builtin_clz(mask); \
+		}                                                                    \
+                                                                             \
+		return strsimd_rfind_not_set_scalar(s, end, set);                    \
+	}                                                                        \
+                                                                             \
+	ATTR static size_t strsimd_mismatch_##ISA(const char* a, const char* b,  \
+	                                          size_t n) {                    \
+		size_t i = 0;                                                        \
+		for (; WIDTH <= n - i; i += WIDTH) {                                 \
+			VEC_T eq = ISA##_eq(ISA##_load(a + i), ISA##_load(b + i));       \
+                                                                             \
+			uint32_t mask = ISA##_mask(eq) ^ FULL;                           \
+			if (mask) return i + (size_t)__builtin_ctz(mask);                \
+		}                                                                    \
+                                                                             \
+		return strsimd_mismatch_scalar(a, b, i, n);                          \
+	}                                                                        \
+                                                                             \
+	ATTR static int strsimd_casecmp_##ISA(const char* a, const char* b,      \
+	                                      size_t n) {                        \
+		size_t i = 0;                                                        \
+		for (; WIDTH <= n - i; i += WIDTH) {                                 \
+			VEC_T la = ISA##_lower(ISA##_load(a + i));                       \
+			VEC_T lb = ISA##_lower(ISA##_load(b + i));                       \
+                                                                             \
+			uint32_t mask = ISA##_mask(ISA##_eq(la, lb)) ^ FULL;             \
+			if (mask) {                                                      \
+				i += (size_t)__builtin_ctz(mask);                            \
+				return strsimd_casecmp_scalar(a, b, i, i + 1);               \
+			}                                                                \
+		}                                                                    \
+                                                                             \
+		return strsimd_casecmp_scalar(a, b, i, n);                           \
+	}                                                                        \
+                                                                             \
+	ATTR static void strsimd_lower_##ISA(char* dst, const char* src,         \
+	                                     size_t n) {                         \
+		size_t i = 0;                                                        \
+		for (; WIDTH <= n - i; i += WIDTH) {                                 \
+			ISA##_store(dst + i, ISA##_lower(ISA##_load(src + i)));          \
+		}                                                                    \
+                                                                             \
+		strsimd_lower_scalar(dst, src, i, n);                                \
+	}                                                                        \
+                                                                             \
+	/* Compares the first and the last characters of the needle at */        \
+	/* |WIDTH| positions at once, and only the candidates in full; |m| is */ \
+	/* at least 2. */                                                        \
+	ATTR static size_t strsimd_find_##ISA(const char* haystack, size_t n,    \
+	                                      const char* needle, size_t m) {    \
+		VEC_T first = ISA##_set1(needle[0]);                                 \
+		VEC_T last = ISA##_set1(needle[m - 1]);                              \
+                                                                             \
+		size_t i = 0;                                                        \
+		for (; m - 1 + WIDTH <= n - i; i += WIDTH) {                         \
+			VEC_T head = ISA##_eq(first, ISA##_load(haystack + i));          \
+			VEC_T tail = ISA##_eq(last, ISA##_load(haystack + i + m - 1));   \
+                                                                             \
+			uint32_t mask = ISA##_mask(ISA##_and(head, tail));               \
+			for (; mask; mask &= mask - 1) {                                 \
+				size_t at = i + (size_t)__builtin_ctz(mask);                 \
+				if (memcmp(haystack + at + 1, needle + 1, m - 2) == 0) {     \
+					return at;                                               \
+				}                                                            \
+			}                                                                \
+		}                                                                    \
+                                                                             \
+		return strsimd_find_scalar(haystack, i, n, needle, m);               \
+	}
+
+#define STRSIMD_SSE2_ATTR
+
+static inline __m128i sse2_load(const char* p) {
+	return _mm_loadu_si128((const __m128i*)p);
+}
+
+static inline void sse2_store(char* p, __m128i v) {
+	_mm_storeu_si128((__m128i*)p, v);
+}
+
+static inline __m128i sse2_set1(char ch) { return _mm_set1_epi8(ch); }
+
+static inline __m128i sse2_zero(void) { return _mm_setzero_si128(); }
+
+static inline __m128i sse2_eq(__m128i a, __m128i b) {
+	return _mm_cmpeq_epi8(a, b);
+}
+
+static inline __m128i sse2_or(__m128i a, __m128i b) {
+	return _mm_or_si128(a, b);
+}
+
+static inline __m128i sse2_and(__m128i a, __m128i b) {
+	return _mm_and_si128(a, b);
+}
+
+static inline uint32_t sse2_mask(__m128i v) {
+	return (uint32_t)_mm_movemask_epi8(v);
+}
+
+/** Bytes are compared as signed, so non-ASCII ones are never in range. */
+static inline __m128i sse2_lower(__m128i v) {
+	__m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+	                              _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+	return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+STRSIMD_KERNELS(sse2, __m128i, 16, 0xFFFFu, STRSIMD_SSE2_ATTR)
+
+#define STRSIMD_AVX2_ATTR __attribute__((target("avx2")))
+
+STRSIMD_AVX2_ATTR static inline __m256i avx2_load(const char* p) {
+	return _mm256_loadu_si256((const __m256i*)p);
+}
+
+STRSIMD_AVX2_ATTR static inline void avx2_store(char* p, __m256i v) {
+	_mm256_storeu_si256((__m256i*)p, v);
+}
+
+STRSIMD_AVX2_ATTR static inline __m256i avx2_set1(char ch) {
+	return _mm256_set1_epi8(ch);
+}
+
+STRSIMD_AVX2_ATTR static inline __m256i avx2_zero(void) {
+	return _mm256_setzero_si256();
+}
+
+STRSIMD_AVX2_ATTR static inline __m256i avx2_eq(__m256i a, __m256i b) {
+	return _mm256_cmpeq_epi8(a, b);
+}
+
+STRSIMD_AVX2_ATTR static inline __m256i avx2_or(__m256i a, __m256i b) {
+	return _mm256_or_si256(a, b);
+}
+
+STRSIMD_AVX2_ATTR static inline __m256i avx2_and(__m256i a, __m256i b) {
+	return _mm256_and_si256(a, b);
+}
+
+STRSIMD_AVX2_ATTR static inline uint32_t avx2_mask(__m256i v) {
+	return (uint32_t)_mm256_movemask_epi8(v);
+}
+
+STRSIMD_AVX2_ATTR static inline __m256i avx2_lower(__m256i v) {
+	__m256i upper =
+	    _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+	                     _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+	return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+STRSIMD_KERNELS(avx2, __m256i, 32, 0xFFFFFFFFu, STRSIMD_AVX2_ATTR)
+
+/** Returns the result of the kernel |NAME| of the current instruction set. */
+#define STRSIMD_DISPATCH(LEVEL, NAME, ...)   \
+	switch (LEVEL) {                         \
+		case STRSIMD_AVX2:                   \
+			return NAME##_avx2(__VA_ARGS__); \
+		case STRSIMD_SSE2:                   \
+			return NAME##_sse2(__VA_ARGS__); \
+		default:                             \
+			break;                           \
+	}
+
+/** Returns the instruction set to search for the characters of |set| with. */
+static strsimd_level_t strsimd_set_level(const char* set) {
+	return strlen(set) <= STRSIMD_SET_MAX ? strsimd_level() : STRSIMD_SCALAR;
+}
+
+#else
+
+#define STRSIMD_DISPATCH(LEVEL, NAME, ...)
+
+#endif
+
+size_t strsimd_find_set(const char* s, size_t n, const char* set) {
+	STRSIMD_DISPATCH(strsimd_set_level(set), strsimd_find_set, s, n, set, true)
+	return strsimd_find_set_scalar(s, 0, n, set, true);
+}
+
+size_t strsimd_find_not_set(const char* s, size_t n, const char* set) {
+	STRSIMD_DISPATCH(strsimd_set_level(set), strsimd_find_set, s, n, set, false)
+	return strsimd_find_set_scalar(s, 0, n, set, false);
+}
+
+static size_t strsimd_rfind_not_set0(const char* s, size_t n, const char* set) {
+	STRSIMD_DISPATCH(strsimd_set_level(set), strsimd_rfind_not_set, s, n, set)
+	return strsimd_rfind_not_set_scalar(s, n, set);
+}
+
+size_t strsimd_rfind_not_set(const char* s, size_t n, const char* set) {
+	size_t i = strsimd_rfind_not_set0(s, n, set);
+	return i == SIZE_MAX ? n : i;
+}
+
+size_t strsimd_mismatch(const char* a, const char* b, size_t n) {
+	STRSIMD_DISPATCH(strsimd_level(), strsimd_mismatch, a, b, n)
+	return strsimd_mismatch_scalar(a, b, 0, n);
+}
+
+int strsimd_casecmp(const char* a, const char* b, size_t n) {
+	STRSIMD_DISPATCH(strsimd_level(), strsimd_casecmp, a, b, n)
+	return strsimd_casecmp_scalar(a, b, 0, n);
+}
+
+void strsimd_lower(char* dst, const char* src, size_t n) {
+#if STRSIMD_X86
+	switch (strsimd_level()) {
+		case STRSIMD_AVX2:
+			strsimd_lower_avx2(dst, src, n);
+			return;
+		case STRSIMD_SSE2:
+			strsimd_lower_sse2(dst, src, n);
+			return;
+		default:
+			break;
+	}
+#endif
+
+	strsimd_lower_scalar(dst, src, 0, n);
+}
+
+size_t strsimd_find(const char* haystack, size_t n, const char* needle,
+                    size_t m) {
+	if (m == 0) return 0;
+	if (m > n) return n;
+
+	if (m == 1) {
+		const char* at = (const char*)memchr(haystack, needle[0], n);
+		return at ? (size_t)(at - haystack) : n;
+	}
+
+	STRSIMD_DISPATCH(strsimd_level(), strsimd_find, haystack, n, needle, m)
+	return strsimd_find_scalar(haystack, 0, n, needle, m);
+}